@@ -1866,6 +1866,49 @@ static MDEV RAM_PAGE    =   {TRUE,  FALSE,  NULL, "RAM"};       /* this makes a
 static MDEV EMPTY_PAGE  =   {FALSE, TRUE,   NULL, "NONEXIST"};  /* this is non-existing memory  */
 static MDEV mmu_table[MAXMEMORY >> LOG2PAGESIZE];
 
+/* Direct view of the currently addressable 64KB for GetBYTE and PutBYTE. Entry i points
+   into M at the page that address i << LOG2PAGESIZE maps to under the current bank and
+   common settings. mmu_read_view covers RAM and ROM, mmu_write_view covers RAM only.
+   NULL sends the access through mmu_table, which is always correct, so an entry may be
+   cleared at any time. The view is rebuilt when mmu_table, bankSelect, common, common_low
+   or the BANKED flag changes. */
+static uint8 *mmu_read_view[MAXBANKSIZE >> LOG2PAGESIZE];
+static uint8 *mmu_write_view[MAXBANKSIZE >> LOG2PAGESIZE];
+static int32 viewBank       = -2;   /* bankSelect the view was built for, -1 if not banked */
+static uint32 viewCommon    = 0;    /* common the view was built for                        */
+static uint32 viewCommonLow = 0;    /* common_low the view was built for                    */
+
+static void rebuildMemoryView(void) {
+    uint32 page, addr;
+    MDEV m;
+    const uint32 banked = cpu_unit.flags & UNIT_CPU_BANKED;
+    for (page = 0; page < (MAXBANKSIZE >> LOG2PAGESIZE); page++) {
+        addr = page << LOG2PAGESIZE;
+        if (banked && (common & (PAGESIZE - 1)) && ((common >> LOG2PAGESIZE) == page)) {
+            mmu_read_view[page] = mmu_write_view[page] = NULL;  /* page straddles common */
+            continue;
+        }
+        if (banked && (((common_low == 0) && (addr < common)) || ((common_low == 1) && (addr >= common))))
+            addr |= bankSelect << MAXBANKSIZELOG2;
+        m = mmu_table[addr >> LOG2PAGESIZE];
+        mmu_read_view[page] = (m.isRAM || (!m.isEmpty && !m.routine)) ? M + addr : NULL;
+        mmu_write_view[page] = m.isRAM ? M + addr : NULL;
+    }
+    viewBank = banked ? bankSelect : -1;
+    viewCommon = common;
+    viewCommonLow = common_low;
+}
+
+/* Rebuild the view if the bank or common settings changed since it was built */
+static void updateMemoryView(void) {
+    if (cpu_unit.flags & UNIT_CPU_BANKED) {
+        if ((viewBank == bankSelect) && (viewCommon == common) && (viewCommonLow == common_low))
+            return;
+    } else if (viewBank == -1)
+        return;
+    rebuildMemoryView();
+}
+
 /* Memory and I/O Resource Mapping and Unmapping routine. */
 uint32 sim_map_resource(uint32 baseaddr, uint32 size, uint32 resource_type,
                         int32 (*routine)(const int32, const int32, const int32), const char* name, uint8 unmap) {
@@ -1895,6 +1938,7 @@ uint32 sim_map_resource(uint32 baseaddr, uint32 size, uint32 resource_type,
                 mmu_table[page].name = name;
             }
         }
+        rebuildMemoryView();
     } else if (resource_type == RESOURCE_TYPE_IO) {
         for (i = baseaddr; i < baseaddr + size; i++)
             if (unmap) {
@@ -1919,8 +1963,13 @@ uint32 sim_map_resource(uint32 baseaddr, uint32 size, uint32 resource_type,
 
 static void PutBYTE(register uint32 Addr, const register uint32 Value) {
     MDEV m;
+    uint8 *p;
 
     Addr &= ADDRMASK;   /* registers are NOT guaranteed to be always 16-bit values */
+    if ((p = mmu_write_view[Addr >> LOG2PAGESIZE])) {
+        p[Addr & (PAGESIZE - 1)] = Value;
+        return;
+    }
     if ((cpu_unit.flags & UNIT_CPU_BANKED) && (((common_low == 0) && (Addr < common)) || ((common_low == 1) && (Addr >= common))))
         Addr |= bankSelect << MAXBANKSIZELOG2;
 
@@ -1940,6 +1989,7 @@ static void PutBYTE(register uint32 Addr, const register uint32 Value) {
 
 static void PutBYTEasROMorRAM(register uint32 Addr, const register uint32 Value, const register uint32 makeROM) {
     Addr &= ADDRMASK;   /* registers are NOT guaranteed to be always 16-bit values */
+    mmu_read_view[Addr >> LOG2PAGESIZE] = mmu_write_view[Addr >> LOG2PAGESIZE] = NULL;
     if ((cpu_unit.flags & UNIT_CPU_BANKED) && (((common_low == 0) && (Addr < common)) || ((common_low == 1) && (Addr >= common))))
         Addr |= bankSelect << MAXBANKSIZELOG2;
 
@@ -1972,8 +2022,11 @@ static void PutWORD(register uint32 Addr, const register uint32 Value) {
 
 static uint32 GetBYTE(register uint32 Addr) {
     MDEV m;
+    const uint8 *p;
 
     Addr &= ADDRMASK;   /* registers are NOT guaranteed to be always 16-bit values */
+    if ((p = mmu_read_view[Addr >> LOG2PAGESIZE]))
+        return p[Addr & (PAGESIZE - 1)];
     if ((cpu_unit.flags & UNIT_CPU_BANKED) && (((common_low == 0) && (Addr < common)) || ((common_low == 1) && (Addr >= common))))
         Addr |= bankSelect << MAXBANKSIZELOG2;
     m = mmu_table[Addr >> LOG2PAGESIZE];
@@ -2014,6 +2067,7 @@ int32 getBankSelect(void) {
 
 void setBankSelect(const int32 b) {
     bankSelect = b;
+    updateMemoryView();
 }
 
 uint32 getCommon(void) {
@@ -2022,6 +2076,7 @@ uint32 getCommon(void) {
 
 /* memory access during a simulation */
 uint8 GetBYTEWrapper(const uint32 Addr) {
+    updateMemoryView(); /* BANK or COMMON may have been deposited since the last run */
     if (chiptype == CHIP_TYPE_8086)
         return GetBYTEExtended(Addr);
     else if (chiptype == CHIP_TYPE_M68K)
@@ -2034,6 +2089,7 @@ uint8 GetBYTEWrapper(const uint32 Addr) {
 
 /* memory access during a simulation */
 void PutBYTEWrapper(const uint32 Addr, const uint32 Value) {
+    updateMemoryView();
     if (chiptype == CHIP_TYPE_8086)
         PutBYTEExtended(Addr, Value);
     else if (chiptype == CHIP_TYPE_M68K)
@@ -2214,6 +2270,7 @@ static t_stat sim_instr_mmu (void) {
     int32 tStateModifier = FALSE;
 
     switch_cpu_now = TRUE;
+    rebuildMemoryView();
 
     AF = AF_S;
     BC = BC_S;
@@ -6581,6 +6638,7 @@ static t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs) {
     switch (chiptype) {
         case CHIP_TYPE_8080:
         case CHIP_TYPE_Z80:
+            updateMemoryView();
             switch (GetBYTE(PC_S)) {
                 case 0xc4:  /* CALL NZ,nnnn */
                 case 0xcc:  /* CALL Z,nnnn  */
@@ -6641,19 +6699,26 @@ t_stat install_bootrom(const int32 bootrom[], const int32 size, const int32 addr
             mmu_table[(i + addr) >> LOG2PAGESIZE] = ROM_PAGE;
         M[i + addr] = bootrom[i] & 0xff;
     }
+    rebuildMemoryView();
     return SCPE_OK;
 }
 
+/* Map an EXAMINE/DEPOSIT address, whose bits above the 64KB bank select the bank, to its
+   location in memory the way GetBYTE/PutBYTE would with that bank selected. This leaves
+   bankSelect and the memory view alone, so examining a range doesn't rebuild the view. */
+static uint32 cpu_ex_dep_address(t_addr addr) {
+    uint32 Addr = addr & ADDRMASK;
+    if ((cpu_unit.flags & UNIT_CPU_BANKED) && (((common_low == 0) && (Addr < common)) || ((common_low == 1) && (Addr >= common))))
+        Addr |= ((addr >> MAXBANKSIZELOG2) & BANKMASK) << MAXBANKSIZELOG2;
+    return Addr;
+}
+
 /* memory examine */
 static t_stat cpu_ex(t_value *vptr, t_addr addr, UNIT *uptr, int32 sw) {
     switch (chiptype) {
         case CHIP_TYPE_8080:
-        case CHIP_TYPE_Z80: {
-            const int32 oldBankSelect = getBankSelect();
-            setBankSelect((addr >> MAXBANKSIZELOG2) & BANKMASK);
-            *vptr = GetBYTE(addr & ADDRMASK);
-            setBankSelect(oldBankSelect);
-        }
+        case CHIP_TYPE_Z80:
+            *vptr = GetBYTEExtended(cpu_ex_dep_address(addr));
             break;
 
         case CHIP_TYPE_8086:
@@ -6676,13 +6741,8 @@ static t_stat cpu_ex(t_value *vptr, t_addr addr, UNIT *uptr, int32 sw) {
 static t_stat cpu_dep(t_value val, t_addr addr, UNIT *uptr, int32 sw) {
     switch (chiptype) {
         case CHIP_TYPE_8080:
-        case CHIP_TYPE_Z80: {
-            const int32 oldBankSelect = getBankSelect();
-            setBankSelect((addr >> MAXBANKSIZELOG2) & BANKMASK);
-            PutBYTE(addr & ADDRMASK, val);
-            setBankSelect(oldBankSelect);
-
-        }
+        case CHIP_TYPE_Z80:
+            PutBYTEExtended(cpu_ex_dep_address(addr), val);
             break;
 
         case CHIP_TYPE_8086:
@@ -6857,6 +6917,7 @@ static void cpu_clear(t_bool unmap) {
     if (cpu_unit.flags & UNIT_CPU_ALTAIRROM)
         install_ALTAIRbootROM();
     m68k_clear_memory();
+    rebuildMemoryView();
     clockHasChanged = FALSE;
 }
 
@@ -6873,6 +6934,7 @@ static t_stat cpu_set_altairrom(UNIT *uptr, int32 value, CONST char *cptr, void
 static t_stat cpu_set_noaltairrom(UNIT *uptr, int32 value, CONST char *cptr, void *desc) {
     mmu_table[ALTAIR_ROM_LOW >> LOG2PAGESIZE] = MEMORYSIZE < MAXBANKSIZE ?
         EMPTY_PAGE : RAM_PAGE;
+    rebuildMemoryView();
     return SCPE_OK;
 }
 
@@ -7508,6 +7570,7 @@ t_stat sim_load(FILE *fileref, CONST char *cptr, CONST char *fnam, int flag) {
             PLURAL((cnt + 0xff) >> 8), org, makeROM ? " [ROM]" : "");
         if (pagesModified)
             sim_printf("Warning: %d page%s modified.\n", PLURAL(pagesModified));
+        rebuildMemoryView();
     }
     return SCPE_OK;
 }
@@ -7664,6 +7727,7 @@ static t_stat cpu_cmd_reg(int32 flag, CONST char *cptr)
         return SCPE_NOFNC;
     }
 
+    updateMemoryView();
     for (i = 0; i < INST_MAX_BYTES; i++) {
         op[i] = GetBYTE(PC_S + i);
     }
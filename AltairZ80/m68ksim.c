@@ -217,8 +217,57 @@ void m68k_viewToCPU(void) {
         m68k_set_reg((m68k_register_t)reg, m68k_registers[reg]);
 }
 
+/* Slice execution
+
+ Unless breakpoints are set, the 68K core runs its own inner loop for a whole
+ slice instead of being called once per instruction. sim_interval keeps counting
+ instructions: the instruction hook, which runs before every instruction, ends
+ the slice once the instructions not yet charged reach sim_interval, and the
+ instructions executed are charged to sim_interval afterwards. The cycle budget
+ handed to the core is only an upper bound.
+
+ Device accesses which may look at or change the clock queue first charge the
+ instructions executed so far in the slice, so the hook compares against the
+ updated sim_interval if an event became due earlier. Raising an interrupt or
+ stopping the CPU ends the slice after the current instruction, since the core
+ only samples interrupts when m68k_execute is entered.
+ */
+
+uint32 m68k_instructions = 0;                       /* counted by the instruction hook  */
+static t_bool m68k_in_slice = FALSE;                /* m68k_execute running a slice     */
+static uint32 m68k_slice_charged = 0;               /* m68k_instructions at last charge */
+
+void m68k_instruction_hook(void) {
+    m68k_instructions++;
+    if (m68k_in_slice && ((int32)(m68k_instructions - m68k_slice_charged) >= sim_interval))
+        m68k_end_timeslice();                       /* this is the last one             */
+}
+
+static void m68k_slice_sync(void) {
+    if (m68k_in_slice) {
+        sim_interval -= m68k_instructions - m68k_slice_charged;
+        m68k_slice_charged = m68k_instructions;
+    }
+}
+
+static void m68k_slice_end(void) {
+    if (m68k_in_slice)
+        m68k_end_timeslice();
+}
+
+static uint32 m68k_io_in(const uint32 port) {
+    m68k_slice_sync();
+    return in(port);
+}
+
+static void m68k_io_out(const uint32 port, const uint32 value) {
+    m68k_slice_sync();
+    out(port, value);
+}
+
 t_stat sim_instr_m68k(void) {
     t_stat reason = SCPE_OK;
+    uint32 start;
     m68k_viewToCPU();
     while (TRUE) {
         if (sim_interval <= 0) {                            /* check clock queue    */
@@ -226,19 +275,30 @@ t_stat sim_instr_m68k(void) {
                 break;
             m68k_input_device_update();
         }
-        if (sim_brk_summ && sim_brk_test(m68k_get_reg(NULL, M68K_REG_PC), SWMASK('E'))) {
-            /* breakpoint?          */
-            reason = STOP_IBKPT;                            /* stop simulation      */
-            break;
-        }
         PCX = m68k_get_reg(NULL, M68K_REG_PC);
-        sim_interval--;
-        m68k_execute(1);
+        if (sim_brk_summ) {
+            if (sim_brk_test(PCX, SWMASK('E'))) {           /* breakpoint?          */
+                reason = STOP_IBKPT;                        /* stop simulation      */
+                break;
+            }
+            sim_interval--;
+            m68k_execute(1);                                /* single instruction   */
+        } else {
+            start = m68k_slice_charged = m68k_instructions;
+            m68k_in_slice = TRUE;
+            m68k_execute(0x7fffffff);                       /* hook ends the slice  */
+            m68k_in_slice = FALSE;
+            if (m68k_instructions == start)                 /* STOPped, skip to event */
+                sim_interval = 0;
+            else
+                sim_interval -= m68k_instructions - m68k_slice_charged;
+        }
         if (stop_cpu) {
             reason = SCPE_STOP;
             break;
         }
     }
+    PCX = m68k_get_reg(NULL, M68K_REG_PC);
     m68k_CPUToView();
     return reason;
 }
@@ -321,6 +381,8 @@ static uint32 MC6850_data_read(void) {
     }
     if (ch == SCPE_STOP)
         stop_cpu = TRUE;
+    if (stop_cpu)
+        m68k_slice_end();
     return (((ch > 0) && (!stop_cpu)) ? ch & 0xff : 0xff);
 }
 
@@ -350,7 +412,7 @@ unsigned int m68k_cpu_read_byte_raw(unsigned int address) {
     if (address > M68K_MAX_RAM) {
         if (cpu_unit.flags & UNIT_CPU_VERBOSE)
             sim_printf("M68K: 0x%08x Attempt to read byte from non existing memory 0x%08x.\n",
-                   PCX, address);
+                   m68k_get_reg(NULL, M68K_REG_PPC), address);
         return 0xff;
     }
     return READ_BYTE(m68k_ram, address);
@@ -365,14 +427,14 @@ unsigned int m68k_cpu_read_byte(unsigned int address) {
         default:
             if ((address >= mmiobase) && (address < mmiobase + mmiosize)) {
                 /* Memory-mapped I/O */
-                return (in(address & 0xff) & 0xff);
+                return (m68k_io_in(address & 0xff) & 0xff);
             }
             break;
     }
     if (address > M68K_MAX_RAM) {
         if (cpu_unit.flags & UNIT_CPU_VERBOSE)
             sim_printf("M68K: 0x%08x Attempt to read byte from non existing memory 0x%08x.\n",
-                   PCX, address);
+                   m68k_get_reg(NULL, M68K_REG_PPC), address);
         return 0xff;
      }
    return READ_BYTE(m68k_ram, address);
@@ -388,7 +450,7 @@ unsigned int m68k_cpu_read_word(unsigned int address) {
     if (address > M68K_MAX_RAM-1) {
         if (cpu_unit.flags & UNIT_CPU_VERBOSE)
             sim_printf("M68K: 0x%08x Attempt to read word from non existing memory 0x%08x.\n",
-                   PCX, address);
+                   m68k_get_reg(NULL, M68K_REG_PPC), address);
         return 0xffff;
     }
     return READ_WORD(m68k_ram, address);
@@ -406,7 +468,7 @@ unsigned int m68k_cpu_read_long(unsigned int address) {
     if (address > M68K_MAX_RAM-3) {
         if (cpu_unit.flags & UNIT_CPU_VERBOSE)
             sim_printf("M68K: 0x%08x Attempt to read long from non existing memory 0x%08x.\n",
-                   PCX, address);
+                   m68k_get_reg(NULL, M68K_REG_PPC), address);
         return 0xffffffff;
     }
     return READ_LONG(m68k_ram, address);
@@ -418,7 +480,7 @@ void m68k_cpu_write_byte_raw(unsigned int address, unsigned int value) {
     if (address > M68K_MAX_RAM) {
         if (cpu_unit.flags & UNIT_CPU_VERBOSE)
             sim_printf("M68K: 0x%08x Attempt to write byte 0x%02x to non existing memory 0x%08x.\n",
-                   PCX, value & 0xff, address);
+                   m68k_get_reg(NULL, M68K_REG_PPC), value & 0xff, address);
         return;
     }
     WRITE_BYTE(m68k_ram, address, value);
@@ -435,14 +497,14 @@ void m68k_cpu_write_byte(unsigned int address, unsigned int value) {
         default:
             if ((address >= mmiobase) && (address < mmiobase + mmiosize)) {
                 /* Memory-mapped I/O */
-                out(address & 0xff, value & 0xff);
+                m68k_io_out(address & 0xff, value & 0xff);
             }
             break;
     }
     if (address > M68K_MAX_RAM) {
         if (cpu_unit.flags & UNIT_CPU_VERBOSE)
             sim_printf("M68K: 0x%08x Attempt to write byte 0x%02x to non existing memory 0x%08x.\n",
-                   PCX, value & 0xff, address);
+                   m68k_get_reg(NULL, M68K_REG_PPC), value & 0xff, address);
         return;
     }
     WRITE_BYTE(m68k_ram, address, value);
@@ -452,7 +514,7 @@ void m68k_cpu_write_word(unsigned int address, unsigned int value) {
     if (address > M68K_MAX_RAM-1) {
         if (cpu_unit.flags & UNIT_CPU_VERBOSE)
             sim_printf("M68K: 0x%08x Attempt to write word 0x%04x to non existing memory 0x%08x.\n",
-                   PCX, value & 0xffff, address);
+                   m68k_get_reg(NULL, M68K_REG_PPC), value & 0xffff, address);
         return;
     }
     WRITE_WORD(m68k_ram, address, value);
@@ -494,6 +556,7 @@ void m68k_cpu_write_long(unsigned int address, unsigned int value) {
 
         case M68K_STOP_CPU:
             stop_cpu = TRUE;
+            m68k_slice_end();
             return;
 
         default:
@@ -502,7 +565,7 @@ void m68k_cpu_write_long(unsigned int address, unsigned int value) {
     if (address > M68K_MAX_RAM-3) {
         if (cpu_unit.flags & UNIT_CPU_VERBOSE)
             sim_printf("M68K: 0x%08x Attempt to write long 0x%08x to non existing memory 0x%08x.\n",
-                   PCX, value, address);
+                   m68k_get_reg(NULL, M68K_REG_PPC), value, address);
         return;
     }
     WRITE_LONG(m68k_ram, address, value);
@@ -542,6 +605,7 @@ static void int_controller_set(uint32 value) {
     if (old_pending != m68k_int_controller_pending && value > m68k_int_controller_highest_int) {
         m68k_int_controller_highest_int = value;
         m68k_set_irq(m68k_int_controller_highest_int);
+        m68k_slice_end();                        /* take it after this instruction */
     }
 }
 
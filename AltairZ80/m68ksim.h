@@ -44,6 +44,8 @@ void m68k_cpu_set_fc(unsigned int fc);
 int  m68k_cpu_irq_ack(int level);
 
 t_stat sim_instr_m68k(void);
+extern uint32 m68k_instructions;                    /* instructions executed by the core */
+void m68k_instruction_hook(void);
 void m68k_cpu_reset(void);
 void m68k_clear_memory(void);
 void m68k_CPUToView(void);
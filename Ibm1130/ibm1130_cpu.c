@@ -476,18 +476,14 @@ static const char *xio_funcs[] = {
 static int32 ibm1130_qcount ()
 {
     int32 i, cnt;
-    UNIT *uptr;
+    uint32 j;
     DEVICE *dptr;
 
-    cnt = 0;
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
-        dptr = find_dev_from_unit (uptr);
-        for (i=0; sim_devices[i]; i++)
-            if (dptr == sim_devices[i]) {
+    cnt = 0;                                /* count queued units, independent of the event queue engine */
+    for (i=0; (dptr = sim_devices[i]) != NULL; i++)
+        for (j = 0; j < dptr->numunits; j++)
+            if (dptr->units[j].next != NULL)
                 cnt++;
-                break;
-            }
-    }
     return cnt;
 }
 
@@ -48,6 +48,9 @@
 
 #define AUXCPU_POLL        1000
 
+/* Milliseconds to wait for the SLAVE to answer through the mailbox. */
+#define AUXCPU_MBOX_TIMEOUT 1000
+
 #define PIA         u3
 #define STATUS      u4
 t_addr auxcpu_base = 03000000;
@@ -109,6 +112,9 @@ DEVICE auxcpu_dev = {
 
 static TMLN auxcpu_ldsc;                                 /* line descriptor */
 static TMXR auxcpu_desc = { 1, 0, 0, &auxcpu_ldsc };      /* mux descriptor */
+static SHMEM *auxcpu_shmem = NULL;                       /* shared memory mailbox */
+static struct aux_mbox *auxcpu_mbox = NULL;
+static int32 auxcpu_seq = 0;                             /* last request posted */
 
 static t_stat auxcpu_reset (DEVICE *dptr)
 {
@@ -135,6 +141,21 @@ static t_stat auxcpu_attach (UNIT *uptr, CONST char *cptr)
     return SCPE_ARG;
   if (!(uptr->flags & UNIT_ATTABLE))
     return SCPE_NOATT;
+  if (sim_switches & SWMASK ('M')) {
+    void *basead;
+
+    r = sim_shmem_open (cptr, sizeof (struct aux_mbox), &auxcpu_shmem, &basead);
+    if (r != SCPE_OK)
+      return r;
+    uptr->filename = (char *)malloc (strlen (cptr) + 1);
+    strcpy (uptr->filename, cptr);
+    uptr->flags |= UNIT_ATT;
+    auxcpu_mbox = (struct aux_mbox *)basead;
+    auxcpu_mbox->state = AUX_MBOX_IDLE;   /* drop a stale request */
+    sim_debug(DBG_TRC, &auxcpu_dev, "attach mailbox %s\n", cptr);
+    sim_activate (uptr, 10);    /* start poll */
+    return SCPE_OK;
+  }
   r = tmxr_attach_ex (&auxcpu_desc, uptr, cptr, FALSE);
   if (r != SCPE_OK)                                       /* error? */
     return r;
@@ -150,6 +171,16 @@ static t_stat auxcpu_detach (UNIT *uptr)
   if (!(uptr->flags & UNIT_ATT))
     return SCPE_OK;
   sim_cancel (uptr);
+  if (auxcpu_mbox != NULL) {
+    /* Closing also removes the name, so both sides must attach again. */
+    sim_shmem_close (auxcpu_shmem);
+    auxcpu_shmem = NULL;
+    auxcpu_mbox = NULL;
+    free (uptr->filename);
+    uptr->filename = NULL;
+    uptr->flags &= ~UNIT_ATT;
+    return SCPE_OK;
+  }
   r = tmxr_detach (&auxcpu_desc, uptr);
   uptr->filename = NULL;
   return r;
@@ -163,10 +194,12 @@ static void build (unsigned char *request, unsigned char octet)
 
 static t_stat auxcpu_svc (UNIT *uptr)
 {
-  tmxr_poll_rx (&auxcpu_desc);
-  if (auxcpu_ldsc.rcve && !auxcpu_ldsc.conn) {
-    auxcpu_ldsc.rcve = 0;
-    tmxr_reset_ln (&auxcpu_ldsc);
+  if (auxcpu_mbox == NULL) {
+    tmxr_poll_rx (&auxcpu_desc);
+    if (auxcpu_ldsc.rcve && !auxcpu_ldsc.conn) {
+      auxcpu_ldsc.rcve = 0;
+      tmxr_reset_ln (&auxcpu_ldsc);
+    }
   }
 
   /* If incoming interrput => uptr->STATUS |= 010 */
@@ -175,7 +208,7 @@ static t_stat auxcpu_svc (UNIT *uptr)
   else
     clr_interrupt(AUXCPU_DEVNUM);
 
-  if (tmxr_poll_conn(&auxcpu_desc) >= 0) {
+  if (auxcpu_mbox == NULL && tmxr_poll_conn(&auxcpu_desc) >= 0) {
     sim_debug(DBG_CMD, &auxcpu_dev, "got connection\n");
     auxcpu_ldsc.rcve = 1;
     uptr->wait = AUXCPU_POLL;
@@ -197,6 +230,15 @@ const char helpString[] =
     "\n"
     "+sim> ATTACH %U port\n"
     "\n"
+    " When both simulators run on the same host, the -M switch attaches to a\n"
+    " named shared memory mailbox instead.  The SLAVE in the other simulator\n"
+    " must be attached to the same name with -M.  A request that is not\n"
+    " answered within a second completes with a timeout.  Detaching either\n"
+    " side removes the name, so after a detach both the %D and the SLAVE\n"
+    " must be attached again.\n"
+    "\n"
+    "+sim> ATTACH -M %U name\n"
+    "\n"
     ;
 
  return scp_help (st, dptr, uptr, flag, helpString, cptr);
@@ -212,18 +254,74 @@ static const char *auxcpu_description (DEVICE *dptr)
 static int error (const char *message)
 {
   sim_debug (DBG_TRC, &auxcpu_dev, "%s\r\n", message);
+  if (auxcpu_mbox != NULL)
+    return -1;
   sim_debug (DBG_TRC, &auxcpu_dev, "CLOSE\r\n");
   auxcpu_ldsc.rcve = 0;
   tmxr_reset_ln (&auxcpu_ldsc);
   return -1;
 }
 
+/* Post a request in the shared memory mailbox and spin until the SLAVE
+   answers.  The request is only copied in after IDLE -> POST gives the
+   AUXCPU the mailbox, and POST -> REQ publishes it.  The response is only
+   read after RSP is seen, and only if it answers this request. */
+static int mbox_transaction (unsigned char *request, unsigned char *response)
+{
+  uint32 start;
+  size_t size;
+  int32 state, seq;
+  int i;
+
+  response[0] = ERR;
+  if (!sim_shmem_atomic_cas (&auxcpu_mbox->state, AUX_MBOX_IDLE, AUX_MBOX_POST))
+    return error ("Mailbox busy");
+  seq = ++auxcpu_seq;
+  memcpy (auxcpu_mbox->request, request, sizeof auxcpu_mbox->request);
+  auxcpu_mbox->req_seq = seq;
+  sim_shmem_atomic_cas (&auxcpu_mbox->state, AUX_MBOX_POST, AUX_MBOX_REQ);
+
+  start = sim_os_msec ();
+  for (i = 1; ; i++) {
+    state = sim_shmem_atomic_add (&auxcpu_mbox->state, 0);
+    if (state == AUX_MBOX_RSP)
+      break;
+    if ((i & 01777) == 0)
+      sim_os_ms_sleep (0);      /* let the SLAVE run on a busy host */
+    if ((i & 0177777) == 0 &&
+        (!auxcpu_mbox->slave ||
+         (sim_os_msec () - start) > AUXCPU_MBOX_TIMEOUT)) {
+      /* Take the request back, unless the SLAVE just answered it.  A
+         SLAVE serves a request within one event, so one still BUSY this
+         late has gone away and its late answer would find the mailbox
+         no longer BUSY. */
+      if (sim_shmem_atomic_cas (&auxcpu_mbox->state, AUX_MBOX_REQ, AUX_MBOX_IDLE) ||
+          sim_shmem_atomic_cas (&auxcpu_mbox->state, AUX_MBOX_BUSY, AUX_MBOX_IDLE)) {
+        response[0] = TIMEOUT;
+        return 0;
+      }
+    }
+  }
+
+  size = auxcpu_mbox->response[0];
+  if (size > 9 || auxcpu_mbox->rsp_seq != seq)
+    size = 0;
+  memcpy (response, auxcpu_mbox->response + 1, size);
+  sim_shmem_atomic_cas (&auxcpu_mbox->state, AUX_MBOX_RSP, AUX_MBOX_IDLE);
+  if (size == 0)
+    return error ("Malformed transaction");
+  return 0;
+}
+
 static int transaction (unsigned char *request, unsigned char *response)
 {
   const uint8 *auxcpu_request;
   size_t size;
   t_stat stat;
 
+  if (auxcpu_mbox != NULL)
+    return mbox_transaction (request, response);
+
   stat = tmxr_put_packet_ln (&auxcpu_ldsc, request + 1, (size_t)request[0]);
   if (stat != SCPE_OK)
     return error ("Write error in transaction");
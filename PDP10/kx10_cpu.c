@@ -247,6 +247,13 @@ uint64  fault_data;                           /* Fault data from last fault */
 int     trap_flag;                            /* In trap cycle */
 int     last_page;                            /* Last page mapped */
 #endif
+#if KL | KS
+uint32  e_tlb_gen[512];                       /* Generation of executive TLB entries */
+uint32  u_tlb_gen[546];                       /* Generation of user TLB entries */
+uint32  tlb_gen = 1;                          /* Current TLB generation */
+uint64  tlb_hit;                              /* Lookups satisfied by the TLB */
+uint64  tlb_miss;                             /* Lookups that walked the page tables */
+#endif
 #if BBN
 int     exec_map;                             /* Enable executive mapping */
 int     next_write;                           /* Clear next write mapping */
@@ -288,6 +295,18 @@ int     MAGIC = 1;                            /* Magic switch. */
 #define cst_dat   FM[(06<<4)|1]
 #endif
 
+#if KL | KS
+/* A TLB entry only counts if it was loaded in the current generation, so
+   the whole TLB is invalidated by bumping tlb_gen in flush_tlb(). */
+#define E_TLB(p)          ((e_tlb_gen[p] == tlb_gen) ? e_tlb[p] : 0)
+#define U_TLB(p)          ((u_tlb_gen[p] == tlb_gen) ? u_tlb[p] : 0)
+#define SET_E_TLB(p, v)   (e_tlb_gen[p] = tlb_gen, e_tlb[p] = (v))
+#define SET_U_TLB(p, v)   (u_tlb_gen[p] = tlb_gen, u_tlb[p] = (v))
+#else
+#define E_TLB(p)          e_tlb[p]
+#define U_TLB(p)          u_tlb[p]
+#endif
+
 #if KS
 uint64 spt;
 uint64 cst;
@@ -395,6 +414,10 @@ t_stat cpu_show_hist (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_set_serial (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_serial (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 #endif
+#if KL | KS
+t_stat cpu_show_tlb (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+void flush_tlb(void);
+#endif
 t_stat cpu_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag,
                      const char *cptr);
 const char          *cpu_description (DEVICE *dptr);
@@ -685,6 +708,10 @@ MTAB cpu_mod[] = {
 #endif
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "HISTORY", "HISTORY",
       &cpu_set_hist, &cpu_show_hist },
+#if KL | KS
+    { MTAB_XTD|MTAB_VDV, 0, "TLB", NULL, NULL, &cpu_show_tlb, NULL,
+              "TLB hit and miss counts"},
+#endif
     { 0 }
     };
 
@@ -1152,6 +1179,28 @@ t_stat null_dev(uint32 dev, uint64 *data) {
 }
 #endif
 
+#if KL | KS
+/*
+ * Invalidate the whole TLB by starting a new generation.
+ */
+void
+flush_tlb()
+{
+    int   i;
+
+    if (++tlb_gen == 0) {
+        /* Generation wrapped, really clear the tables */
+        for (i = 0; i < 512; i++) {
+            e_tlb[i] = u_tlb[i] = 0;
+            e_tlb_gen[i] = u_tlb_gen[i] = 0;
+        }
+        for (;i < 546; i++)
+            u_tlb[i] = u_tlb_gen[i] = 0;
+        tlb_gen = 1;
+    }
+}
+#endif
+
 #if KL
 void
 update_times(int tim)
@@ -1190,12 +1239,7 @@ t_stat dev_pag(uint32 dev, uint64 *data) {
 
      case CONO:
         eb_ptr = (*data & 017777) << 9;
-        for (i = 0; i < 512; i++) {
-            e_tlb[i] = 0;
-            u_tlb[i] = 0;
-        }
-        for (;i < 546; i++)
-            u_tlb[i] = 0;
+        flush_tlb();
         page_enable = (*data & 020000) != 0;
         t20_page = (*data & 040000) != 0;
         sim_debug(DEBUG_CONO, &cpu_dev, "CONO PAG %012llo\n", *data);
@@ -1238,12 +1282,7 @@ t_stat dev_pag(uint32 dev, uint64 *data) {
                     rtc_tim = ((int)us);
                 }
                 ub_ptr = (res & 017777) << 9;
-                for (i = 0; i < 512; i++) {
-                   u_tlb[i] = 0;
-                   e_tlb[i] = 0;
-                }
-                for (;i < 546; i++)
-                   u_tlb[i] = 0;
+                flush_tlb();
            }
            sim_debug(DEBUG_DATAIO, &cpu_dev,
                     "DATAO PAG %012llo ebr=%06o ubr=%06o\n",
@@ -1891,12 +1930,12 @@ load_tlb(int uf, int page, int wr)
         pg |= (data & 001777) << 1;
         /* Create 2 page table entries. */
         if (uf) {
-            u_tlb[page & 0776] = pg;
-            u_tlb[(page & 0776)|1] = pg|1;
+            SET_U_TLB(page & 0776, pg);
+            SET_U_TLB((page & 0776)|1, pg|1);
             data = u_tlb[page];
         } else {
-            e_tlb[page & 0776] = pg;
-            e_tlb[(page & 0776)|1] = pg|1;
+            SET_E_TLB(page & 0776, pg);
+            SET_E_TLB((page & 0776)|1, pg|1);
             data = e_tlb[page];
         }
     } else
@@ -2072,25 +2111,25 @@ pg_loop:
            data |= KL_PAG_C;
         /* And save it */
         if (uf)
-           u_tlb[page] = data & RMASK;
+           SET_U_TLB(page, data & RMASK);
         else
-           e_tlb[page] = data & RMASK;
+           SET_E_TLB(page, data & RMASK);
     } else {
 
        /* Map the page */
        sim_interval--;
        if (uf) {
            data = M[ub_ptr + (page >> 1)];
-           u_tlb[page & 01776] = (uint32)(RMASK & (data >> 18));
-           u_tlb[page | 1] = (uint32)(RMASK & data);
+           SET_U_TLB(page & 01776, (uint32)(RMASK & (data >> 18)));
+           SET_U_TLB(page | 1, (uint32)(RMASK & data));
            data = u_tlb[page];
        } else {
            if (page & 0400)
                data = M[eb_ptr + (page >> 1)];
            else
                data = M[eb_ptr + (page >> 1) + 0600];
-           e_tlb[page & 01776] = (uint32)(RMASK & (data >> 18));
-           e_tlb[page | 1] = (uint32)(RMASK & data);
+           SET_E_TLB(page & 01776, (uint32)(RMASK & (data >> 18)));
+           SET_E_TLB(page | 1, (uint32)(RMASK & data));
            data = e_tlb[page];
        }
     }
@@ -2150,12 +2189,13 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
 
     /* Map the page */
     if (uf || upmp)
-       data = u_tlb[page];
+       data = U_TLB(page);
     else
-       data = e_tlb[page];
+       data = E_TLB(page);
 
     /* If not valid, go refill it */
     if (data == 0) {
+        tlb_miss++;
         data = load_tlb(uf | upmp, page, wr);
         if (data == 0 && page_fault) {
             fault_data |= ((uint64)addr);
@@ -2173,7 +2213,8 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
                fault_data |= BIT5;       /* BIT5 */
             return 0;
         }
-    }
+    } else
+        tlb_hit++;
 
     /* Check if we need to modify TLB entry for TOPS 20 */
     if (t20_page && (data & KL_PAG_A) && (wr & ((data & KL_PAG_W) == 0)) && (data & KL_PAG_S)) {
@@ -2188,9 +2229,9 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
         data |= KL_PAG_W;
         /* Map the page */
         if (uf || upmp)
-           u_tlb[page] = data;
+           SET_U_TLB(page, data);
         else
-           e_tlb[page] = data;
+           SET_E_TLB(page, data);
     }
 
     /* create location. */
@@ -2384,12 +2425,12 @@ load_tlb(int uf, int page, int wr)
         pg |= (data & 017777) << 1;
         /* Create 2 page table entries. */
         if (uf) {
-            u_tlb[page & 0776] = pg;
-            u_tlb[(page & 0776)|1] = pg|1;
+            SET_U_TLB(page & 0776, pg);
+            SET_U_TLB((page & 0776)|1, pg|1);
             data = u_tlb[page];
         } else {
-            e_tlb[page & 0776] = pg;
-            e_tlb[(page & 0776)|1] = pg|1;
+            SET_E_TLB(page & 0776, pg);
+            SET_E_TLB((page & 0776)|1, pg|1);
             data = e_tlb[page];
         }
     } else
@@ -2571,25 +2612,25 @@ pg_loop:
            data |= (sect & 037) << 18;
         /* And save it */
         if (uf)
-           u_tlb[page] = data & (SECTM|RMASK);
+           SET_U_TLB(page, data & (SECTM|RMASK));
         else
-           e_tlb[page] = data & (SECTM|RMASK);
+           SET_E_TLB(page, data & (SECTM|RMASK));
     } else {
 
        /* Map the page */
        sim_interval--;
        if (uf) {
            data = M[ub_ptr + (page >> 1)];
-           u_tlb[page & 01776] = (uint32)(RMASK & (data >> 18));
-           u_tlb[page | 1] = (uint32)(RMASK & data);
+           SET_U_TLB(page & 01776, (uint32)(RMASK & (data >> 18)));
+           SET_U_TLB(page | 1, (uint32)(RMASK & data));
            data = u_tlb[page];
        } else {
            if (page & 0400)
                data = M[eb_ptr + (page >> 1)];
            else
                data = M[eb_ptr + (page >> 1) + 0600];
-           e_tlb[page & 01776] = (uint32)(RMASK & (data >> 18));
-           e_tlb[page | 1] = (uint32)(RMASK & data);
+           SET_E_TLB(page & 01776, (uint32)(RMASK & (data >> 18)));
+           SET_E_TLB(page | 1, (uint32)(RMASK & data));
            data = e_tlb[page];
        }
     }
@@ -2678,14 +2719,15 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
 
     /* Map the page */
     if (uf || upmp)
-       data = u_tlb[page];
+       data = U_TLB(page);
     else
-       data = e_tlb[page];
+       data = E_TLB(page);
 
     if (QKLB && t20_page && ((data >> 18) & 037) != sect)
         data = 0;
     /* If not valid, go refill it */
     if (data == 0) {
+        tlb_miss++;
         data = load_tlb(uf | upmp, page, wr);
         if (data == 0 && page_fault) {
             fault_data |= ((uint64)addr);
@@ -2704,7 +2746,8 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
                fault_data |= BIT5;       /* BIT5 */
             return 0;
         }
-    }
+    } else
+        tlb_hit++;
 
     /* Check if we need to modify TLB entry for TOPS 20 */
     if (t20_page && (data & KL_PAG_A) && (wr & ((data & KL_PAG_W) == 0)) && (data & KL_PAG_S)) {
@@ -2719,9 +2762,9 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
         data |= KL_PAG_W;
         /* Map the page */
         if (uf || upmp)
-           u_tlb[page] = data;
+           SET_U_TLB(page, data);
         else
-           e_tlb[page] = data;
+           SET_E_TLB(page, data);
     }
 
     /* create location. */
@@ -2912,9 +2955,9 @@ int exec_page_lookup(t_addr addr, int wr, t_addr *loc)
 
     /* Map the page */
     if (upmp)
-       data = u_tlb[page];
+       data = U_TLB(page);
     else
-       data = e_tlb[page];
+       data = E_TLB(page);
 
     /* If not valid, go refill it */
     if (data == 0 || (data & 037) != 0) {
@@ -11126,12 +11169,7 @@ skip_op:
                                      else
 #endif
                                      ub_ptr = (MB & 03777) << 9;
-                                     for (f = 0; f < 512; f++) {
-                                        u_tlb[f] = 0;
-                                        e_tlb[f] = 0;
-                                     }
-                                     for (;f < 546; f++)
-                                        u_tlb[f] = 0;
+                                     flush_tlb();
                                  }
                                  sim_debug(DEBUG_DATAIO, &cpu_dev,
                                           "WRUBR  %012llo ebr=%06o ubr=%06o\n",
@@ -11141,12 +11179,7 @@ skip_op:
                            /* 70120 */
                            case 004:            /* WREBR */
                                  eb_ptr = (AR & 03777) << 9;
-                                 for (f = 0; f < 512; f++) {
-                                     e_tlb[f] = 0;
-                                     u_tlb[f] = 0;
-                                 }
-                                 for (;f < 546; f++)
-                                     u_tlb[f] = 0;
+                                 flush_tlb();
                                  page_enable = (AR & 020000) != 0;
                                  t20_page = (AR & 040000) != 0;
                                  page_fault = 0;
@@ -11283,10 +11316,7 @@ skip_op:
 #if KS_ITS
                                  if (QITS) {
                                      dbr1 = AB;
-                                     for (f = 0; f < 512; f++) {
-                                        u_tlb[f] = 0;
-                                        e_tlb[f] = 0;
-                                     }
+                                     flush_tlb();
                                      sim_debug(DEBUG_CONI, &cpu_dev, "WRDBR1 %012llo\n", dbr1);
                                      break;
                                  }
@@ -11302,10 +11332,7 @@ skip_op:
 #if KS_ITS
                                  if (QITS) {
                                      dbr2 = AB;
-                                     for (f = 0; f < 512; f++) {
-                                        u_tlb[f] = 0;
-                                        e_tlb[f] = 0;
-                                     }
+                                     flush_tlb();
                                      sim_debug(DEBUG_CONI, &cpu_dev, "WRDBR2 %012llo\n", dbr2);
                                      break;
                                  }
@@ -11321,10 +11348,7 @@ skip_op:
 #if KS_ITS
                                  if (QITS) {
                                      dbr3 = AB;
-                                     for (f = 0; f < 512; f++) {
-                                        u_tlb[f] = 0;
-                                        e_tlb[f] = 0;
-                                     }
+                                     flush_tlb();
                                      sim_debug(DEBUG_CONI, &cpu_dev, "WRDBR3 %012llo\n", dbr3);
                                      break;
                                  }
@@ -11340,10 +11364,7 @@ skip_op:
 #if KS_ITS
                                  if (QITS) {
                                      dbr4 = AB;
-                                     for (f = 0; f < 512; f++) {
-                                        u_tlb[f] = 0;
-                                        e_tlb[f] = 0;
-                                     }
+                                     flush_tlb();
                                      sim_debug(DEBUG_CONI, &cpu_dev, "WRDBR4 %012llo\n", dbr4);
                                      break;
                                  }
@@ -11396,12 +11417,7 @@ skip_op:
                                      if (Mem_read(0, 0, 0, 0))
                                         goto last;
                                      qua_time = MB;
-                                     for (f = 0; f < 512; f++) {
-                                        u_tlb[f] = 0;
-                                        e_tlb[f] = 0;
-                                     }
-                                     for (;f < 546; f++)
-                                        u_tlb[f] = 0;
+                                     flush_tlb();
                                      break;
                                  }
 #endif
@@ -13650,6 +13666,9 @@ t_stat cpu_reset (DEVICE *dptr)
     for (;i < 546; i++)
         u_tlb[i] = 0;
 #endif
+#if KL | KS
+    tlb_hit = tlb_miss = 0;
+#endif
 
     sim_brk_types = SWMASK('E') | SWMASK('W') | SWMASK('R');
     sim_brk_dflt = SWMASK ('E');
@@ -13692,9 +13711,9 @@ else {
              uf = 1;
         }
         if (uf)
-           tlb = u_tlb[page];
+           tlb = U_TLB(page);
         else
-           tlb = e_tlb[page];
+           tlb = E_TLB(page);
         if ((tlb & RSIGN) == 0)
            return 4;
         ea = ((tlb & 017777) << 9) + (ea & 0777);
@@ -13730,9 +13749,9 @@ else {
              uf = 1;
         }
         if (uf)
-           tlb = u_tlb[page];
+           tlb = U_TLB(page);
         else
-           tlb = e_tlb[page];
+           tlb = E_TLB(page);
         if ((tlb & RSIGN) == 0)
            return 4;
         ea = ((tlb & 017777) << 9) + (ea & 0777);
@@ -13953,6 +13972,15 @@ return SCPE_OK;
 }
 #endif
 
+#if KL | KS
+/* Show TLB statistics */
+t_stat cpu_show_tlb (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+fprintf (st, "TLB hits=%llu, misses=%llu", tlb_hit, tlb_miss);
+return SCPE_OK;
+}
+#endif
+
 /* Set history */
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
@@ -852,6 +852,27 @@ extern UNIT     auxcpu_unit[];
 //int slave_write (t_addr addr, uint64);
 //extern UNIT     slave_unit[];
 #endif
+#if NUM_DEVS_AUXCPU || NUM_DEVS_SLAVE
+/* Shared memory mailbox between AUXCPU and SLAVE when attached with -M.
+   Request and response hold one packet each, length in the first byte.
+   The state only moves IDLE -> POST -> REQ -> BUSY -> RSP -> IDLE, each
+   step taken by a compare and swap by the side which owns the mailbox
+   next.  The response echoes the request's sequence number. */
+#define AUX_MBOX_IDLE   0               /* Mailbox empty */
+#define AUX_MBOX_REQ    1               /* Request posted by AUXCPU */
+#define AUX_MBOX_RSP    2               /* Response posted by SLAVE */
+#define AUX_MBOX_POST   3               /* AUXCPU writing a request */
+#define AUX_MBOX_BUSY   4               /* SLAVE serving the request */
+
+struct aux_mbox {
+    int32       state;                  /* AUX_MBOX_xxx */
+    int32       slave;                  /* SLAVE is attached */
+    int32       req_seq;                /* Request sequence number */
+    int32       rsp_seq;                /* Sequence number answered */
+    uint8       request[12];
+    uint8       response[12];
+};
+#endif
 #if NUM_DEVS_III
 extern uint32 iii_keyboard_line (void *);
 #endif
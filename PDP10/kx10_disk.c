@@ -72,8 +72,6 @@ disk_read(UNIT *uptr, uint64 *buffer, int sector, int wps)
     int      da;
     int      wc;
     int      bc;
-    int      wp;
-    uint64   temp;
     uint8    conv_buff[2048];
     switch(GET_FMT(uptr->flags)) {
     case SIMH:
@@ -90,20 +88,7 @@ disk_read(UNIT *uptr, uint64 *buffer, int sector, int wps)
             wc = sim_fread (&conv_buff, 1, bc, uptr->fileref);
             while (wc < bc)
                  conv_buff[wc++] = 0;
-            for (wp = wc = 0; wp < wps;) {
-                temp = ((uint64)conv_buff[wc++]) << 28;
-                temp |= ((uint64)conv_buff[wc++]) << 20;
-                temp |= ((uint64)conv_buff[wc++]) << 12;
-                temp |= ((uint64)conv_buff[wc++]) << 4;
-                temp |= ((uint64)conv_buff[wc]) >> 4;
-                buffer[wp++] = temp;
-                temp = ((uint64)conv_buff[wc++] & 0xf) << 32;
-                temp |= ((uint64)conv_buff[wc++]) << 24;
-                temp |= ((uint64)conv_buff[wc++]) << 16;
-                temp |= ((uint64)conv_buff[wc++]) << 8;
-                temp |= ((uint64)conv_buff[wc++]);
-                buffer[wp++] = temp;
-            }
+            sim_buf_unpack_36 (buffer, conv_buff, wps, TRUE);
             break;
 
     case DLD9:
@@ -113,20 +98,7 @@ disk_read(UNIT *uptr, uint64 *buffer, int sector, int wps)
             wc = sim_fread (&conv_buff, 1, bc, uptr->fileref);
             while (wc < bc)
                  conv_buff[wc++] = 0;
-            for (wp = wc = 0; wp < wps;) {
-                temp = ((uint64)conv_buff[wc++]);
-                temp |= ((uint64)conv_buff[wc++]) << 8;
-                temp |= ((uint64)conv_buff[wc++]) << 16;
-                temp |= ((uint64)conv_buff[wc++]) << 24;
-                temp |= ((uint64)conv_buff[wc] & 0xf) << 32;
-                buffer[wp++] = temp;
-                temp = ((uint64)conv_buff[wc++] & 0xf0) >> 4;
-                temp |= ((uint64)conv_buff[wc++]) << 4;
-                temp |= ((uint64)conv_buff[wc++]) << 12;
-                temp |= ((uint64)conv_buff[wc++]) << 20;
-                temp |= ((uint64)conv_buff[wc++]) << 28;
-                buffer[wp++] = temp;
-            }
+            sim_buf_unpack_36 (buffer, conv_buff, wps, FALSE);
             break;
      }
      return SCPE_OK;
@@ -138,8 +110,6 @@ disk_write(UNIT *uptr, uint64 *buffer, int sector, int wps)
     int      da;
     int      wc;
     int      bc;
-    int      wp;
-    uint64   temp;
     uint8    conv_buff[2048];
     switch(GET_FMT(uptr->flags)) {
     case SIMH:
@@ -149,40 +119,14 @@ disk_write(UNIT *uptr, uint64 *buffer, int sector, int wps)
             break;
     case DBD9:
             bc = (wps / 2) * 9;
-            for (wp = wc = 0; wp < wps;) {
-                temp = buffer[wp++];
-                conv_buff[wc++] = (uint8)((temp >> 28) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 20) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 12) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 4) & 0xff);
-                conv_buff[wc] = (uint8)((temp & 0xf) << 4);
-                temp = buffer[wp++];
-                conv_buff[wc++] |= (uint8)((temp >> 32) & 0xf);
-                conv_buff[wc++] = (uint8)((temp >> 24) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 16) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 8) & 0xff);
-                conv_buff[wc++] = (uint8)(temp & 0xff);
-            }
+            sim_buf_pack_36 (conv_buff, buffer, wps, TRUE);
             da = sector * bc;
             (void)sim_fseek(uptr->fileref, da, SEEK_SET);
             wc = sim_fwrite (&conv_buff, 1, bc, uptr->fileref);
             return SCPE_OK;
     case DLD9:
             bc = (wps / 2) * 9;
-            for (wp = wc = 0; wp < wps;) {
-                temp = buffer[wp++];
-                conv_buff[wc++] = (uint8)(temp & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 8) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 16) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 24) & 0xff);
-                conv_buff[wc] = (uint8)((temp >> 32)  & 0xf);
-                temp = buffer[wp++];
-                conv_buff[wc++] |= (uint8)((temp << 4) & 0xf0);
-                conv_buff[wc++] = (uint8)((temp >> 4) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 12) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 20) & 0xff);
-                conv_buff[wc++] = (uint8)((temp >> 28) & 0xff);
-            }
+            sim_buf_pack_36 (conv_buff, buffer, wps, FALSE);
             da = sector * bc;
             (void)sim_fseek(uptr->fileref, da, SEEK_SET);
             wc = sim_fwrite (&conv_buff, 1, bc, uptr->fileref);
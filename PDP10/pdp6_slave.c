@@ -48,6 +48,7 @@
 #define SLAVE_DEVNUM      020
 
 #define SLAVE_POLL        1000
+#define SLAVE_MBOX_POLL   10
 
 #define PIA     u3
 #define STATUS  u4
@@ -109,12 +110,16 @@ DEVICE slave_dev = {
 
 static TMLN slave_ldsc;                                 /* line descriptor */
 static TMXR slave_desc = { 1, 0, 0, &slave_ldsc };      /* mux descriptor */
+static SHMEM *slave_shmem = NULL;                       /* shared memory mailbox */
+static struct aux_mbox *slave_mbox = NULL;
 
 static t_stat slave_reset (DEVICE *dptr)
 {
   sim_debug(DEBUG_TRC, dptr, "slave_reset()\n");
 
-  slave_unit[0].flags |= UNIT_ATTABLE | UNIT_IDLE;
+  slave_unit[0].flags |= UNIT_ATTABLE;
+  if (slave_mbox == NULL)
+    slave_unit[0].flags |= UNIT_IDLE;
   slave_desc.packet = TRUE;
   slave_desc.notelnet = TRUE;
   slave_desc.buffered = 2048;
@@ -135,6 +140,23 @@ static t_stat slave_attach (UNIT *uptr, CONST char *cptr)
     return SCPE_ARG;
   if (!(uptr->flags & UNIT_ATTABLE))
     return SCPE_NOATT;
+  if (sim_switches & SWMASK ('M')) {
+    void *basead;
+
+    r = sim_shmem_open (cptr, sizeof (struct aux_mbox), &slave_shmem, &basead);
+    if (r != SCPE_OK)
+      return r;
+    uptr->filename = (char *)malloc (strlen (cptr) + 1);
+    strcpy (uptr->filename, cptr);
+    uptr->flags |= UNIT_ATT;
+    uptr->flags &= ~UNIT_IDLE;  /* idling would sleep through requests */
+    uptr->wait = SLAVE_MBOX_POLL;
+    slave_mbox = (struct aux_mbox *)basead;
+    sim_shmem_atomic_cas (&slave_mbox->slave, 0, 1);
+    sim_debug(DEBUG_TRC, &slave_dev, "attach mailbox %s\n", cptr);
+    sim_activate (uptr, 10);    /* start poll */
+    return SCPE_OK;
+  }
   r = tmxr_attach_ex (&slave_desc, uptr, cptr, FALSE);
   if (r != SCPE_OK)                                       /* error? */
     return r;
@@ -150,6 +172,19 @@ static t_stat slave_detach (UNIT *uptr)
   if (!(uptr->flags & UNIT_ATT))
     return SCPE_OK;
   sim_cancel (uptr);
+  if (slave_mbox != NULL) {
+    sim_shmem_atomic_cas (&slave_mbox->slave, 1, 0);
+    /* Closing also removes the name, so both sides must attach again. */
+    sim_shmem_close (slave_shmem);
+    slave_shmem = NULL;
+    slave_mbox = NULL;
+    free (uptr->filename);
+    uptr->filename = NULL;
+    uptr->flags &= ~UNIT_ATT;
+    uptr->flags |= UNIT_IDLE;
+    uptr->wait = SLAVE_POLL;
+    return SCPE_OK;
+  }
   r = tmxr_detach (&slave_desc, uptr);
   uptr->filename = NULL;
   return r;
@@ -158,6 +193,8 @@ static t_stat slave_detach (UNIT *uptr)
 static int error (const char *message)
 {
   sim_debug (DEBUG_TRC, &slave_dev, "%s\r\n", message);
+  if (slave_mbox != NULL)
+    return -1;
   sim_debug (DEBUG_TRC, &slave_dev, "CLOSE\r\n");
   slave_ldsc.rcve = 0;
   tmxr_reset_ln (&slave_ldsc);
@@ -170,22 +207,19 @@ static void build (uint8 *request, uint8 octet)
   request[request[0]] = octet & 0377;
 }
 
-static t_stat process_request (UNIT *uptr, const uint8 *request, size_t size)
+/* Decode a request and build the reply in response, length first. */
+static t_stat process_request (UNIT *uptr, const uint8 *request, size_t size,
+                               uint8 *response)
 {
-  uint8 response[12];
   t_addr address;
   uint64 data;
-  t_stat stat;
 
-  if (size == 0)
-    return SCPE_OK;
+  memset (response, 0, 12);
   if (size > 9)
     return error ("Malformed transaction");
 
   sim_debug(DEBUG_CMD, &slave_dev, "got packet\n");
 
-  memset (response, 0, sizeof response);
-
   switch (request[0]) {
   case DATI:
     address = request[1] + (request[2] << 8) + (request[3] << 16);
@@ -232,18 +266,45 @@ static t_stat process_request (UNIT *uptr, const uint8 *request, size_t size)
   default:
     return error ("Malformed transaction");
   }
+  return SCPE_OK;
+}
 
-  stat = tmxr_put_packet_ln (&slave_ldsc, response + 1, (size_t)response[0]);
-  if (stat != SCPE_OK)
-    return error ("Write error in transaction");
-  return stat;
+/* Serve a request posted in the shared memory mailbox.  REQ -> BUSY
+   claims the request before it is read, so the AUXCPU can't take it back
+   meanwhile.  The response and the request's sequence number are copied
+   out before BUSY -> RSP, so the AUXCPU never sees a partial reply. */
+static void slave_mbox_poll (UNIT *uptr)
+{
+  uint8 request[12];
+  uint8 response[12];
+  int32 seq;
+
+  if (!sim_shmem_atomic_cas (&slave_mbox->state, AUX_MBOX_REQ, AUX_MBOX_BUSY))
+    return;
+  memcpy (request, slave_mbox->request, sizeof request);
+  seq = slave_mbox->req_seq;
+  if (process_request (uptr, request + 1, (size_t)request[0],
+                       response) != SCPE_OK) {
+    memset (response, 0, sizeof response);
+    build (response, ERR);
+  }
+  memcpy (slave_mbox->response, response, sizeof response);
+  slave_mbox->rsp_seq = seq;
+  sim_shmem_atomic_cas (&slave_mbox->state, AUX_MBOX_BUSY, AUX_MBOX_RSP);
 }
 
 static t_stat slave_svc (UNIT *uptr)
 {
   const uint8 *slave_request;
+  uint8 response[12];
   size_t size;
 
+  if (slave_mbox != NULL) {
+    slave_mbox_poll (uptr);
+    sim_activate (uptr, uptr->wait);
+    return SCPE_OK;
+  }
+
   if (tmxr_poll_conn(&slave_desc) >= 0) {
     sim_debug(DEBUG_CMD, &slave_dev, "got connection\n");
     slave_ldsc.rcve = 1;
@@ -258,8 +319,13 @@ static t_stat slave_svc (UNIT *uptr)
     sim_debug(DEBUG_CMD, &slave_dev, "reset\n");
   }
 
-  if (tmxr_get_packet_ln (&slave_ldsc, &slave_request, &size) == SCPE_OK)
-    process_request (uptr, slave_request, size);
+  if (tmxr_get_packet_ln (&slave_ldsc, &slave_request, &size) == SCPE_OK &&
+      size != 0 &&
+      process_request (uptr, slave_request, size, response) == SCPE_OK) {
+    if (tmxr_put_packet_ln (&slave_ldsc, response + 1,
+                            (size_t)response[0]) != SCPE_OK)
+      error ("Write error in transaction");
+  }
 
   sim_clock_coschedule (uptr, uptr->wait);
   return SCPE_OK;
@@ -277,6 +343,15 @@ const char helpString[] =
     "\n"
     "+sim> ATTACH %U port\n"
     "\n"
+    " When both simulators run on the same host, the -M switch attaches to a\n"
+    " named shared memory mailbox instead.  The AUXCPU in the other simulator\n"
+    " must be attached to the same name with -M.  The mailbox is polled every\n"
+    " POLL instructions, which keeps the host busy even when idle.  Detaching\n"
+    " either side removes the name, so after a detach both the %D and the\n"
+    " AUXCPU must be attached again.\n"
+    "\n"
+    "+sim> ATTACH -M %U name\n"
+    "\n"
     ;
 
  return scp_help (st, dptr, uptr, flag, helpString, cptr);
@@ -2847,6 +2847,47 @@ if (iopageW (data, pa, WRITEB) != SCPE_OK) {            /* invalid I/O addr? */
 return;
 }
 
+/* Translation cache
+
+   Each APR has a cache entry holding the relocation base and the range of
+   displacements which can be read, and written, without a trap or abort.
+   An entry is tagged with the APR value it was built from, so any change
+   to the PAR or PDR (by the program, by the W and A bits being set, or by
+   SCP register deposits) is noticed on the next reference and the entry
+   rebuilt.  References outside the cached ranges take the full access
+   control and page length checks, which produce the traps and aborts.
+*/
+
+typedef struct {
+    int32       apr;                                    /* APR tag */
+    int32       base;                                   /* PAR << 6 */
+    int32       lo;                                     /* lowest legal displacement */
+    uint32      rd_lim;                                 /* # readable displacements */
+    uint32      wr_lim;                                 /* # writeable displacements */
+    } MMU_TLB;
+
+MMU_TLB mmu_tlb[64];
+
+static void mmu_tlb_fill (MMU_TLB *tlb, int32 apr)
+{
+int32 plf = (apr & PDR_PLF) >> 2;                       /* page length, as va<12:6> */
+int32 lo, hi;
+
+if (apr & PDR_ED) {                                     /* expand down */
+    lo = plf;
+    hi = VA_DF;
+    }
+else {                                                  /* expand up */
+    lo = 0;
+    hi = plf | (VA_DF & ~VA_BN);
+    }
+tlb->apr = apr;
+tlb->base = (apr >> 10) & 017777700;
+tlb->lo = lo;
+tlb->rd_lim = ((apr & PDR_PRD) == 2)? (uint32)(hi - lo + 1): 0;
+tlb->wr_lim = (((apr & PDR_ACF) == 6) && (apr & PDR_W))? (uint32)(hi - lo + 1): 0;
+}
+
 /* Relocate virtual address, read access
 
    Inputs:
@@ -2857,8 +2898,9 @@ return;
    with an appropriate trap code.
 
    Notes:
-   - The 'normal' read codes (010, 110) are done in-line; all
-     others in a subroutine
+   - References within the cached readable range are done in-line;
+     others do the 'normal' read code check (010, 110) and then
+     the page length check; all other codes in a subroutine
    - APRFILE[UNUSED] is all zeroes, forcing non-resident abort
    - Aborts must update MMR0<15:13,6:1> if updating is enabled
 */
@@ -2866,15 +2908,21 @@ return;
 int32 relocR (int32 va)
 {
 int32 apridx, apr, pa;
+MMU_TLB *tlb;
 
 if (MMR0 & MMR0_MME) {                                  /* if mmgt */
     apridx = (va >> VA_V_APF) & 077;                    /* index into APR */
     apr = APRFILE[apridx];                              /* with va<18:13> */
-    if ((apr & PDR_PRD) != 2)                           /* not 2, 6? */
-         relocR_test (va, apridx);                      /* long test */
-    if (PLF_test (va, apr))                             /* pg lnt error? */
-        reloc_abort (MMR0_PL, apridx);
-    pa = ((va & VA_DF) + ((apr >> 10) & 017777700)) & PAMASK;
+    tlb = &mmu_tlb[apridx];
+    if (tlb->apr != apr)                                /* APR changed? */
+        mmu_tlb_fill (tlb, apr);
+    if ((uint32)((va & VA_DF) - tlb->lo) >= tlb->rd_lim) {
+        if ((apr & PDR_PRD) != 2)                       /* not 2, 6? */
+             relocR_test (va, apridx);                  /* long test */
+        if (PLF_test (va, apr))                         /* pg lnt error? */
+            reloc_abort (MMR0_PL, apridx);
+        }
+    pa = ((va & VA_DF) + tlb->base) & PAMASK;
     if ((MMR3 & MMR3_M22E) == 0) {
         pa = pa & 0777777;
         if (pa >= 0760000)
@@ -2966,8 +3014,10 @@ return;
    with an appropriate trap code.
 
    Notes:
-   - The 'normal' write code (110) is done in-line; all others
-     in a subroutine
+   - References within the cached writeable range (which requires
+     W to be set already) are done in-line; others do the 'normal'
+     write code check (110), the page length check, and set W; all
+     other codes in a subroutine
    - APRFILE[UNUSED] is all zeroes, forcing non-resident abort
    - Aborts must update MMR0<15:13,6:1> if updating is enabled
 */
@@ -2975,16 +3025,22 @@ return;
 int32 relocW (int32 va)
 {
 int32 apridx, apr, pa;
+MMU_TLB *tlb;
 
 if (MMR0 & MMR0_MME) {                                  /* if mmgt */
     apridx = (va >> VA_V_APF) & 077;                    /* index into APR */
     apr = APRFILE[apridx];                              /* with va<18:13> */
-    if ((apr & PDR_ACF) != 6)                           /* not writeable? */
-        relocW_test (va, apridx);                       /* long test */
-    if (PLF_test (va, apr))                             /* pg lnt error? */
-        reloc_abort (MMR0_PL, apridx);
-    APRFILE[apridx] |= PDR_W;                           /* set W */
-    pa = ((va & VA_DF) + ((apr >> 10) & 017777700)) & PAMASK;
+    tlb = &mmu_tlb[apridx];
+    if (tlb->apr != apr)                                /* APR changed? */
+        mmu_tlb_fill (tlb, apr);
+    if ((uint32)((va & VA_DF) - tlb->lo) >= tlb->wr_lim) {
+        if ((apr & PDR_ACF) != 6)                       /* not writeable? */
+            relocW_test (va, apridx);                   /* long test */
+        if (PLF_test (va, apr))                         /* pg lnt error? */
+            reloc_abort (MMR0_PL, apridx);
+        APRFILE[apridx] |= PDR_W;                       /* set W */
+        }
+    pa = ((va & VA_DF) + tlb->base) & PAMASK;
     if ((MMR3 & MMR3_M22E) == 0) {
         pa = pa & 0777777;
         if (pa >= 0760000)
@@ -152,6 +152,8 @@ extern int32 MMR2;
 #define RQ_MAXDR        254                             /* max # drives */
 #define RQ_NUMBY        512                             /* bytes per block */
 #define RQ_MAXFR        (1 << 16)                       /* max xfer */
+#define RQ_MAXCFR       (1 << 18)                       /* max coalesced xfer */
+#define RQ_MAXCPK       16                              /* max cmds per coalesced xfer */
 #define RQ_MAPXFER      (1u << 31)                      /* mapped xfer */
 #define RQ_M_PFN        0x1FFFFF                        /* map entry PFN */
 
@@ -174,6 +176,7 @@ extern int32 MMR2;
 #define io_complete     u6                              /* io completion flag */
 /* we can re-use filebuf because we don't set UNIT_BUFABLE in flags */
 #define rqxb            filebuf                         /* xfer buffer */
+#define rqcs            up7                             /* coalesce state */
 #define RQ_RMV(u)       ((drv_tab[GET_DTYPE (u->flags)].flgs & RQDF_RMV)? \
                         UF_RMV: 0)
 #define RQ_WPH(u)       (((drv_tab[GET_DTYPE (u->flags)].flgs & RQDF_RO) || \
@@ -1083,8 +1086,21 @@ typedef struct {
     struct uq_ring      rq;                             /* rsp ring */
     struct rqpkt        pak[RQ_NPKTS];                  /* packet queue */
     uint16              max_plug;                       /* highest unit plug number */
+    uint32              coalesce;                       /* merge queued xfers */
+    uint32              xfr_cmds;                       /* xfer cmds completed */
+    uint32              xfr_hio;                        /* host I/Os completed */
     } MSC;
 
+/* Coalesced transfer state, one per unit, allocated on first use */
+
+typedef struct {
+    uint32              npkt;                           /* # pkts in xfer */
+    uint32              lbn;                            /* starting lbn */
+    uint16              pkt[RQ_MAXCPK];                 /* pkts, in queue order */
+    uint32              ref[RQ_MAXCPK];                 /* their command refs */
+    uint16              xb[RQ_MAXCFR >> 1];             /* xfer buffer */
+    } RQ_COAL;
+
 /* debugging bitmaps */
 #define DBG_TRC  0x0001                                 /* trace routine calls */
 #define DBG_INI  0x0002                                 /* display setup/init sequence info */
@@ -1151,6 +1167,8 @@ t_stat rq_show_plug (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_set_drives (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat rq_show_type (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_ctype (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat rq_set_coalesce (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat rq_show_coalesce (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_wlk (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_ctrl (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_unitq (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
@@ -1182,6 +1200,10 @@ t_bool rq_getdesc (MSC *cp, struct uq_ring *ring, uint32 *desc);
 t_bool rq_putdesc (MSC *cp, struct uq_ring *ring, uint32 desc);
 uint16 rq_rw_valid (MSC *cp, uint16 pkt, UNIT *uptr, uint16 cmd);
 t_bool rq_rw_end (MSC *cp, UNIT *uptr, uint16 flg, uint16 sts);
+void rq_rw_setw (MSC *cp, uint16 pkt);
+t_bool rq_coalesce (MSC *cp, UNIT *uptr, uint32 cmd, uint32 ba, uint32 bc, uint32 bl, uint32 ma);
+t_bool rq_coalesce_ok (MSC *cp, UNIT *uptr, uint16 pkt, uint16 npkt, uint32 lbn);
+t_stat rq_coalesce_end (MSC *cp, UNIT *uptr, uint32 cmd);
 uint32 rq_map_ba (uint32 ba, uint32 ma);
 int32 rq_readb (uint32 ba, int32 bc, uint32 ma, uint8 *buf);
 int32 rq_readw (uint32 ba, int32 bc, uint32 ma, uint16 *buf);
@@ -1252,6 +1274,7 @@ REG rq_reg[] = {
     { FLDATA  (PRGI,    rq_ctx.prgi,                 0), REG_HIDDEN },
     { FLDATA  (PIP,     rq_ctx.pip,                  0), REG_HIDDEN },
     { BINRDATA(CTYPE,   rq_ctx.ctype,               32), REG_HIDDEN },
+    { FLDATA  (COAL,    rq_ctx.coalesce,             0), REG_HIDDEN },
     { DRDATAD (ITIME,   rq_itime,                   24, "init time delay, except stage 4"), PV_LEFT + REG_NZ },
     { DRDATAD (I4TIME,  rq_itime4,                  24, "init stage 4 delay"), PV_LEFT + REG_NZ },
     { DRDATAD (QTIME,   rq_qtime,                   24, "response time for 'immediate' packets"), PV_LEFT + REG_NZ },
@@ -1304,6 +1327,10 @@ MTAB rq_mod[] = {
       &rq_set_ctype, NULL, NULL, "Set KLESI (RC25) Controller Type"  },
     { MTAB_XTD|MTAB_VDV, RUX50_CTYPE, NULL, "RUX50",
       &rq_set_ctype, NULL, NULL, "Set RUX50 (UNIBUS RX50) Controller Type" },
+    { MTAB_XTD|MTAB_VDV, 1, "COALESCE", "COALESCE",
+      &rq_set_coalesce, &rq_show_coalesce, NULL, "Merge contiguous queued transfers into single host I/Os" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOCOALESCE",
+      &rq_set_coalesce, NULL, NULL, "Issue one host I/O per transfer command" },
     { MTAB_XTD|MTAB_VUN|MTAB_NMO, 0, "UNITQ", NULL,
       NULL, &rq_show_unitq, NULL, "Display unit queue" },
     { MTAB_XTD|MTAB_VUN, RX18_DTYPE, NULL, "RX18",
@@ -1465,6 +1492,7 @@ REG rqb_reg[] = {
     { FLDATA  (PRGI,    rqb_ctx.prgi,                 0), REG_HIDDEN },
     { FLDATA  (PIP,     rqb_ctx.pip,                  0), REG_HIDDEN },
     { BINRDATA(CTYPE,   rqb_ctx.ctype,               32), REG_HIDDEN },
+    { FLDATA  (COAL,    rqb_ctx.coalesce,             0), REG_HIDDEN },
     { VBRDATAD (PKTS,   rqb_ctx.pak,     DEV_RDX,    16, sizeof(rq_ctx.pak)/2, "packet buffers, 33W each, 32 entries") },
     { URDATAD (CPKT,    rqb_unit[0].cpkt, 10, 5, 0, RQ_NUMDR, 0, "current packet, units 0 to 3") },
     { URDATAD (UCNUM,   rqb_unit[0].cnum, 10, 5, 0, RQ_NUMDR, 0, "ctrl number, units 0 to 3") },
@@ -1538,6 +1566,7 @@ REG rqc_reg[] = {
     { FLDATA  (PRGI,    rqc_ctx.prgi,                 0), REG_HIDDEN },
     { FLDATA  (PIP,     rqc_ctx.pip,                  0), REG_HIDDEN },
     { BINRDATA(CTYPE,   rqc_ctx.ctype,               32), REG_HIDDEN },
+    { FLDATA  (COAL,    rqc_ctx.coalesce,             0), REG_HIDDEN },
     { VBRDATAD (PKTS,   rqc_ctx.pak,     DEV_RDX,    16, sizeof(rq_ctx.pak)/2, "packet buffers, 33W each, 32 entries") },
     { URDATAD (CPKT,    rqc_unit[0].cpkt, 10, 5, 0, RQ_NUMDR, 0, "current packet, units 0 to 3") },
     { URDATAD (UCNUM,   rqc_unit[0].cnum, 10, 5, 0, RQ_NUMDR, 0, "ctrl number, units 0 to 3") },
@@ -1611,6 +1640,7 @@ REG rqd_reg[] = {
     { FLDATA  (PRGI,    rqd_ctx.prgi,                 0), REG_HIDDEN },
     { FLDATA  (PIP,     rqd_ctx.pip,                  0), REG_HIDDEN },
     { BINRDATA(CTYPE,   rqd_ctx.ctype,               32), REG_HIDDEN },
+    { FLDATA  (COAL,    rqd_ctx.coalesce,             0), REG_HIDDEN },
     { VBRDATAD (PKTS,   rqd_ctx.pak,     DEV_RDX,    16, sizeof(rq_ctx.pak)/2, "packet buffers, 33W each, 32 entries") },
     { URDATAD (CPKT,    rqd_unit[0].cpkt, 10, 5, 0, RQ_NUMDR, 0, "current packet, units 0 to 3") },
     { URDATAD (UCNUM,   rqd_unit[0].cnum, 10, 5, 0, RQ_NUMDR, 0, "ctrl number, units 0 to 3") },
@@ -1999,6 +2029,9 @@ if ((uptr = rq_getucb (cp, lu))) {                      /* get unit */
         tpkt = uptr->cpkt;                              /* save match */
         uptr->cpkt = 0;                                 /* gonzo */
         sim_cancel (uptr);                              /* cancel unit */
+        uptr->io_complete = 0;                          /* drop pending bottom end */
+        if (uptr->rqcs)                                 /* merged cmds stay queued */
+            ((RQ_COAL *)uptr->rqcs)->npkt = 0;
         sim_activate (dptr->units + RQ_QUEUE, rq_qtime);
         }
     else if (uptr->pktq &&                              /* head of q? */
@@ -2287,14 +2320,7 @@ if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
     sts = rq_rw_valid (cp, pkt, uptr, cmd);             /* validity checks */
     if (sts == 0) {                                     /* ok? */
         uptr->cpkt = pkt;                               /* op in progress */
-        cp->pak[pkt].d[RW_WBAL] = cp->pak[pkt].d[RW_BAL];
-        cp->pak[pkt].d[RW_WBAH] = cp->pak[pkt].d[RW_BAH];
-        cp->pak[pkt].d[RW_WBCL] = cp->pak[pkt].d[RW_BCL];
-        cp->pak[pkt].d[RW_WBCH] = cp->pak[pkt].d[RW_BCH];
-        cp->pak[pkt].d[RW_WBLL] = cp->pak[pkt].d[RW_LBNL];
-        cp->pak[pkt].d[RW_WBLH] = cp->pak[pkt].d[RW_LBNH];
-        cp->pak[pkt].d[RW_WMPL] = cp->pak[pkt].d[RW_MAPL];
-        cp->pak[pkt].d[RW_WMPH] = cp->pak[pkt].d[RW_MAPH];
+        rq_rw_setw (cp, pkt);                           /* init working copy */
         uptr->iostarttime = sim_grtime();
         sim_activate (uptr, 0);                         /* activate */
         sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_rw - started\n");
@@ -2307,6 +2333,20 @@ rq_putr (cp, pkt, cmd | OP_END, 0, sts, RW_LNT_D, UQ_TYP_SEQ);
 return rq_putpkt (cp, pkt, TRUE);
 }
 
+/* Initialize transfer working fields */
+
+void rq_rw_setw (MSC *cp, uint16 pkt)
+{
+cp->pak[pkt].d[RW_WBAL] = cp->pak[pkt].d[RW_BAL];
+cp->pak[pkt].d[RW_WBAH] = cp->pak[pkt].d[RW_BAH];
+cp->pak[pkt].d[RW_WBCL] = cp->pak[pkt].d[RW_BCL];
+cp->pak[pkt].d[RW_WBCH] = cp->pak[pkt].d[RW_BCH];
+cp->pak[pkt].d[RW_WBLL] = cp->pak[pkt].d[RW_LBNL];
+cp->pak[pkt].d[RW_WBLH] = cp->pak[pkt].d[RW_LBNH];
+cp->pak[pkt].d[RW_WMPL] = cp->pak[pkt].d[RW_MAPL];
+cp->pak[pkt].d[RW_WMPH] = cp->pak[pkt].d[RW_MAPH];
+}
+
 /* Validity checks */
 
 uint16 rq_rw_valid (MSC *cp, uint16 pkt, UNIT *uptr, uint16 cmd)
@@ -2357,6 +2397,7 @@ sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_io_complete(status=%d)\n", status);
 
 uptr->io_status = status;
 uptr->io_complete = 1;
+cp->xfr_hio++;                                          /* count host I/O */
 /* Reschedule for the appropriate delay */
 sim_activate_notbefore (uptr, uptr->iostarttime+rq_xtime);
 }
@@ -2500,6 +2541,8 @@ if ((cmd == OP_ERS) || (cmd == OP_WR)) {                /* write op? */
     }
 
 if (!uptr->io_complete) { /* Top End (I/O Initiation) Processing */
+    if (rq_coalesce (cp, uptr, cmd, ba, bc, bl, ma))    /* merged with queued cmds? */
+        return SCPE_OK;
     if (cmd == OP_ERS) {                                /* erase? */
         wwc = ((tbc + (RQ_NUMBY - 1)) & ~(RQ_NUMBY - 1)) >> 1;
         memset (uptr->rqxb, 0, wwc * sizeof(uint16));   /* clr buf */
@@ -2526,6 +2569,11 @@ if (!uptr->io_complete) { /* Top End (I/O Initiation) Processing */
 else { /* Bottom End (After I/O processing) */
     uptr->io_complete = 0;
     err = uptr->io_status;
+    if (uptr->rqcs && ((RQ_COAL *)uptr->rqcs)->npkt) {  /* coalesced xfer? */
+        if (!err)
+            return rq_coalesce_end (cp, uptr, cmd);
+        ((RQ_COAL *)uptr->rqcs)->npkt = 0;              /* error, only cpkt reports it */
+        }
     if (cmd == OP_ERS) {                                /* erase? */
         }
 
@@ -2591,6 +2639,129 @@ else rq_rw_end (cp, uptr, 0, ST_SUC);                   /* done! */
 return SCPE_OK;
 }
 
+/* Coalesce queued transfers
+
+   Called at the top end of a transfer.  If the current read or write
+   completes in a single pass, the commands queued behind it on the unit
+   which continue it at the next LBN are merged into one host I/O.  The
+   merged commands stay on the unit queue until the host I/O completes,
+   so that an abort still finds them there; rq_coalesce_end then retires
+   them in queue order.  Write data is fetched from memory here, a
+   command whose buffer is not fully addressable ends the merge and is
+   left to be processed on its own.
+*/
+
+t_bool rq_coalesce (MSC *cp, UNIT *uptr, uint32 cmd, uint32 ba, uint32 bc, uint32 bl, uint32 ma)
+{
+RQ_COAL *cs = (RQ_COAL *) uptr->rqcs;
+uint16 pkt = uptr->cpkt;
+uint16 npkt;
+uint32 nbc, tbc;
+
+if (cs != NULL)
+    cs->npkt = 0;                                       /* not coalesced */
+if (!cp->coalesce ||                                    /* disabled? */
+    ((cmd != OP_RD) && (cmd != OP_WR)) ||               /* not rd/wr? */
+    (bc > RQ_MAXFR) || (bc & (RQ_NUMBY - 1)) ||         /* not one pass of blocks? */
+    (bc != GETP32 (pkt, RW_BCL)) ||                     /* already started? */
+    !rq_coalesce_ok (cp, uptr, pkt, uptr->pktq, bl + (bc / RQ_NUMBY)))
+    return FALSE;
+if (cs == NULL) {                                       /* first use? */
+    cs = (RQ_COAL *) calloc (1, sizeof (*cs));
+    if (cs == NULL)
+        return FALSE;
+    uptr->rqcs = (void *) cs;
+    }
+if ((cmd == OP_WR) && rq_readw (ba, bc, ma, cs->xb))    /* fetch, nxm? */
+    return FALSE;                                       /* normal path reports it */
+cs->pkt[0] = pkt;
+cs->ref[0] = GETP32 (pkt, CMD_REFL);
+cs->npkt = 1;
+cs->lbn = bl;
+tbc = bc;
+for (npkt = uptr->pktq; npkt && (cs->npkt < RQ_MAXCPK); npkt = cp->pak[npkt].link) {
+    if (!rq_coalesce_ok (cp, uptr, pkt, npkt, bl + (tbc / RQ_NUMBY)))
+        break;
+    nbc = GETP32 (npkt, RW_BCL);
+    if ((tbc + nbc) > RQ_MAXCFR)                        /* won't fit? */
+        break;
+    if ((cmd == OP_WR) &&                               /* fetch, nxm? */
+        rq_readw (GETP32 (npkt, RW_BAL), nbc, GETP32 (npkt, RW_MAPL), cs->xb + (tbc >> 1)))
+        break;
+    cs->pkt[cs->npkt] = npkt;
+    cs->ref[cs->npkt++] = GETP32 (npkt, CMD_REFL);
+    tbc = tbc + nbc;
+    }
+sim_debug (DBG_REQ, rq_devmap[cp->cnum], "coalesced %d %s commands, lbn=%X, bc=%X\n",
+           cs->npkt, rq_cmdname[cmd & 0x3F], bl, tbc);
+if (cmd == OP_WR) {
+    sim_disk_data_trace(uptr, (uint8 *)cs->xb, bl, tbc, "sim_disk_wrsect-WR", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
+    sim_disk_wrsect_a (uptr, bl, (uint8 *)cs->xb, NULL, tbc / RQ_NUMBY, rq_io_complete);
+    }
+else sim_disk_rdsect_a (uptr, bl, (uint8 *)cs->xb, NULL, tbc / RQ_NUMBY, rq_io_complete);
+return TRUE;
+}
+
+/* Check whether queued command npkt can extend a coalesced transfer ending at lbn */
+
+t_bool rq_coalesce_ok (MSC *cp, UNIT *uptr, uint16 pkt, uint16 npkt, uint32 lbn)
+{
+uint32 nbc;
+
+if ((npkt == 0) ||
+    (GETP (npkt, CMD_OPC, OPC) != GETP (pkt, CMD_OPC, OPC)) ||
+    (cp->pak[npkt].d[CMD_MOD] != cp->pak[pkt].d[CMD_MOD]) ||
+    (GETP32 (npkt, RW_LBNL) != lbn))
+    return FALSE;
+nbc = GETP32 (npkt, RW_BCL);
+if ((nbc == 0) || (nbc > RQ_MAXFR) || (nbc & (RQ_NUMBY - 1)) ||
+    ((lbn + (nbc / RQ_NUMBY)) > (uint32)uptr->capac))   /* into RCT? */
+    return FALSE;
+return (rq_rw_valid (cp, npkt, uptr, GETP (npkt, CMD_OPC, OPC)) == 0);
+}
+
+/* Coalesced transfer complete - retire the merged commands in order */
+
+t_stat rq_coalesce_end (MSC *cp, UNIT *uptr, uint32 cmd)
+{
+RQ_COAL *cs = (RQ_COAL *) uptr->rqcs;
+uint32 i, t, ba, bc, off;
+uint16 pkt;
+
+for (i = off = 0; i < cs->npkt; i++, off = off + bc) {
+    pkt = cs->pkt[i];
+    if (i) {                                            /* merged cmd? */
+        if ((uptr->pktq != pkt) ||                      /* aborted, or packet */
+            (GETP32 (pkt, CMD_REFL) != cs->ref[i]) ||   /* reused by a new cmd? */
+            (GETP32 (pkt, RW_LBNL) != (cs->lbn + (off / RQ_NUMBY))))
+            break;                                      /* rest redone */
+        rq_deqh (cp, &uptr->pktq);                      /* now current */
+        uptr->cpkt = pkt;
+        rq_rw_setw (cp, pkt);
+        }
+    ba = GETP32 (pkt, RW_WBAL);
+    bc = GETP32 (pkt, RW_WBCL);
+    if (cmd == OP_RD) {
+        sim_disk_data_trace(uptr, (uint8 *)(cs->xb + (off >> 1)), GETP32 (pkt, RW_WBLL), bc, "sim_disk_rdsect", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
+        if ((t = rq_writew (ba, bc, GETP32 (pkt, RW_WMPL), cs->xb + (off >> 1)))) {/* store, nxm? */
+            PUTP32 (pkt, RW_WBCL, t);                   /* adj bc */
+            PUTP32 (pkt, RW_WBAL, ba + (bc - t));       /* adj ba */
+            if (!rq_hbe (cp, uptr) ||                   /* post err log */
+                !rq_rw_end (cp, uptr, EF_LOG, ST_HST | SB_HST_NXM))
+                break;
+            continue;
+            }
+        }
+    PUTP32 (pkt, RW_WBAL, ba + bc);                     /* update pkt */
+    PUTP32 (pkt, RW_WBCL, 0);
+    PUTP32 (pkt, RW_WBLL, GETP32 (pkt, RW_WBLL) + (bc / RQ_NUMBY));
+    if (!rq_rw_end (cp, uptr, 0, ST_SUC))               /* done! */
+        break;
+    }
+cs->npkt = 0;
+return SCPE_OK;
+}
+
 /* Transfer command complete */
 
 t_bool rq_rw_end (MSC *cp, UNIT *uptr, uint16 flg, uint16 sts)
@@ -2604,6 +2775,7 @@ DEVICE *dptr = rq_devmap[uptr->cnum];
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_rw_end\n");
 
 uptr->cpkt = 0;                                         /* done */
+cp->xfr_cmds++;                                         /* count xfer cmd */
 PUTP32 (pkt, RW_BCL, bc - wbc);                         /* bytes processed */
 cp->pak[pkt].d[RW_WBAL] = 0;                            /* clear temps */
 cp->pak[pkt].d[RW_WBAH] = 0;
@@ -3224,6 +3396,31 @@ fprintf (st, "%s", ctlr_tab[cp->ctype].name);
 return SCPE_OK;
 }
 
+/* Set transfer coalescing */
+
+t_stat rq_set_coalesce (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+MSC *cp = rq_ctxmap[uptr->cnum];
+
+if (cptr)
+    return SCPE_ARG;
+cp->coalesce = val;
+cp->xfr_cmds = cp->xfr_hio = 0;                         /* restart statistics */
+return SCPE_OK;
+}
+
+/* Show transfer coalescing */
+
+t_stat rq_show_coalesce (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+MSC *cp = rq_ctxmap[uptr->cnum];
+
+fprintf (st, "%scoalesce", cp->coalesce ? "" : "no");
+if (cp->xfr_cmds)
+    fprintf (st, " (%u transfers in %u host I/Os)", cp->xfr_cmds, cp->xfr_hio);
+return SCPE_OK;
+}
+
 /* Device attach */
 
 t_stat rq_attach (UNIT *uptr, CONST char *cptr)
@@ -3257,6 +3454,8 @@ if (r != SCPE_OK)
     return r;
 uptr->flags = uptr->flags & ~(UNIT_ONL | UNIT_ATP);     /* clr onl, atn pend */
 uptr->uf = 0;                                           /* clr unit flgs */
+free (uptr->rqcs);                                      /* free coalesce state */
+uptr->rqcs = NULL;
 return SCPE_OK;
 } 
 
@@ -3356,6 +3555,8 @@ for (i = 0; i < dptr->numunits; i++) {                  /* init units */
     uptr->flags = uptr->flags & ~(UNIT_ONL | UNIT_ATP);
     uptr->uf = 0;                                       /* clr unit flags */
     uptr->cpkt = uptr->pktq = 0;                        /* clr pkt q's */
+    free (uptr->rqcs);                                  /* free coalesce state */
+    uptr->rqcs = NULL;
     uptr->rqxb = (uint16 *) realloc (uptr->rqxb, (RQ_MAXFR >> 1) * sizeof (uint16));
     if (uptr->rqxb == NULL)
         return SCPE_MEM;
@@ -3623,6 +3824,12 @@ fprint_reg_help (st, dptr);
 fprintf (st, "\nWhile VMS is not timing sensitive, most of the BSD-derived operating systems\n");
 fprintf (st, "(NetBSD, OpenBSD, etc) are.  The QTIME and XTIME parameters are set to values\n");
 fprintf (st, "that allow these operating systems to run correctly.\n\n");
+fprintf (st, "SET %s COALESCE lets the controller merge read or write commands which\n", dptr->name);
+fprintf (st, "are queued behind the active one on the same drive and continue it at the\n");
+fprintf (st, "next LBN into a single host I/O of up to %dKB.  The end packets are still\n", RQ_MAXCFR >> 10);
+fprintf (st, "returned one per command and in order.  SHOW %s COALESCE displays the number\n", dptr->name);
+fprintf (st, "of transfer commands completed and host I/Os issued since coalescing was last\n");
+fprintf (st, "set, which allows the two modes to be compared on a given workload.\n\n");
 fprintf (st, "\nError handling is as follows:\n\n");
 fprintf (st, "    error         processed as\n");
 fprintf (st, "    not attached  disk not ready\n");
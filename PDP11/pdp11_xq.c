@@ -276,6 +276,8 @@ t_stat xq_show_sanity (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
 t_stat xq_set_sanity (UNIT* uptr, int32 val, CONST char* cptr, void* desc);
 t_stat xq_show_throttle (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
 t_stat xq_set_throttle (UNIT* uptr, int32 val, CONST char* cptr, void* desc);
+t_stat xq_show_txcoalesce (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
+t_stat xq_set_txcoalesce (UNIT* uptr, int32 val, CONST char* cptr, void* desc);
 t_stat xq_show_lockmode (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
 t_stat xq_set_lockmode (UNIT* uptr, int32 val, CONST char* cptr, void* desc);
 t_stat xq_show_poll (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
@@ -319,6 +321,7 @@ struct xq_device    xqa = {
   ETH_THROT_DEFAULT_TIME,                   /* ms throttle window */
   ETH_THROT_DEFAULT_BURST,                  /* packet packet burst in throttle window */
   ETH_THROT_DISABLED_DELAY,                 /* throttle disabled */
+  ETH_COALESCE_DEFAULT,                     /* frames coalesced per transmit burst */
   XQ_STARTUP_DELAY                          /* instructions to delay when starting the receiver */
   };
 
@@ -335,6 +338,7 @@ struct xq_device    xqb = {
   ETH_THROT_DEFAULT_TIME,                   /* ms throttle window */
   ETH_THROT_DEFAULT_BURST,                  /* packet packet burst in throttle window */
   ETH_THROT_DISABLED_DELAY,                 /* throttle disabled */
+  ETH_COALESCE_DEFAULT,                     /* frames coalesced per transmit burst */
   XQ_STARTUP_DELAY                          /* instructions to delay when starting the receiver */
   };
 
@@ -420,6 +424,7 @@ REG xqa_reg[] = {
   { GRDATA ( THR_TIME, xqa.throttle_time, XQ_RDX, 32, 0), REG_HRO},
   { GRDATA ( THR_BURST, xqa.throttle_burst, XQ_RDX, 32, 0), REG_HRO},
   { GRDATA ( THR_DELAY, xqa.throttle_delay, XQ_RDX, 32, 0), REG_HRO},
+  { GRDATA ( TX_COALESCE, xqa.tx_coalesce, XQ_RDX, 32, 0), REG_HRO},
   { GRDATAD ( START_DELAY, xqa.startup_delay,  XQ_RDX, 32, 0, "instruction delay before receiver starts"), REG_FIT },
   { NULL },
 };
@@ -484,6 +489,7 @@ REG xqb_reg[] = {
   { GRDATA ( THR_TIME, xqb.throttle_time, XQ_RDX, 32, 0), REG_HRO},
   { GRDATA ( THR_BURST, xqb.throttle_burst, XQ_RDX, 32, 0), REG_HRO},
   { GRDATA ( THR_DELAY, xqb.throttle_delay, XQ_RDX, 32, 0), REG_HRO},
+  { GRDATA ( TX_COALESCE, xqb.tx_coalesce, XQ_RDX, 32, 0), REG_HRO},
   { GRDATAD ( START_DELAY, xqb.startup_delay,  XQ_RDX, 32, 0, "instruction delay before receiver starts"), REG_FIT },
   { NULL },
 };
@@ -514,6 +520,8 @@ MTAB xq_mod[] = {
     &xq_set_sanity, &xq_show_sanity, NULL, "Sanity timer" },
   { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "THROTTLE", "THROTTLE=DISABLED|TIME=n{;BURST=n{;DELAY=n}}",
     &xq_set_throttle, &xq_show_throttle, NULL, "Display transmit throttle configuration" },
+  { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "TXCOALESCE", "TXCOALESCE={DISABLED|2..256}",
+    &xq_set_txcoalesce, &xq_show_txcoalesce, NULL, "Display transmit coalescing configuration" },
   { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "DEQNALOCK", "DEQNALOCK={ON|OFF}",
     &xq_set_lockmode, &xq_show_lockmode, NULL, "DEQNA-Lock mode" },
   { MTAB_XTD|MTAB_VDV,           0, "LEDS", NULL,
@@ -952,6 +960,41 @@ t_stat xq_set_throttle (UNIT* uptr, int32 val, CONST char* cptr, void* desc)
   return SCPE_OK;
 }
 
+t_stat xq_show_txcoalesce (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
+{
+  CTLR* xq = xq_unit2ctlr(uptr);
+
+  if (xq->var->tx_coalesce == 0)
+    fprintf(st, "txcoalesce=disabled");
+  else
+    fprintf(st, "txcoalesce=%d", xq->var->tx_coalesce);
+  return SCPE_OK;
+}
+
+t_stat xq_set_txcoalesce (UNIT* uptr, int32 val, CONST char* cptr, void* desc)
+{
+  CTLR* xq = xq_unit2ctlr(uptr);
+  uint32 newval;
+  t_stat r;
+
+  /* this assumes that the parameter has already been upcased */
+  if (!cptr)
+    newval = ETH_COALESCE_DEFAULT;
+  else
+    if ((!strcmp (cptr, "OFF")) ||
+        (!strcmp (cptr, "DISABLED")))
+      newval = 0;
+    else {
+      newval = (uint32)get_uint (cptr, 10, ETH_COALESCE_MAX, &r);
+      if ((r != SCPE_OK) || (newval == 1))
+        return SCPE_ARG;
+      }
+  xq->var->tx_coalesce = newval;
+  if (xq->var->etherface)
+    eth_set_coalesce (xq->var->etherface, xq->var->tx_coalesce);
+  return SCPE_OK;
+}
+
 t_stat xq_show_lockmode (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
 {
   CTLR* xq = xq_unit2ctlr(uptr);
@@ -1721,8 +1764,10 @@ t_stat xq_dispatch_xbdl(CTLR* xq)
   /* When debugging, walk and display the buffer descriptor list */
   xq_show_debug_bdl(xq, xq->var->xbdl_ba);
 
-  /* process xbdl */
+  /* process xbdl, sending its frames as one burst */
+  eth_write_hold(xq->var->etherface);
   status = xq_process_xbdl(xq);
+  eth_write_release(xq->var->etherface);
 
   return status;
 }
@@ -2894,6 +2939,7 @@ t_stat xq_attach(UNIT* uptr, CONST char* cptr)
     return status;
   }
   eth_set_throttle (xq->var->etherface, xq->var->throttle_time, xq->var->throttle_burst, xq->var->throttle_delay);
+  eth_set_coalesce (xq->var->etherface, xq->var->tx_coalesce);
   if (xq->var->poll == 0) {
     status = eth_set_async(xq->var->etherface, xq->var->coalesce_latency_ticks);
     if (status != SCPE_OK) {
@@ -3294,6 +3340,19 @@ const char helpString[] =
     " the TIME gap that will cause a delay in sending subsequent packets.\n"
     " DELAY specifies the number of milliseconds which a throttled packet will\n"
     " be delayed prior to its transmission.\n"
+    "\n"
+     /****************************************************************************/
+    "3 TXCOALESCE\n"
+    " When the simulated system hands the device a list of several packets to\n"
+    " transmit, they are passed to the host's network as a single burst rather\n"
+    " than one at a time, which considerably reduces the host overhead of bulk\n"
+    " transfers.  Up to n packets are held before being passed on:\n"
+    "\n"
+    "+sim> SET XQ TXCOALESCE=n\n"
+    "+sim> SET XQ TXCOALESCE=DISABLED\n"
+    "\n"
+    " The default is 8.  Packets are never held beyond the end of the list\n"
+    " the simulated system presented.\n"
     "\n"
      /****************************************************************************/
     "2 Attach\n"
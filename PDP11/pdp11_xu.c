@@ -117,6 +117,8 @@ t_stat xu_show_type (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
 t_stat xu_set_type (UNIT* uptr, int32 val, CONST char* cptr, void* desc);
 t_stat xu_show_throttle (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
 t_stat xu_set_throttle (UNIT* uptr, int32 val, CONST char* cptr, void* desc);
+t_stat xu_show_txcoalesce (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
+t_stat xu_set_txcoalesce (UNIT* uptr, int32 val, CONST char* cptr, void* desc);
 int32 xu_int (void);
 t_stat xu_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw);
 t_stat xu_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw);
@@ -150,7 +152,8 @@ struct xu_device    xua = {
   XU_T_DELUA,                               /* type */
   ETH_THROT_DEFAULT_TIME,                   /* ms throttle window */
   ETH_THROT_DEFAULT_BURST,                  /* packet packet burst in throttle window */
-  ETH_THROT_DISABLED_DELAY                  /* throttle disabled */
+  ETH_THROT_DISABLED_DELAY,                 /* throttle disabled */
+  ETH_COALESCE_DEFAULT                      /* frames coalesced per transmit burst */
   };
 
 MTAB xu_mod[] = {
@@ -179,6 +182,8 @@ MTAB xu_mod[] = {
     &xu_set_type, &xu_show_type, NULL, "Display the controller type" },
   { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "THROTTLE", "THROTTLE=DISABLED|TIME=n{;BURST=n{;DELAY=n}}",
     &xu_set_throttle, &xu_show_throttle, NULL, "Display transmit throttle configuration" },
+  { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "TXCOALESCE", "TXCOALESCE={DISABLED|2..256}",
+    &xu_set_txcoalesce, &xu_show_txcoalesce, NULL, "Display transmit coalescing configuration" },
   { 0 },
 };
 
@@ -218,6 +223,7 @@ REG xua_reg[] = {
   { GRDATA ( THR_TIME, xua.throttle_time, XU_RDX, 32, 0), REG_HRO},
   { GRDATA ( THR_BURST, xua.throttle_burst, XU_RDX, 32, 0), REG_HRO},
   { GRDATA ( THR_DELAY, xua.throttle_delay, XU_RDX, 32, 0), REG_HRO},
+  { GRDATA ( TX_COALESCE, xua.tx_coalesce, XU_RDX, 32, 0), REG_HRO},
   { NULL }  };
 
 DEBTAB xu_debug[] = {
@@ -256,7 +262,8 @@ struct xu_device    xub = {
   XU_T_DELUA,                               /* type */
   ETH_THROT_DEFAULT_TIME,                   /* ms throttle window */
   ETH_THROT_DEFAULT_BURST,                  /* packet packet burst in throttle window */
-  ETH_THROT_DISABLED_DELAY                  /* throttle disabled */
+  ETH_THROT_DISABLED_DELAY,                 /* throttle disabled */
+  ETH_COALESCE_DEFAULT                      /* frames coalesced per transmit burst */
   };
 
 REG xub_reg[] = {
@@ -295,6 +302,7 @@ REG xub_reg[] = {
   { GRDATA ( THR_TIME, xub.throttle_time, XU_RDX, 32, 0), REG_HRO},
   { GRDATA ( THR_BURST, xub.throttle_burst, XU_RDX, 32, 0), REG_HRO},
   { GRDATA ( THR_DELAY, xub.throttle_delay, XU_RDX, 32, 0), REG_HRO},
+  { GRDATA ( TX_COALESCE, xub.tx_coalesce, XU_RDX, 32, 0), REG_HRO},
   { NULL }  };
 
 DEVICE xub_dev = {
@@ -528,6 +536,41 @@ t_stat xu_set_throttle (UNIT* uptr, int32 val, CONST char* cptr, void* desc)
   return SCPE_OK;
 }
 
+t_stat xu_show_txcoalesce (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
+{
+  CTLR* xu = xu_unit2ctlr(uptr);
+
+  if (xu->var->tx_coalesce == 0)
+    fprintf(st, "txcoalesce=disabled");
+  else
+    fprintf(st, "txcoalesce=%d", xu->var->tx_coalesce);
+  return SCPE_OK;
+}
+
+t_stat xu_set_txcoalesce (UNIT* uptr, int32 val, CONST char* cptr, void* desc)
+{
+  CTLR* xu = xu_unit2ctlr(uptr);
+  uint32 newval;
+  t_stat r;
+
+  /* this assumes that the parameter has already been upcased */
+  if (!cptr)
+    newval = ETH_COALESCE_DEFAULT;
+  else
+    if ((!strcmp (cptr, "OFF")) ||
+        (!strcmp (cptr, "DISABLED")))
+      newval = 0;
+    else {
+      newval = (uint32)get_uint (cptr, 10, ETH_COALESCE_MAX, &r);
+      if ((r != SCPE_OK) || (newval == 1))
+        return SCPE_ARG;
+      }
+  xu->var->tx_coalesce = newval;
+  if (xu->var->etherface)
+    eth_set_coalesce (xu->var->etherface, xu->var->tx_coalesce);
+  return SCPE_OK;
+}
+
 /*============================================================================*/
 
 void upd_stat16(uint16* stat, uint16 add)
@@ -1551,7 +1594,9 @@ void xu_port_command (CTLR* xu)
   switch (command) {  /* cases in order of most used to least used */
     case CMD_PDMD:          /* POLLING DEMAND */
       /* process transmit buffers, receive buffers are done in the service timer */
+      eth_write_hold(xu->var->etherface);
       xu_process_transmit(xu);
+      eth_write_release(xu->var->etherface);
       xu->var->pcsr0 |= PCSR0_DNI;
       break;
 
@@ -1774,6 +1819,7 @@ t_stat xu_attach(UNIT* uptr, CONST char* cptr)
     return status;
   }
   eth_set_throttle (xu->var->etherface, xu->var->throttle_time, xu->var->throttle_burst, xu->var->throttle_delay);
+  eth_set_coalesce (xu->var->etherface, xu->var->tx_coalesce);
   if (SCPE_OK != eth_check_address_conflict (xu->var->etherface, xu->var->mac)) {
     eth_close(xu->var->etherface);
     free(tptr);
@@ -2000,6 +2046,20 @@ const char helpString[] =
     " the TIME gap that will cause a delay in sending subsequent packets.\n"
     " DELAY specifies the number of milliseconds which a throttled packet will\n"
     " be delayed prior to its transmission.\n"
+    "\n"
+     /****************************************************************************/
+    "3 TXCOALESCE\n"
+    " When the simulated system hands the device several transmit ring\n"
+    " buffers at once, their packets are passed to the host's network as a\n"
+    " single burst rather than one at a time, which considerably reduces the\n"
+    " host overhead of bulk transfers.  Up to n packets are held before being\n"
+    " passed on:\n"
+    "\n"
+    "+sim> SET XU TXCOALESCE=n\n"
+    "+sim> SET XU TXCOALESCE=DISABLED\n"
+    "\n"
+    " The default is 8.  Packets are never held beyond the end of the\n"
+    " transmit ring entries the simulated system presented.\n"
     "\n"
      /****************************************************************************/
     "2 Attach\n"
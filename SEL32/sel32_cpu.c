@@ -131,6 +131,9 @@ t_stat cpu_set_size(UNIT * uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_set_ipu(UNIT * uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_clr_ipu(UNIT * uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_ipu(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+#ifdef USE_IPU_THREAD
+t_stat cpu_show_ipc(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+#endif
 #endif
 t_stat cpu_show_hist(FILE * st, UNIT * uptr, int32 val, CONST void *desc);
 t_stat cpu_set_hist(UNIT * uptr, int32 val, CONST char *cptr, void *desc);
@@ -311,6 +314,10 @@ MTAB cpu_mod[] = {
 #ifdef DEFINE_IPU_MODELS
     {MTAB_XTD|MTAB_VDV, 0, "IPU", "USEIPU", &cpu_set_ipu, &cpu_show_ipu},
     {MTAB_XTD|MTAB_VDV, 0, "NULL", "NOIPU", &cpu_clr_ipu, NULL},
+#ifdef USE_IPU_THREAD
+    {MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "IPC", NULL, NULL, &cpu_show_ipc, NULL,
+        "Display CPU/IPU SIPU queue counters"},
+#endif
 #endif
     {0}
 };
@@ -561,6 +568,104 @@ LOCAL void unlock_mutex()
         pthread_mutex_unlock((pthread_mutex_t *)&(IPC->mutex));
     }
 }
+
+/* SIPU traps to [idx] go through a single producer/single consumer */
+/* queue.  Only the peer advances qhead and only [idx] advances qtail, */
+/* so the atomic adds are just there to order the entry with the index */
+
+/* usec time stamp for the SIPU latency counters, from the monotonic */
+/* clock where the host has one so clock adjustments don't skew the */
+/* latencies.  The Windows clock_gettime in sim_timer.h is realtime only */
+LOCAL uint32 ipc_usec()
+{
+    struct timespec now;
+
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#else
+    clock_gettime(CLOCK_REALTIME, &now);
+#endif
+    return (uint32)(now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+/* queue a trap for [idx], return 0 if the queue is full */
+int ipc_send_trap(int idx, int32 trap)
+{
+    int32   head = IPC->qhead[idx];
+
+    if ((uint32)head - (uint32)sim_shmem_atomic_add(&IPC->qtail[idx], 0) >= IPC_QSIZE)
+        return 0;                                   /* queue is full */
+    IPC->qtrap[idx][head & (IPC_QSIZE-1)] = trap;
+    IPC->qtime[idx][head & (IPC_QSIZE-1)] = ipc_usec();
+    sim_shmem_atomic_add(&IPC->qhead[idx], 1);      /* publish the entry */
+    sim_shmem_atomic_add(&IPC->wake[idx], 1);       /* change the futex word */
+    if (sim_shmem_atomic_add(&IPC->parked[idx], 0)) {
+        /* [idx] is waiting for a SIPU, wake it up */
+        IPC->wakeups[idx]++;
+#if defined(__linux__)
+        syscall(SYS_futex, &IPC->wake[idx], FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+        pthread_mutex_lock(&IPC->mutex);
+        pthread_cond_broadcast(&IPC->cond);
+        pthread_mutex_unlock(&IPC->mutex);
+#endif
+    }
+    return 1;
+}
+
+/* see if a trap is queued for [idx] */
+int ipc_trap_pending(int idx)
+{
+    return sim_shmem_atomic_add(&IPC->qhead[idx], 0) != IPC->qtail[idx];
+}
+
+/* take the next trap queued for [idx], return 0 if none */
+int32 ipc_take_trap(int idx)
+{
+    int32   tail = IPC->qtail[idx];
+    int32   trap;
+    uint32  lat;
+
+    if (sim_shmem_atomic_add(&IPC->qhead[idx], 0) == tail)
+        return 0;                                   /* queue is empty */
+    trap = IPC->qtrap[idx][tail & (IPC_QSIZE-1)];
+    lat = ipc_usec() - IPC->qtime[idx][tail & (IPC_QSIZE-1)];
+    sim_shmem_atomic_add(&IPC->qtail[idx], 1);      /* free the entry */
+    IPC->lattot[idx] += lat;
+    if (lat > IPC->latmax[idx])
+        IPC->latmax[idx] = lat;
+    return trap;
+}
+
+/* park [idx] until a trap is queued for it */
+void ipc_wait_trap(int idx)
+{
+    int32   seq;
+
+    IPC->parks[idx]++;
+    while (!ipc_trap_pending(idx)) {
+        seq = sim_shmem_atomic_add(&IPC->wake[idx], 0);
+        sim_shmem_atomic_cas(&IPC->parked[idx], 0, 1);
+        if (ipc_trap_pending(idx))                  /* sent before we parked */
+            break;
+#if defined(__linux__)
+        syscall(SYS_futex, &IPC->wake[idx], FUTEX_WAIT_PRIVATE, seq, NULL, NULL, 0);
+#else
+        pthread_mutex_lock(&IPC->mutex);
+        while (sim_shmem_atomic_add(&IPC->wake[idx], 0) == seq)
+            pthread_cond_wait(&IPC->cond, &IPC->mutex);
+        pthread_mutex_unlock(&IPC->mutex);
+#endif
+    }
+    sim_shmem_atomic_cas(&IPC->parked[idx], 1, 0);
+}
+
+/* drop any traps queued for [idx] */
+void ipc_clear_traps(int idx)
+{
+    sim_shmem_atomic_cas(&IPC->qtail[idx], IPC->qtail[idx],
+        sim_shmem_atomic_add(&IPC->qhead[idx], 0));
+}
 #endif
 #endif /* CPUONLY */
 
@@ -2125,9 +2230,8 @@ loadend:
             /* process any pending sipu traps from the ipu here on cpu */
             /* interrupts must be unblocked to take the sipu trap */
             if (((CPUSTATUS & ONIPU) == 0) && IPC && ((CPUSTATUS & BIT24) == 0) &&
-                IPC->atrap[MyIndex]) {
-                TRAPME = IPC->atrap[MyIndex];
-                IPC->atrap[MyIndex] = 0;
+                ipc_trap_pending(MyIndex)) {
+                TRAPME = ipc_take_trap(MyIndex);
                 IPC->received[MyIndex]++;
                 sim_debug(DEBUG_TRAP, my_dev,
                     "%s: (%d) Async TRAP %02x Index %x PeerIndex %x rec'd %08x\n",
@@ -2145,15 +2249,12 @@ loadend:
             /* wait for sipu to start us on ipu */
             /* interrupts must be unblocked on IPU to receive SIPU */
             if ((CPUSTATUS & ONIPU) && ((CPUSTATUS & BIT24) == 0) && IPC &&
-                (IPC->atrap[MyIndex] != 0)) {
+                ipc_trap_pending(MyIndex)) {
                 /* we are unblocked, look for SIPU */
-                /* we have a trap available, lock and get it */
+                /* we have a trap available, take it from the queue */
 cond_go:
-                if (IPC && IPC->atrap[MyIndex]) {
-                    lock_mutex();                   /* lock mutex */
-                    TRAPME = IPC->atrap[MyIndex];   /* get trap number */
-                    IPC->atrap[MyIndex] = 0;        /* clear trap value location */
-                    unlock_mutex();                 /* unlock mutex */
+                if (IPC && ipc_trap_pending(MyIndex)) {
+                    TRAPME = ipc_take_trap(MyIndex);    /* get trap number */
                     IPC->received[MyIndex]++;       /* count it received */
                     wait4sipu = 0;                  /* wait is over for sipu */
                     sim_debug(DEBUG_TRAP, my_dev, "%s: (%d) Async TRAP %02x SPAD[0xf0] %02x rec'd %08x\n",
@@ -2165,12 +2266,9 @@ cond_go:
                     skipinstr = 1;                  /* skip interrupt test */
                     goto newpsd;                    /* go process trap */
                 }
-                /* unblocked and locked and no async trap */
+                /* unblocked and no async trap */
                 if (wait4sipu) {                    /* are we to wait */
-                    lock_mutex();                   /* lock mutex */
-                    while (IPC->atrap[MyIndex]==0)  /* sleep on the condition */
-                        pthread_cond_wait(&IPC->cond, &IPC->mutex); /* wait for wakeup */
-                    unlock_mutex();                 /* unlock mutex and continue */
+                    ipc_wait_trap(MyIndex);         /* park until a SIPU is queued */
                     goto cond_go;                   /* go process */
                 }
                 /* not waiting for sipu, so continue processing */
@@ -3059,20 +3157,19 @@ exec2:
                     else
                         IPC->dropped[MyIndex]++;
 #else
-                    if (IPC->atrap[PeerIndex]) {
-                        /* previous atrap not yet handled if not zero */
+                    int queued = ipc_send_trap(PeerIndex, SIGNALIPU_TRAP);
+
+                    if (!queued) {
+                        /* peer queue is full of unhandled traps */
                         IPC->blocked[MyIndex]++;    /* count as blocked */
                         sim_debug(DEBUG_TRAP, my_dev,
                             "%s: Async SIPU blocked IPUSTATUS %08x CCW %08x SPAD[0xf0] %02x block %08x\n",
                             (CPUSTATUS & ONIPU)? "IPU": "CPU", CPUSTATUS, CCW, SPAD[0xf0], IPC->blocked[MyIndex]);
                         //GR  Give it a millisec to unblock the atrap
                         sim_os_ms_sleep(10);        /* wait 10 ms */
+                        queued = ipc_send_trap(PeerIndex, SIGNALIPU_TRAP);
                     }
-                    if (IPC->atrap[PeerIndex] == 0) {
-                        lock_mutex();               /* lock mutex */
-                        IPC->atrap[PeerIndex] = SIGNALIPU_TRAP;
-                        pthread_cond_signal(&IPC->cond);    /* wake any waiters */
-                        unlock_mutex();             /* unlock mutex */
+                    if (queued) {
                         IPC->sent[MyIndex]++;
                         sim_debug(DEBUG_TRAP, my_dev,
                             "%s: Async SIPU sent IPUSTATUS %08x CCW %08x SPAD[0xf0] %02x sent %08x\n",
@@ -8071,6 +8168,29 @@ t_stat cpu_show_ipu(FILE *st, UNIT *uptr, int32 val, CONST void *desc)
         sim_printf("IPU disabled\n");
     return SCPE_OK;                                 /* we done */
 }
+
+#ifdef USE_IPU_THREAD
+/* Show the SIPU queue and lock counters for each side */
+t_stat cpu_show_ipc(FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+    int i;
+
+    if (IPC == 0)
+        return SCPE_OK;
+    for (i = 0; i < 2; i++) {
+        fprintf(st, "%s: sent %d received %d blocked %d dropped %d\n",
+            i ? "IPU" : "CPU", IPC->sent[i], IPC->received[i],
+            IPC->blocked[i], IPC->dropped[i]);
+        fprintf(st, "     parked %d woken %d latency avg %u max %u usec\n",
+            IPC->parks[i], IPC->wakeups[i],
+            IPC->received[i] ? (uint32)(IPC->lattot[i] / IPC->received[i]) : 0,
+            IPC->latmax[i]);
+        fprintf(st, "     SBM/ZBM lock passed %d waited %d\n",
+            IPC->pass[i], IPC->wait[i]);
+    }
+    return SCPE_OK;
+}
+#endif
 #endif
 
 /* Handle execute history */
@@ -99,6 +99,15 @@ struct ipcom {
 #else
 /* Use pthread mutexs */
 #include <pthread.h>
+#if defined(__linux__)
+/* park a waiting IPU/CPU on a futex instead of the condition */
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+/* SIPU queue entries, power of 2.  One, like the single pending atrap */
+/* the hardware holds, so a second SIPU waits 10 ms and is then dropped */
+#define IPC_QSIZE   1
 /* shared Interprocessor Com for SIPU [0] for CPU [1] for IPU */
 struct ipcom {
     int     pid[2];                     /* process id for each */
@@ -112,7 +121,23 @@ struct ipcom {
     pthread_cond_t  cond;               /* conditional wait condition */
     int     pass[2];                    /* count passing */
     int     wait[2];                    /* count waiting */
+    /* lock free SIPU queue to [n], filled by the peer, emptied by [n] */
+    int32   qhead[2];                   /* next entry the peer fills */
+    int32   qtail[2];                   /* next entry to be taken */
+    int32   qtrap[2][IPC_QSIZE];        /* queued trap numbers */
+    uint32  qtime[2][IPC_QSIZE];        /* usec time each trap was queued */
+    int32   wake[2];                    /* futex word, bumped on each send */
+    int32   parked[2];                  /* set while waiting for a SIPU */
+    int     parks[2];                   /* counting waits for a SIPU */
+    int     wakeups[2];                 /* counting wakeups of a parked peer */
+    uint32  latmax[2];                  /* longest queue to take time usec */
+    t_uint64 lattot[2];                 /* total queue to take time usec */
 };
+extern  int     ipc_send_trap(int idx, int32 trap);
+extern  int     ipc_trap_pending(int idx);
+extern  int32   ipc_take_trap(int idx);
+extern  void    ipc_wait_trap(int idx);
+extern  void    ipc_clear_traps(int idx);
 #endif
 #endif
 
@@ -1840,6 +1840,9 @@ reboot:                             /* cpu rebooting, so reinitialize ipu */
     PeerIndex = 0;
     IPC->pid[MyIndex] = 1;
     IPC->atrap[MyIndex] = 0;        /* clear trap value location */
+#ifndef USE_POSIX_SEM
+    ipc_clear_traps(MyIndex);       /* drop any queued SIPU traps */
+#endif
 
     /* we will be running with an ipu, set it up */
     /* clear I/O and interrupt entries in SPAD. */
@@ -1969,14 +1972,11 @@ cond_go:                                            /* merge point when waiting
         /* interrupts must be unblocked on IPU to receive SIPU */
         if ((IPUSTATUS & BIT24) == 0) {
 cond_ok:
-            if (IPC && (IPC->atrap[MyIndex] != 0)) {
+            if (IPC && ipc_trap_pending(MyIndex)) {
                 /* we are unblocked, look for SIPU */
-                /* we have a trap available, lock and get it */
-                if (IPC && IPC->atrap[MyIndex]) {
-                    lock_mutex();                   /* lock mutex */
-                    TRAPME = IPC->atrap[MyIndex];   /* get trap number */
-                    IPC->atrap[MyIndex] = 0;        /* clear trap value location */
-                    unlock_mutex();                 /* unlock mutex */
+                /* we have a trap available, take it from the queue */
+                if (IPC && ipc_trap_pending(MyIndex)) {
+                    TRAPME = ipc_take_trap(MyIndex);    /* get trap number */
                     IPC->received[MyIndex]++;       /* count it received */
                     wait4sipu = 0;                  /* wait is over for sipu */
                     sim_debug(DEBUG_TRAP, my_dev, "IPU: (%d) Async TRAP %02x SPAD[0xf0] %02x rec'd %08x\n",
@@ -1991,12 +1991,9 @@ cond_ok:
                     goto newpsd;                    /* go process trap */
                 }
             }
-            /* unblocked and locked and no async trap */
+            /* unblocked and no async trap */
             if (wait4sipu) {                        /* are we to wait */
-                lock_mutex();                       /* lock mutex */
-                while (IPC->atrap[MyIndex]==0)      /* sleep on the condition */
-                    pthread_cond_wait(&IPC->cond, &IPC->mutex); /* wait for wakeup */
-                unlock_mutex();                     /* unlock mutex and continue */
+                ipc_wait_trap(MyIndex);             /* park until a SIPU is queued */
                 goto cond_ok;                       /* continue waiting */
             }
             /* not waiting for sipu, so continue processing */
@@ -2720,20 +2717,19 @@ exec2:
                     else
                         IPC->dropped[MyIndex]++;
 #else
-                    if (IPC->atrap[PeerIndex]) {
-                        /* previous atrap not yet handled if not zero */
+                    int queued = ipc_send_trap(PeerIndex, SIGNALIPU_TRAP);
+
+                    if (!queued) {
+                        /* peer queue is full of unhandled traps */
                         IPC->blocked[MyIndex]++;    /* count as blocked */
                         sim_debug(DEBUG_TRAP, my_dev,
                             "%s: Async SIPU blocked IPUSTATUS %08x CCW %08x SPAD[0xf0] %02x block %08x\n",
                             (IPUSTATUS & ONIPU)? "IPU": "CPU", IPUSTATUS, CCW, SPAD[0xf0], IPC->blocked[MyIndex]);
                         //GR  Give it a millisec to unblock the atrap
                         sim_os_ms_sleep(10);        /* wait 10 ms */
+                        queued = ipc_send_trap(PeerIndex, SIGNALIPU_TRAP);
                     }
-                    if (IPC->atrap[PeerIndex] == 0) {
-                        lock_mutex();               /* lock mutex */
-                        IPC->atrap[PeerIndex] = SIGNALIPU_TRAP;
-                        pthread_cond_signal(&IPC->cond);    /* wake any waiters */
-                        unlock_mutex();             /* unlock mutex */
+                    if (queued) {
                         IPC->sent[MyIndex]++;
                         sim_debug(DEBUG_TRAP, my_dev,
                             "%s: Async SIPU sent IPUSTATUS %08x CCW %08x SPAD[0xf0] %02x sent %08x\n",
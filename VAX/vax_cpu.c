@@ -180,6 +180,25 @@
 
         vax_defs.h      add device address and interrupt definitions
         vax_sys.c       add sim_devices table entry
+
+   4. Decoded instruction cache.  The values fetched from the istream while
+      parsing an instruction (opcode, specifier bytes, literals,
+      displacements and branch displacement) are saved in a direct mapped
+      table indexed by the physical address of the opcode.  Leading
+      specifiers with the common modes (literal, immediate, register,
+      register deferred, displacement, absolute) are also predecoded into
+      their kind, length and extension.  When the same instruction is
+      executed again, the predecoded specifiers are evaluated directly and
+      GET_ISTR returns the saved values for the rest, instead of
+      extracting them from the prefetch buffer.  Only instructions which
+      are in memory, do not cross a page boundary and are not restarted
+      with PSL<fpd> set are cached.
+
+      Entries are invalidated by writes to memory (IC_WRCHK in the physical
+      write routines and the Qbus memory write paths), and the whole cache
+      is flushed on entry to sim_instr, so that SCP deposits, loads and
+      restores are seen.  The translation of the current PC page is
+      remembered separately and is forgotten on any TB invalidate.
 */
 
 /* Definitions */
@@ -233,6 +252,41 @@
                         r = arl; \
                         rh = arh
 
+#define IC_SIZE         4096                            /* icache entries */
+#define IC_MASK         (IC_SIZE - 1)
+#define IC_NVAL         12                              /* max istream values */
+#define IC_MAXLNT       32                              /* max inst length */
+
+#define IK_LIT          0                               /* literal, immediate */
+#define IK_RB           1                               /* register, byte */
+#define IK_RW           2                               /* register, word */
+#define IK_RL           3                               /* register, long */
+#define IK_WR           4                               /* register, write */
+#define IK_DPR          5                               /* (Rn), d(Rn), read */
+#define IK_DPM          6                               /* (Rn), d(Rn), modify */
+#define IK_DPW          7                               /* (Rn), d(Rn), write */
+#define IK_DPA          8                               /* (Rn), d(Rn), address */
+#define IK_ABR          9                               /* @#a, read */
+#define IK_ABM          10                              /* @#a, modify */
+#define IK_ABW          11                              /* @#a, write */
+#define IK_ABA          12                              /* @#a, address */
+#define IK_BR           13                              /* branch displacement */
+
+typedef struct {
+    uint8               kind;                           /* IK_xxx */
+    uint8               spec;                           /* specifier byte */
+    uint8               ilnt;                           /* istream bytes */
+    uint8               nval;                           /* istream values */
+    int32               olnt;                           /* operand length */
+    int32               arg;                            /* literal, disp, addr */
+    } ICSPEC;
+
+typedef struct {
+    uint32              pa;                             /* opcode phys addr */
+    int32               nfast;                          /* # predecoded specs */
+    int32               val[IC_NVAL];                   /* istream values */
+    ICSPEC              sp[MAX_SPEC + 1];               /* predecoded specs */
+    } ICENT;
 
 uint32 *M = NULL;                                       /* memory */
 int32 R[16];                                            /* registers */
@@ -267,6 +321,16 @@ int32 cpu_astop = 0;
 int32 mchk_va, mchk_ref;                                /* mem ref param */
 int32 ibufl, ibufh;                                     /* prefetch buf */
 int32 ibcnt, ppc;                                       /* prefetch ctl */
+ICENT ic_tab[IC_SIZE];                                  /* decoded inst cache */
+ICENT *ic_rec = NULL;                                   /* icache record entry */
+int32 ic_nrec;                                          /* values recorded */
+uint32 ic_pa;                                           /* phys addr of inst */
+uint32 ic_vpg = IC_INV;                                 /* PC virtual page */
+uint32 ic_ppg = IC_INV;                                 /* PC physical page */
+int32 ic_acc;                                           /* PC page access */
+int32 ic_enb = 1;                                       /* icache enabled */
+uint32 ic_lnmap[MAXMEMSIZE_X >> (IC_V_LN + 5)];         /* lines with cached inst */
+t_uint64 ic_hit, ic_miss, ic_zaps;                      /* icache statistics */
 uint32 cpu_idle_mask =                                  /* idle mask */
 #if defined (VAX_411) || defined (VAX_412)
                        VAX_IDLE_INFOSERVER;
@@ -330,6 +394,11 @@ t_stat cpu_show_instruction_set (FILE *st, UNIT *uptr, int32 val, CONST void *de
 const char *cpu_description (DEVICE *dptr);
 int32 cpu_get_vsw (int32 sw);
 static SIM_INLINE int32 get_istr (int32 lnt, int32 acc);
+static void ic_xlate (int32 acc);
+static void ic_commit (int32 opc);
+static void ic_flush (void);
+t_stat cpu_set_icache (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_icache (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 int32 ReadOcta (int32 va, int32 *opnd, int32 j, int32 acc);
 t_bool cpu_show_opnd (FILE *st, InstHistory *h, int32 line);
 t_stat cpu_show_hist_records (FILE *st, t_bool do_header, int32 start, int32 count);
@@ -437,6 +506,10 @@ MTAB cpu_mod[] = {
       &cpu_set_hist, &cpu_show_hist, NULL, "Enable/Display instruction history" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "VIRTUAL", NULL,
       NULL, &cpu_show_virt, NULL, "show translation for address arg in KESU mode" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 1, "ICACHE", "ICACHE",
+      &cpu_set_icache, &cpu_show_icache, NULL, "Enable/Display decoded instruction cache" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOICACHE",
+      &cpu_set_icache, NULL, NULL, "Disable decoded instruction cache" },
     CPU_MODEL_MODIFIERS  /* Model specific cpu modifiers from vaxXXX_defs.h */
     CPU_INST_MODIFIERS   /* Model specific cpu instruction modifiers from vaxXXX_defs.h */
     { 0 }
@@ -500,6 +573,9 @@ int32 spec = 0, disp = 0, rn = 0, index = 0, numspec = 0;
 int32 vfldrp1 = 0, brdisp = 0, flg = 0, mstat = 0;
 uint32 va = 0, iad = 0;
 int32 opnd[OPND_SIZE];                                  /* operand queue */
+ICENT *ice = NULL;                                      /* icache hit entry */
+int32 *icp = NULL;                                      /* icache replay ptr */
+int32 icnf = 0;                                         /* # predecoded specs */
 
 if ((ret = build_dib_tab ()) != SCPE_OK)                /* build, chk dib_tab */
     return ret;
@@ -516,6 +592,7 @@ set_map_reg ();                                         /* set map reg */
 GET_CUR;                                                /* set access mask */
 SET_IRQL;                                               /* eval interrupts */
 FLUSH_ISTR;                                             /* clear prefetch */
+ic_flush ();                                            /* clear icache */
 
 abortval = setjmp (save_env);                           /* set abort hdlr */
 if (abortval > 0) {                                     /* sim stop? */
@@ -728,6 +805,30 @@ for ( ;; ) {
 
     sim_interval = sim_interval - (1 + (extra_bytes>>5));/* count instr */
     extra_bytes = 0;                                    /* digest string count */
+    ice = NULL;                                         /* not replaying */
+    icp = NULL;
+    icnf = 0;
+    ic_rec = NULL;                                      /* not recording */
+    if (ic_enb && ((PSL & PSL_FPD) == 0)) {             /* icache usable? */
+        if ((((uint32) PC & ~VA_M_OFF) != ic_vpg) || (acc != ic_acc))
+            ic_xlate (acc);                             /* xlate PC page */
+        if (ic_ppg != IC_INV) {                         /* in memory? */
+            ic_pa = ic_ppg | VA_GETOFF (PC);
+            ice = &ic_tab[ic_pa & IC_MASK];
+            if (ice->pa == ic_pa) {                     /* hit? replay */
+                icp = ice->val;
+                icnf = ice->nfast;
+                ic_hit = ic_hit + 1;
+                }
+            else {                                      /* miss, record */
+                ic_rec = ice;
+                ic_rec->pa = IC_INV;
+                ic_nrec = 0;
+                ic_miss = ic_miss + 1;
+                ice = NULL;
+                }
+            }
+        }
     GET_ISTR (opc, L_BYTE);                             /* get opcode */
     if (opc == 0xFD) {                                  /* 2 byte op? */
         GET_ISTR (opc, L_BYTE);                         /* get second byte */
@@ -779,6 +880,74 @@ for ( ;; ) {
 */
 
         for (i = 1, j = 0; i <= numspec; i++) {         /* loop thru specs */
+            if (i <= icnf) {                            /* predecoded? */
+                ICSPEC *sp = &ice->sp[i];
+
+                PC = PC + sp->ilnt;                     /* skip istream */
+                icp = icp + sp->nval;
+                if (sp->kind == IK_BR) {                /* branch disp? */
+                    brdisp = sp->arg;                   /* spec, rn unchanged */
+                    break;
+                    }
+                spec = sp->spec;
+                rn = spec & RGMASK;
+                switch (sp->kind) {
+
+                case IK_LIT:
+                    opnd[j++] = sp->arg;
+                    continue;
+
+                case IK_RB:
+                    opnd[j++] = R[rn] & BMASK;
+                    continue;
+
+                case IK_RW:
+                    opnd[j++] = R[rn] & WMASK;
+                    continue;
+
+                case IK_RL:
+                    opnd[j++] = R[rn];
+                    continue;
+
+                case IK_WR:
+                    opnd[j++] = rn;
+                    opnd[j++] = R[rn];
+                    continue;
+
+                case IK_DPR:
+                    va = R[rn] + sp->arg;
+                    opnd[j++] = Read (va, sp->olnt, RA);
+                    continue;
+
+                case IK_DPM:
+                    va = R[rn] + sp->arg;
+                    opnd[j++] = Read (va, sp->olnt, WA);
+                    continue;
+
+                case IK_DPW:
+                    opnd[j++] = OP_MEM;
+                case IK_DPA:
+                    va = opnd[j++] = R[rn] + sp->arg;
+                    continue;
+
+                case IK_ABR:
+                    va = sp->arg;
+                    opnd[j++] = Read (va, sp->olnt, RA);
+                    continue;
+
+                case IK_ABM:
+                    va = sp->arg;
+                    opnd[j++] = Read (va, sp->olnt, WA);
+                    continue;
+
+                case IK_ABW:
+                    opnd[j++] = OP_MEM;
+                case IK_ABA:
+                default:
+                    va = opnd[j++] = sp->arg;
+                    continue;
+                    }
+                }
             disp = drom[opc][i];                        /* get dispatch */
             if (disp >= BB) {
                 GET_ISTR (brdisp, DR_LNT (disp & 1));
@@ -1557,6 +1726,10 @@ for ( ;; ) {
                 }                                       /* end case spec */
             }                                           /* end for */
         }                                               /* end if not FPD */
+    if (icp)                                            /* replayed? */
+        FLUSH_ISTR;                                     /* prefetch is stale */
+    else if (ic_rec)                                    /* recorded? */
+        ic_commit (opc);
 
 /* Optionally record instruction history */
 
@@ -3229,9 +3402,164 @@ if ((bo + lnt) >= 4) {                                  /* retire ibufl? */
     ibufl = ibufh;
     ibcnt = ibcnt - 4;
     }
+if (ic_rec) {                                           /* recording? */
+    if (ic_nrec < IC_NVAL)
+        ic_rec->val[ic_nrec++] = val;
+    else ic_rec = NULL;                                 /* too long, give up */
+    }
 return val;
 }
 
+/* Decoded instruction cache routines
+
+   ic_xlate     translate the PC page for the icache lookup; pages which
+                are not in memory are remembered as uncacheable, pages
+                which do not translate are not remembered at all
+   ic_commit    validate the entry just recorded, if the instruction
+                qualifies, and mark its lines in the line map; the
+                leading specifiers with simple modes are predecoded
+   ic_zap       invalidate cached instructions overlapping a memory line
+                which is being written
+   ic_flush     invalidate the whole cache
+*/
+
+static void ic_xlate (int32 acc)
+{
+int32 pa, t;
+
+pa = Test ((uint32) PC & ~VA_M_OFF, RA, &t);            /* xlate, no fault */
+if (pa < 0) {                                           /* fails? */
+    ic_vpg = ic_ppg = IC_INV;                           /* retry next time */
+    return;
+    }
+ic_vpg = (uint32) PC & ~VA_M_OFF;
+ic_acc = acc;
+ic_ppg = ADDR_IS_MEM (pa)? (uint32) pa: IC_INV;
+}
+
+static void ic_commit (int32 opc)
+{
+int32 lnt = PC - fault_PC;
+int32 i, k, numspec, disp, spec, mode, rn, acs;
+ICSPEC *sp;
+uint32 ln;
+
+if ((lnt <= 0) || (lnt > IC_MAXLNT) ||                  /* too long, */
+    ((((uint32) fault_PC ^ (uint32) (PC - 1)) & ~VA_M_OFF) != 0) || /* xpg, */
+    !ADDR_IS_MEM (ic_pa + lnt - 1)) {                   /* not memory? */
+    ic_rec = NULL;
+    return;
+    }
+numspec = drom[opc][0] & DR_NSPMASK;
+k = (opc > 0xFF)? 2: 1;                                 /* skip opcode */
+for (i = 1; i <= numspec; i++) {                        /* predecode specs */
+    sp = &ic_rec->sp[i];
+    disp = drom[opc][i];
+    if (disp >= BB) {                                   /* branch disp */
+        sp->kind = IK_BR;
+        sp->spec = 0;
+        sp->ilnt = (uint8) DR_LNT (disp & 1);
+        sp->nval = 1;
+        sp->arg = ic_rec->val[k];
+        continue;
+        }
+    spec = ic_rec->val[k];
+    mode = spec & ~RGMASK;
+    rn = spec & RGMASK;
+    acs = disp & (DR_ACMASK|DR_SPFLAG|DR_LNMASK);       /* access+lnt */
+    sp->spec = (uint8) spec;
+    sp->olnt = DR_LNT (disp);
+    sp->ilnt = sp->nval = 1;
+    sp->arg = 0;
+    if (mode <= SH3) {                                  /* short literal */
+        if ((acs != RB) && (acs != RW) && (acs != RL))
+            break;
+        sp->kind = IK_LIT;
+        sp->arg = spec;
+        }
+    else if (mode == GRN) {                             /* register */
+        if ((acs == RB) || (acs == MB))
+            sp->kind = IK_RB;
+        else if ((acs == RW) || (acs == MW))
+            sp->kind = IK_RW;
+        else if ((acs == RL) || (acs == RF) || (acs == ML))
+            sp->kind = IK_RL;
+        else if ((acs == WB) || (acs == WW) || (acs == WL))
+            sp->kind = IK_WR;
+        else break;
+        }
+    else if ((mode == AIN) && (rn == nPC)) {            /* immediate */
+        if ((acs != RB) && (acs != RW) && (acs != RL) && (acs != RF))
+            break;
+        sp->kind = IK_LIT;
+        sp->ilnt = (uint8) (1 + DR_LNT (disp));
+        sp->nval = 2;
+        sp->arg = ic_rec->val[k + 1];
+        }
+    else if ((mode == RGD) || (mode == BDP) ||          /* (Rn), d(Rn) */
+        (mode == WDP) || (mode == LDP) ||
+        ((mode == AID) && (rn == nPC))) {               /* @#a */
+        int32 base = (mode == AID)? IK_ABR: IK_DPR;
+
+        if ((acs == RB) || (acs == RW) || (acs == RL) || (acs == RF))
+            sp->kind = (uint8) base;
+        else if ((acs == MB) || (acs == MW) || (acs == ML))
+            sp->kind = (uint8) (base + (IK_DPM - IK_DPR));
+        else if ((acs == WB) || (acs == WW) || (acs == WL))
+            sp->kind = (uint8) (base + (IK_DPW - IK_DPR));
+        else if ((acs & ~DR_LNMASK) == (AB & ~DR_LNMASK))
+            sp->kind = (uint8) (base + (IK_DPA - IK_DPR));
+        else break;
+        if (mode != RGD) {                              /* extension */
+            sp->nval = 2;
+            sp->arg = ic_rec->val[k + 1];
+            if (mode == BDP) {
+                sp->ilnt = 2;
+                sp->arg = SXTB (sp->arg);
+                }
+            else if (mode == WDP) {
+                sp->ilnt = 3;
+                sp->arg = SXTW (sp->arg);
+                }
+            else sp->ilnt = 5;
+            }
+        }
+    else break;                                         /* general decode */
+    k = k + sp->nval;
+    }
+ic_rec->nfast = i - 1;
+for (ln = ic_pa >> IC_V_LN; ln <= ((ic_pa + lnt - 1) >> IC_V_LN); ln++)
+    ic_lnmap[ln >> 5] |= (1u << (ln & 0x1F));
+ic_rec->pa = ic_pa;                                     /* entry valid */
+ic_rec = NULL;
+}
+
+void ic_zap (uint32 pa)
+{
+uint32 ln = pa >> IC_V_LN;
+uint32 hi = (ln + 1) << IC_V_LN;
+uint32 a = ln << IC_V_LN;
+
+ic_lnmap[ln >> 5] &= ~(1u << (ln & 0x1F));              /* line now clean */
+a = (a >= (IC_MAXLNT - 1))? a - (IC_MAXLNT - 1): 0;     /* incl insts running in */
+for ( ; a < hi; a++) {
+    if (ic_tab[a & IC_MASK].pa == a)
+        ic_tab[a & IC_MASK].pa = IC_INV;
+    }
+ic_zaps = ic_zaps + 1;
+}
+
+static void ic_flush (void)
+{
+uint32 i;
+
+for (i = 0; i < IC_SIZE; i++)
+    ic_tab[i].pa = IC_INV;
+memset (ic_lnmap, 0, (size_t) ((MEMSIZE >> IC_V_LN) + 7) >> 3);
+ic_vpg = ic_ppg = IC_INV;
+ic_rec = NULL;
+}
+
 /* Read octaword specifier */
 
 int32 ReadOcta (int32 va, int32 *opnd, int32 j, int32 acc)
@@ -3318,6 +3646,31 @@ static const char *vax_clock_precalibrate_commands[] = {
     "PC 100",
     NULL};
 
+/* Set/show decoded instruction cache */
+
+t_stat cpu_set_icache (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (cptr)
+    return SCPE_ARG;
+ic_enb = val;
+ic_flush ();
+ic_hit = ic_miss = ic_zaps = 0;
+return SCPE_OK;
+}
+
+t_stat cpu_show_icache (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+t_uint64 tot = ic_hit + ic_miss;
+
+fprintf (st, "icache %s, %d entries\n", ic_enb? "enabled": "disabled", IC_SIZE);
+fprintf (st, "hits:          %" T_UINT64_FMT "u\n", ic_hit);
+fprintf (st, "misses:        %" T_UINT64_FMT "u\n", ic_miss);
+if (tot)
+    fprintf (st, "hit rate:      %.2f%%\n", (100.0 * ic_hit) / tot);
+fprintf (st, "invalidations: %" T_UINT64_FMT "u\n", ic_zaps);
+return SCPE_OK;
+}
+
 /* Reset */
 
 t_stat cpu_reset (DEVICE *dptr)
@@ -3994,6 +4347,12 @@ fprintf (st, "functionality could be impacted.  The default operating system set
 fprintf (st, "VMS.  The value 'n', if present in the \"SET CPU IDLE={OS}:n\" command,\n");
 fprintf (st, "indicats the number of seconds which the simulator must run before idling\n");
 fprintf (st, "starts.\n\n");
+fprintf (st, "The CPU caches the decoded operand specifiers of recently executed\n");
+fprintf (st, "instructions, so that loops do not parse their instructions again on\n");
+fprintf (st, "every iteration.  The cache is enabled by default:\n\n");
+fprintf (st, "   sim> SET CPU ICACHE                  enable cache, clear statistics\n");
+fprintf (st, "   sim> SET CPU NOICACHE                disable cache\n");
+fprintf (st, "   sim> SHOW CPU ICACHE                 display cache statistics\n\n");
 fprintf (st, "The CPU can maintain a history of the most recently executed instructions.\n");
 fprintf (st, "This is controlled by the SET CPU HISTORY and SHOW CPU HISTORY commands:\n\n");
 fprintf (st, "   sim> SET CPU HISTORY                 clear history buffer\n");
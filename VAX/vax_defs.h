@@ -682,7 +682,7 @@ enum opcodes {
 #define PCQ_SIZE        64                              /* must be 2**n */
 #define PCQ_MASK        (PCQ_SIZE - 1)
 #define PCQ_ENTRY       pcq[pcq_p = (pcq_p - 1) & PCQ_MASK] = fault_PC
-#define GET_ISTR(d,l)   d = get_istr (l, acc)
+#define GET_ISTR(d,l)   d = (icp? (PC = PC + (l), *icp++): get_istr (l, acc))
 #define CHECK_FOR_IDLE_LOOP if (PC == fault_PC) {                           /* to self? */ \
                                 if (PSL_GETIPL (PSL) == 0x1F)               /* int locked out? */ \
                                     ABORT (STOP_LOOP);                      /* infinite loop */ \
@@ -700,6 +700,19 @@ enum opcodes {
 #define SETPC(d)        PC = (d), FLUSH_ISTR
 #define FLUSH_ISTR      ibcnt = 0, ppc = -1
 
+/* Decoded instruction cache
+
+   Physical memory is divided into lines for write checking; a bit is set
+   in ic_lnmap for each line holding a cached instruction.  Writes to
+   memory test the bit and invalidate the line's cache entries.
+*/
+
+#define IC_V_LN         4                               /* line size */
+#define IC_INV          0xFFFFFFFF                      /* invalid address */
+#define IC_WRCHK(pa)    if (ic_lnmap[(pa) >> (IC_V_LN + 5)] & (1u << (((pa) >> IC_V_LN) & 0x1F))) \
+                            ic_zap (pa)
+#define IC_ZAP_XLATE    ic_vpg = IC_INV                 /* forget PC page xlate */
+
 /* Character string instructions */
 
 #define STR_V_DPC       24                              /* delta PC */
@@ -886,6 +899,8 @@ extern int32 pcq[PCQ_SIZE];                             /* PC queue */
 extern int32 pcq_p;                                     /* PC queue ptr */
 extern int32 in_ie;                                     /* in exc, int */
 extern int32 ibcnt, ppc;                                /* prefetch ctl */
+extern uint32 ic_vpg;                                   /* icache PC page */
+extern uint32 ic_lnmap[];                               /* icache line map */
 extern int32 hlt_pin;                                   /* HLT pin intr */
 extern int32 mxpr_cc_vc;                                /* cc V & C bits from mtpr/mfpr operations */
 extern int32 mem_err;
@@ -919,6 +934,7 @@ extern int32 op_probe (int32 *opnd, int32 opc);
 extern int32 op_mtpr (int32 *opnd);
 extern int32 op_mfpr (int32 *opnd);
 extern int32 intexc (int32 vec, int32 cc, int32 ipl, int ei);
+extern void ic_zap (uint32 pa);
 
 /* vax_cis.c externals */
 extern int32 op_cis (int32 *opnd, int32 cc, int32 opc, int32 acc);
@@ -593,6 +593,7 @@ if (ADDR_IS_MEM (ma)) {
         int32 t = M[ma >> 2];
         val = ((val & mask) << sc) | (t & ~(mask << sc));
         }
+    IC_WRCHK (ma);                                      /* cached istream? */
     M[ma >> 2] = val;
     }
 else {
@@ -642,6 +643,7 @@ uint32 ma;
 
 if (qba_map_addr (qa, &ma)) {                           /* in map? */
     if (ADDR_IS_MEM (ma)) {                             /* real memory? */
+        IC_WRCHK (ma);                                  /* cached istream? */
         if (md == WRITE) {                              /* word access? */
             int32 sc = (ma & 2) << 3;                   /* aligned only */
             M[ma >> 2] = (M[ma >> 2] & ~(WMASK << sc)) |
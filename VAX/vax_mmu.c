@@ -217,6 +217,7 @@ d_sbr = (SBR - 0x1000000) & ~03;                        /* VA<31> >> 7 */
 d_p0lr = (P0LR << 2);
 d_p1lr = (P1LR << 2) + 0x800000;                        /* VA<30> >> 7 */
 d_slr = (SLR << 2) + 0x1000000;                         /* VA<31> >> 7 */
+IC_ZAP_XLATE;                                           /* PC page xlate stale */
 }
 
 /* Zap process (0) or whole (1) tb */
@@ -230,6 +231,7 @@ for (i = 0; i < VA_TBSIZE; i++) {
     if (stb)
         stlb[i].tag = stlb[i].pte = -1;
     }
+IC_ZAP_XLATE;                                           /* PC page xlate stale */
 }
 
 /* Zap single tb entry corresponding to va */
@@ -241,6 +243,7 @@ int32 tbi = VA_GETTBI (VA_GETVPN (va));
 if (va & VA_S0)
     stlb[tbi].tag = stlb[tbi].pte = -1;
 else ptlb[tbi].tag = ptlb[tbi].pte = -1;
+IC_ZAP_XLATE;                                           /* PC page xlate stale */
 }
 
 /* Check for tlb entry corresponding to va */
@@ -267,6 +267,10 @@ static inline int fsync(int fd)
 }
 #endif
 
+#if defined(HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
 #ifndef MAX
 #define MAX(a,b)  (((a) >= (b)) ? (a) : (b))
 #endif
@@ -295,6 +299,9 @@ static inline int fsync(int fd)
 #define SRBSIZ          1024                            /* save/restore buffer */
 #define SIM_BRK_INILNT  4096                            /* bpt tbl length */
 #define SIM_BRK_ALLTYP  0xFFFFFFFB
+#define SIM_BRK_FLT_V   16                              /* log2 bpt filter bits */
+#define SIM_BRK_FLT_M   ((1u << SIM_BRK_FLT_V) - 1)
+#define SIM_BRK_FLT_IDX(a) ((uint32)((a) ^ ((a) >> SIM_BRK_FLT_V)) & SIM_BRK_FLT_M)
 #define UPDATE_SIM_TIME                                         \
     if (1) {                                                    \
         int32 _x;                                               \
@@ -631,6 +638,9 @@ static const char *_get_dbg_verb (uint32 dbits, DEVICE* dptr, UNIT *uptr);
 static t_stat sim_sanity_check_register_declarations (DEVICE **devices);
 static void fix_writelock_mtab (DEVICE *dptr);
 static t_stat _sim_debug_flush (void);
+static int32 _sim_queue_snapshot (UNIT ***units);
+static t_stat save_bg_wait (void);
+t_stat sim_set_queue (int32 flag, CONST char *cptr);
 
 /* Global data */
 
@@ -666,6 +676,7 @@ BRKTAB **sim_brk_tab = NULL;
 int32 sim_brk_ent = 0;
 int32 sim_brk_lnt = 0;
 int32 sim_brk_ins = 0;
+static uint32 sim_brk_filter[(SIM_BRK_FLT_M + 1) / 32];  /* address filter bitmap */
 int32 sim_quiet = 0;
 int32 sim_show_message = 1;                         /* the message display status of the currently open do file */
 int32 sim_step = 0;
@@ -682,6 +693,14 @@ size_t *sim_sub_instr_off = NULL;   /* offsets in substitution buffer where orig
 static double sim_time;
 static uint32 sim_rtime;
 static int32 noqueue_time;
+#define SIM_QUEUE_LIST  0                               /* event queue engines */
+#define SIM_QUEUE_HEAP  1
+static const char *sim_queue_engine_names[] = {"LIST", "HEAP"};
+static int32 sim_queue_engine = SIM_QUEUE_HEAP;
+static UNIT **sim_queue_heap = NULL;                    /* heap engine storage */
+static int32 sim_queue_heap_count = 0;                  /* heap entries in use */
+static int32 sim_queue_heap_size = 0;                   /* heap entries allocated */
+static t_uint64 sim_queue_seq = 0;                      /* activation sequence */
 volatile t_bool stop_cpu = FALSE;
 volatile t_bool sigterm_received = FALSE;
 static unsigned int sim_stop_sleep_ms = 250;
@@ -820,6 +839,7 @@ const char *sim_savename = sim_name;      /* Simulator Name used in SAVE/RESTORE
 /* Tables and strings */
 
 const char save_vercur[] = "V4.0";
+const char save_ver41[] = "V4.1";
 const char save_ver40[] = "V4.0";
 const char save_ver35[] = "V3.5";
 const char save_ver32[] = "V3.2";
@@ -1066,7 +1086,28 @@ static const char simh_help1[] =
       " The SAVE command (abbreviation SA) save the complete state of the simulator\n"
       " to a file.  This includes the contents of main memory and all registers,\n"
       " and the I/O connections of devices:\n\n"
-      "++SAVE <filename>\n\n"
+      "++SAVE {-I} {-Z} {-B} <filename>\n\n"
+      "4Switches\n"
+      " Switches can influence the output and behavior of the SAVE command\n\n"
+      "++-I      Incremental save containing only the memory blocks which\n"
+      "++++++++++changed since the previous SAVE.  RESTORE of an incremental\n"
+      "++++++++++save file first restores the previous save file(s) it is\n"
+      "++++++++++based on, so those files must remain available and\n"
+      "++++++++++unmodified.  A changed block is found by comparing a 64-bit\n"
+      "++++++++++signature of its contents with the one recorded by the\n"
+      "++++++++++previous SAVE, so there is a very small (about 1 in 2^64 per\n"
+      "++++++++++changed block) chance of a change going unnoticed.  Use a full\n"
+      "++++++++++SAVE where that can't be tolerated.\n"
+      "++-Z      Compress memory contents (when built with zlib)\n"
+      "++-B      Build the save image in memory, then write it to the file in\n"
+      "++++++++++a background thread while the simulator continues.  The image\n"
+      "++++++++++holds the state at the time of the command.  A later SAVE or\n"
+      "++++++++++RESTORE, or leaving the simulator, waits for the write to\n"
+      "++++++++++finish.  Only available in builds with asynchronous I/O\n"
+      "++++++++++support, and not on Windows.\n\n"
+      " An incremental save can't replace any of the files it is based on.\n"
+      " After 64 incremental saves in a row, SAVE -I writes a full save,\n"
+      " since RESTORE won't follow a longer chain of files.\n\n"
 #define HLP_RESTORE     "*Commands Saving_and_Restoring_State RESTORE"
       "3RESTORE\n"
       " The RESTORE command (abbreviation REST, alternately GET) restores a\n"
@@ -1079,7 +1120,9 @@ static const char simh_help1[] =
       "++-F      Overrides the related file timestamp validation check\n"
       "\n"
       "4Notes:\n"
-      " 1) SAVE file format compresses zeroes to minimize file size.\n"
+      " 1) SAVE file format compresses zeroes to minimize file size.  Incremental\n"
+      " and compressed saves are written in a newer format (V4.1) than full\n"
+      " saves (V4.0).\n"
       " 2) The simulator can't restore active incoming telnet sessions to\n"
       " multiplexer devices, but the listening ports will be restored across a\n"
       " save/restore.\n"
@@ -1244,6 +1287,15 @@ static const char simh_help1[] =
       "5-q\n"
       " If the -q switch is specified when creating a new file (-n) or opening one\n"
       " read only (-r), any messages announcing these facts will be suppressed.\n"
+      "5-m\n"
+      " Units which are buffered in memory (fixed head disks, drums and the like)\n"
+      " normally read the whole file into memory when attached and write it back\n"
+      " when detached or saved.  If the -m switch is specified, the file is mapped\n"
+      " into memory instead: attach does no I/O, modified data is written to the\n"
+      " file when it is flushed, saved or detached, and several simulators\n"
+      " attaching the same file read only (-r) share a single copy of it.  A\n"
+      " writable file shorter than the unit is extended to the unit's size.  If\n"
+      " the file can't be mapped, it is buffered as usual.\n"
       "5-f\n"
       " For simulated magnetic tapes, the ATTACH command can specify the format of\n"
       " the attached tape image file:\n\n"
@@ -1465,6 +1517,14 @@ static const char simh_help1[] =
       " The size of the circular memory buffer that is used is specified on\n"
       " the SET DEBUG command line, for example:\n\n"
       "++SET DEBUG -B <sizeinMB> <debug-destination>\n\n"
+      "5-W\n"
+      " The -W switch causes debug output to be written to the debug destination\n"
+      " by a separate thread.  Debug output is queued in an 8 MB memory ring so\n"
+      " the simulator doesn't wait for the disk.  If the writer falls behind and\n"
+      " the ring fills, debug output is discarded and counted.  SHOW DEBUG\n"
+      " displays the counts.  Output which a simulator writes directly to the\n"
+      " debug file, rather than via sim_debug, may appear out of order.\n"
+      " -W is not available with -B.\n\n"
 #define HLP_SET_BREAK  "*Commands SET Breakpoints"
       "3Breakpoints\n"
       "+SET BREAK <list>            set breakpoints\n"
@@ -1513,6 +1573,16 @@ static const char simh_help1[] =
       "3Asynch\n"
       "+SET ASYNCH                  enable asynchronous I/O\n"
       "+SET NOASYNCH                disable asynchronous I/O\n"
+#define HLP_SET_QUEUE "*Commands SET Queue"
+      "3Queue\n"
+      "+SET QUEUE ENGINE=LIST       maintain the event queue as a linked list\n"
+      "+SET QUEUE ENGINE=HEAP       maintain the event queue as a binary heap\n\n"
+      " The LIST engine keeps pending events in a list ordered by activation\n"
+      " time.  It is efficient when only a few events are pending at once.  The\n"
+      " HEAP engine keeps pending events in a priority queue, which is faster\n"
+      " for configurations with many active devices and lines.  Both engines\n"
+      " dispatch events in exactly the same order.  The SHOW QUEUE command\n"
+      " displays the engine currently in use.\n"
 #define HLP_SET_ENVIRON "*Commands SET Environment"
       "3Environment\n"
       "4Explicitily Changing a Variable\n"
@@ -2685,6 +2755,7 @@ static CTAB set_glob_tab[] = {
     { "NORUNLIMIT", &set_runlimit,              0, HLP_RUNLIMIT },
     { "NOAUTOSIZE", &sim_disk_set_noautosize,   1, HLP_NOAUTOSIZE },
     { "VIDEO",      &sim_video_params,          1, HLP_VIDEOPARAMS },
+    { "QUEUE",      &sim_set_queue,             0, HLP_SET_QUEUE },
     { NULL,         NULL,                       0 }
     };
 
@@ -3038,6 +3109,7 @@ if (SCPE_BARE_STATUS(stat) != SCPE_EXIT)
 
 cleanup_and_exit:
 
+save_bg_wait ();                                        /* finish a background SAVE */
 detach_all (0, TRUE);                                   /* close files */
 sim_set_deboff (0, NULL);                               /* close debug */
 sim_set_logoff (0, NULL);                               /* close log */
@@ -6567,6 +6639,8 @@ if (uptr->flags & UNIT_ATT) {
     fprintf (st, "attached to %s", uptr->filename);
     if (uptr->flags & UNIT_RO)
         fprintf (st, ", read only");
+    if (uptr->filemap)
+        fprintf (st, ", memory mapped");
     }
 else {
     if (uptr->flags & UNIT_ATTABLE) {
@@ -7098,6 +7172,8 @@ t_stat show_queue (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST
 {
 DEVICE *dptr;
 UNIT *uptr;
+UNIT **units;
+int32 i, count;
 MEMFILE buf;
 
 memset (&buf, 0, sizeof (buf));
@@ -7112,7 +7188,9 @@ else {
 
     fprintf (st, "%s event queue status, time = %.0f, executing %s %s/sec\n",
              sim_name, sim_time, sim_fmt_numeric (inst_per_sec), sim_vm_interval_units);
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
+    count = _sim_queue_snapshot (&units);
+    for (i = 0; i < count; i++) {
+        uptr = units[i];
         if (uptr == &sim_step_unit)
             fprintf (st, "  Step timer");
         else
@@ -7137,7 +7215,9 @@ else {
                                             (*tim) ? " (" : "", tim, (*tim) ? ")" : "",
                                             (uptr->flags & UNIT_IDLE) ? " (Idle capable)" : "");
         }
+    free (units);
     }
+fprintf (st, "Event queue engine: %s\n", sim_queue_engine_names[sim_queue_engine]);
 sim_show_clock_queues (st, dnotused, unotused, flag, cptr);
 #if defined (SIM_ASYNCH_IO)
 pthread_mutex_lock (&sim_asynch_lock);
@@ -8333,6 +8413,43 @@ if (dptr->attach != NULL)                               /* device routine? */
 return attach_unit (uptr, (CONST char *)cptr);          /* no, std routine */
 }
 
+/* Map a buffered unit's file into memory (ATTACH -M)
+
+   The mapping becomes the unit buffer, so attach reads nothing and data
+   written by the device reaches the file through the page cache.  This
+   needs a buffer allocated by SCP and file data which is not byte swapped.
+   A writable file is first extended to the unit's capacity; a read only
+   one must already be that long, and is mapped copy-on-write.  Failures
+   return non-OK and the caller falls back to reading the file into memory.
+*/
+
+static t_stat attach_map (DEVICE *dptr, UNIT *uptr)
+{
+uint32 cap = ((uint32) uptr->capac) / dptr->aincr;      /* effective size */
+size_t size = (size_t) cap * SZ_D (dptr);
+void *addr;
+
+if (!(uptr->flags & UNIT_MUSTBUF))                      /* static buffer? */
+    return sim_messagef (SCPE_NOFNC, "%s: unit buffer can't be mapped\n", sim_uname (uptr));
+if ((!sim_end) && (SZ_D (dptr) > 1))                    /* swapped data? */
+    return sim_messagef (SCPE_NOFNC, "%s: file data must be byte swapped, can't be mapped\n", sim_uname (uptr));
+if ((size == 0) || (uptr->dynflags & UNIT_NO_FIO))
+    return SCPE_NOFNC;
+if (sim_fsize_ex (uptr->fileref) < (t_offset) size) {   /* short file? */
+    if ((uptr->flags & UNIT_RO) ||
+        (sim_set_fsize (uptr->fileref, (t_addr) size) != 0))
+        return sim_messagef (SCPE_NOFNC, "%s: file is shorter than the unit, can't be mapped\n", sim_uname (uptr));
+    }
+if (sim_fmap_open (uptr->fileref, size, (uptr->flags & UNIT_RO) != 0,
+                   (FILEMAP **) &uptr->filemap, &addr) != SCPE_OK)
+    return SCPE_NOFNC;
+sim_messagef (SCPE_OK, "%s: mapping file into memory\n", sim_uname (uptr));
+uptr->filebuf = addr;
+uptr->hwmark = cap;
+uptr->flags = uptr->flags | UNIT_BUF;                   /* set buffered */
+return SCPE_OK;
+}
+
 /* Attach unit to file */
 
 t_stat attach_unit (UNIT *uptr, CONST char *cptr)
@@ -8403,7 +8520,9 @@ else {
             open_rw = TRUE;
         }                                               /* end else */
     }
-if (uptr->flags & UNIT_BUFABLE) {                       /* buffer? */
+if ((uptr->flags & UNIT_BUFABLE) &&                     /* buffer? */
+    (((sim_switches & SWMASK ('M')) == 0) ||            /* not mapping */
+     (attach_map (dptr, uptr) != SCPE_OK))) {           /* or can't map? */
     uint32 cap = ((uint32) uptr->capac) / dptr->aincr;  /* effective size */
 
     uptr->filebuf2 = calloc (cap, SZ_D (dptr));         /* allocate copy */
@@ -8539,6 +8658,14 @@ if (!(uptr->flags & UNIT_ATT)) {                        /* not attached? */
     }
 if ((dptr = find_dev_from_unit (uptr)) == NULL)
     return SCPE_OK;
+if ((uptr->flags & UNIT_BUF) && (uptr->filemap)) {      /* mapped? */
+    if (sim_fmap_sync ((FILEMAP *) uptr->filemap) != SCPE_OK)
+        sim_printf ("%s: I/O error - %s", sim_uname (uptr), strerror (errno));
+    sim_fmap_close ((FILEMAP *) uptr->filemap);         /* unmap */
+    uptr->filemap = NULL;
+    uptr->filebuf = NULL;
+    uptr->flags = uptr->flags & ~UNIT_BUF;
+    }
 if ((uptr->flags & UNIT_BUF) && (uptr->filebuf)) {
     uint32 cap = (uptr->hwmark + dptr->aincr - 1) / dptr->aincr;
     if (((uptr->flags & UNIT_RO) == 0) &&
@@ -8677,11 +8804,263 @@ return uptr->uname = strcpy ((char *)malloc (1 + strlen (uname)), uname);
    sa[ve] filename              save state to specified file
 */
 
+/* Incremental save state.
+
+   Each memory-like unit's contents are saved in blocks of SRBSIZ values.
+   When a foreground SAVE completes, a signature of every block is recorded
+   along with the name of the save file.  A later SAVE -I compares each
+   block's signature with the recorded one and writes only a marker for
+   blocks which are unchanged.  The incremental file names the file it is
+   based on, along with that file's length and signature, and RESTORE
+   checks both before reading it first.  Any failed save or any RESTORE
+   discards the recorded state, so the next incremental save must follow
+   a new full one.
+
+   The files a chain of incremental saves depends on are remembered, so
+   that SAVE -I can refuse to replace any of them, and can fall back to a
+   full save once the chain is as long as RESTORE will follow.
+
+   SAVE -B builds the whole save image in memory while the simulator is
+   stopped, then a thread writes it to the file.  The image is a copy, so
+   the simulator can continue at once, and it is recorded as a base just
+   like a foreground save.
+
+   Signatures are computed over little endian values, and compressed
+   blocks hold little endian values like the rest of the file, so save
+   files don't depend on the host's byte order.
+*/
+
+#define SAVE_F_INCR     1                               /* only changed blocks */
+#define SAVE_F_ZLIB     2                               /* compress blocks */
+#define SAVE_F_RECORD   4                               /* record block signatures */
+
+#define SAVE_MAX_CHAIN  64                              /* max incremental base depth */
+
+#define SAVE_BLK_SAME   1                               /* [V4.1] unchanged block */
+#define SAVE_BLK_ZLIB   2                               /* [V4.1] compressed block */
+
+typedef struct SAVE_MEMSIG {
+    UNIT        *uptr;                                  /* memory unit */
+    t_addr      capac;                                  /* capacity when recorded */
+    uint32      nblks;                                  /* number of blocks */
+    t_uint64    *sig;                                   /* block signatures */
+    } SAVE_MEMSIG;
+
+static SAVE_MEMSIG *save_sigs = NULL;                   /* recorded units */
+static int32 save_nsigs = 0;
+static char *save_chain[SAVE_MAX_CHAIN + 1];            /* recorded save files, oldest first */
+static int32 save_chain_len = 0;                        /* files in the chain */
+static t_offset save_base_len = 0;                      /* last one's length */
+static t_uint64 save_base_sig = 0;                      /* and signature */
+
+#if defined(SIM_ASYNCH_IO) && !defined(_WIN32)
+#define SAVE_BACKGROUND 1                               /* needs threads, open_memstream */
+
+static struct {
+    t_bool      active;                                 /* writer running */
+    pthread_t   thread;                                 /* writer thread */
+    FILE        *sfile;                                 /* save file */
+    char        *buf;                                   /* save image */
+    size_t      len;                                    /* its length */
+    t_stat      stat;                                   /* write status */
+    } save_bg;
+#endif
+
+static void save_sig_clear (void)
+{
+int32 i;
+
+for (i = 0; i < save_nsigs; i++)
+    free (save_sigs[i].sig);
+free (save_sigs);
+save_sigs = NULL;
+save_nsigs = 0;
+for (i = 0; i < save_chain_len; i++)
+    free (save_chain[i]);
+save_chain_len = 0;
+save_base_len = 0;
+save_base_sig = 0;
+}
+
+static SAVE_MEMSIG *save_sig_find (UNIT *uptr)
+{
+int32 i;
+
+for (i = 0; i < save_nsigs; i++)
+    if (save_sigs[i].uptr == uptr)
+        return &save_sigs[i];
+return NULL;
+}
+
+/* Block signature: 64 bits mixed a little endian word at a time */
+
+static t_uint64 save_sig_block (const uint8 *buf, size_t len)
+{
+t_uint64 h = 0x9E3779B97F4A7C15ull ^ len;
+t_uint64 w;
+
+for ( ; len >= sizeof (w); len -= sizeof (w), buf += sizeof (w)) {
+    memcpy (&w, buf, sizeof (w));
+    sim_buf_swap_data (&w, sizeof (w), 1);
+    h = (h ^ w) * 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 31;
+    }
+while (len--) {
+    h = (h ^ *buf++) * 0x94D049BB133111EBull;
+    h ^= h >> 29;
+    }
+return h;
+}
+
+/* Length and signature of a whole file, or of a save image in memory */
+
+#define SAVE_SIG_BUFSIZ 65536
+
+static t_uint64 save_sig_chunk (t_uint64 sig, const uint8 *buf, size_t len)
+{
+return (sig ^ save_sig_block (buf, len)) * 0x9E3779B97F4A7C15ull;
+}
+
+static t_stat save_sig_file (const char *name, t_offset *len, t_uint64 *sig)
+{
+FILE *f;
+uint8 *buf;
+size_t n;
+t_stat r;
+
+*len = 0;
+*sig = 0;
+if ((f = sim_fopen (name, "rb")) == NULL)
+    return SCPE_OPENERR;
+if ((buf = (uint8 *)malloc (SAVE_SIG_BUFSIZ)) == NULL) {
+    fclose (f);
+    return SCPE_MEM;
+    }
+while ((n = fread (buf, 1, SAVE_SIG_BUFSIZ, f)) > 0) {
+    *sig = save_sig_chunk (*sig, buf, n);
+    *len += (t_offset)n;
+    }
+r = ferror (f) ? SCPE_IOERR : SCPE_OK;
+free (buf);
+fclose (f);
+return r;
+}
+
+/* Record a completed save as the base for the next incremental save */
+
+static void save_chain_add (char *fullname, t_bool incremental, t_offset len, t_uint64 sig)
+{
+int32 i;
+
+if (!incremental) {                                     /* full save starts a new chain */
+    for (i = 0; i < save_chain_len; i++)
+        free (save_chain[i]);
+    save_chain_len = 0;
+    }
+save_chain[save_chain_len++] = fullname;
+save_base_len = len;
+save_base_sig = sig;
+}
+
+/* Wait for a background save to finish, reporting whether it failed */
+
+static t_stat save_bg_wait (void)
+{
+#if defined(SAVE_BACKGROUND)
+if (!save_bg.active)
+    return SCPE_OK;
+pthread_join (save_bg.thread, NULL);
+save_bg.active = FALSE;
+free (save_bg.buf);
+save_bg.buf = NULL;
+if (save_bg.stat != SCPE_OK) {
+    save_sig_clear ();                                  /* file can't be a base */
+    return sim_messagef (save_bg.stat, "Background SAVE failed\n");
+    }
+#endif
+return SCPE_OK;
+}
+
+static t_stat _sim_save (FILE *sfile, const char *base, uint32 flags);
+
+#if defined(SAVE_BACKGROUND)
+static void *_save_bg_write (void *arg)
+{
+t_stat r = SCPE_OK;
+
+if ((save_bg.len != 0) &&
+    (fwrite (save_bg.buf, 1, save_bg.len, save_bg.sfile) != save_bg.len))
+    r = SCPE_IOERR;
+if ((r == SCPE_OK) && fflush (save_bg.sfile))
+    r = SCPE_IOERR;
+if (r == SCPE_OK)
+    sim_set_fsize (save_bg.sfile, (t_addr)save_bg.len); /* truncate the save file */
+if (fclose (save_bg.sfile))
+    r = SCPE_IOERR;
+save_bg.stat = r;
+return NULL;
+}
+#endif
+
+/* Build a save image in memory and start a thread writing it to sfile,
+   which is always closed */
+
+static t_stat save_bg_start (FILE *sfile, const char *base, uint32 flags, t_offset *len, t_uint64 *sig)
+{
+#if defined(SAVE_BACKGROUND)
+FILE *mfile;
+size_t off, n;
+t_stat r;
+
+save_bg.buf = NULL;
+save_bg.len = 0;
+if ((mfile = open_memstream (&save_bg.buf, &save_bg.len)) == NULL) {
+    fclose (sfile);
+    return SCPE_MEM;
+    }
+r = _sim_save (mfile, base, flags);
+if (fclose (mfile) && (r == SCPE_OK))
+    r = SCPE_MEM;
+if (r != SCPE_OK) {
+    fclose (sfile);
+    free (save_bg.buf);
+    save_bg.buf = NULL;
+    return r;
+    }
+*len = (t_offset)save_bg.len;
+*sig = 0;
+for (off = 0; off < save_bg.len; off += n) {            /* as save_sig_file reads it */
+    n = MIN (save_bg.len - off, SAVE_SIG_BUFSIZ);
+    *sig = save_sig_chunk (*sig, (const uint8 *)save_bg.buf + off, n);
+    }
+save_bg.sfile = sfile;
+save_bg.stat = SCPE_OK;
+if (pthread_create (&save_bg.thread, NULL, _save_bg_write, NULL) != 0) {
+    _save_bg_write (NULL);                              /* no thread, write it now */
+    free (save_bg.buf);
+    save_bg.buf = NULL;
+    return save_bg.stat;
+    }
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "background write of %u bytes\n", (uint32)save_bg.len);
+save_bg.active = TRUE;                                  /* wait reports the status */
+return SCPE_OK;
+#else
+fclose (sfile);
+return SCPE_NOFNC;
+#endif
+}
+
 t_stat save_cmd (int32 flag, CONST char *cptr)
 {
 FILE *sfile;
 t_stat r;
+uint32 flags = 0;
+int32 i;
 char gbuf[4*CBUFSIZE];
+char *fullname;
+const char *base;
+t_offset len = 0;
+t_uint64 sig = 0;
 
 GET_SWITCHES (cptr);                                    /* get switches */
 if (*cptr == 0)                                         /* must be more */
@@ -8689,38 +9068,106 @@ if (*cptr == 0)                                         /* must be more */
 gbuf[sizeof(gbuf)-1] = '\0';
 strlcpy (gbuf, cptr, sizeof(gbuf));
 sim_trim_endspc (gbuf);
+r = save_bg_wait ();                                    /* finish any prior background save */
+if (r != SCPE_OK)
+    return r;
+if (sim_switches & SWMASK ('I')) {
+    if (save_chain_len == 0)
+        return sim_messagef (SCPE_ARG, "No previous SAVE for an incremental save to be based on\n");
+    if (save_chain_len > SAVE_MAX_CHAIN)                /* RESTORE wouldn't follow it */
+        sim_messagef (SCPE_OK, "%d incremental saves in a row, writing a full save\n", SAVE_MAX_CHAIN);
+    else
+        flags |= SAVE_F_INCR;
+    }
+if (sim_switches & SWMASK ('Z')) {
+#if defined(HAVE_ZLIB)
+    flags |= SAVE_F_ZLIB;
+#else
+    return sim_messagef (SCPE_NOFNC, "Compressed SAVE requires zlib support\n");
+#endif
+    }
+#if !defined(SAVE_BACKGROUND)
+if (sim_switches & SWMASK ('B'))
+    return sim_messagef (SCPE_NOFNC, "Background SAVE is not supported on this host\n");
+#endif
+if ((fullname = sim_filepath_parts (gbuf, "f")) == NULL)
+    return SCPE_MEM;
+if (flags & SAVE_F_INCR) {                              /* keep the files it's based on */
+    for (i = 0; i < save_chain_len; i++) {
+        if (strcmp (save_chain[i], fullname) == 0) {
+            free (fullname);
+            return sim_messagef (SCPE_ARG, "An incremental save can't replace a file it is based on: %s\n", gbuf);
+            }
+        }
+    }
 if ((sfile = sim_fopen (gbuf, "r+b")) == NULL) {    /* try existing file */
-    if ((sfile = sim_fopen (gbuf, "wb")) == NULL)   /* create new empty file */
+    if ((sfile = sim_fopen (gbuf, "wb")) == NULL) { /* create new empty file */
+        free (fullname);
         return SCPE_OPENERR;
+        }
+    }
+base = (flags & SAVE_F_INCR) ? save_chain[save_chain_len - 1] : NULL;
+if (sim_switches & SWMASK ('B'))                        /* background? */
+    r = save_bg_start (sfile, base, flags | SAVE_F_RECORD, &len, &sig);
+else {
+    r = _sim_save (sfile, base, flags | SAVE_F_RECORD);
+    if (fclose (sfile) && (r == SCPE_OK))
+        r = SCPE_IOERR;
+    if (r == SCPE_OK)
+        r = save_sig_file (fullname, &len, &sig);
+    }
+if (r == SCPE_OK)                                       /* remember for incremental saves */
+    save_chain_add (fullname, (flags & SAVE_F_INCR) != 0, len, sig);
+else {
+    free (fullname);
+    save_sig_clear ();
     }
-r = sim_save (sfile);
-fclose (sfile);
 return r;
 }
 
 t_stat sim_save (FILE *sfile)
 {
+return _sim_save (sfile, NULL, 0);
+}
+
+static t_stat _sim_save (FILE *sfile, const char *base, uint32 flags)
+{
 void *mbuf;
 int32 l, t;
-uint32 i, j, device_count;
+uint32 i, j, b, device_count;
 t_addr k, high;
 t_value val;
 t_stat r;
-t_bool zeroflg;
+t_bool zeroflg, v41;
 size_t sz;
 DEVICE *dptr;
 UNIT *uptr;
 REG *rptr;
+SAVE_MEMSIG *ms;
+t_uint64 sig, *sigs;
+#if defined(HAVE_ZLIB)
+Bytef *zbuf = NULL;
+uLongf zlen;
+#endif
 
 #define WRITE_I(xx) sim_fwrite (&(xx), sizeof (xx), 1, sfile)
 
-sim_debug(SIM_DBG_SAVE, &sim_scp_dev, "sim_save ()\n");
+sim_debug(SIM_DBG_SAVE, &sim_scp_dev, "sim_save (base=%s, flags=%X)\n", base ? base : "", flags);
 
 /* Don't make changes below without also changing save_vercur above */
 
-fprintf (sfile, "%s\n%s\n%s\n%s\n%s\n%.0f\n",
-    save_vercur,                                        /* [V2.5] save format */
-    sim_savename,                                       /* sim name */
+v41 = ((flags & (SAVE_F_INCR | SAVE_F_ZLIB)) != 0);
+fprintf (sfile, "%s\n%s\n",
+    v41 ? save_ver41 : save_vercur,                     /* [V2.5] save format */
+    sim_savename);                                      /* sim name */
+if (v41) {                                              /* [V4.1] incremental base */
+    if ((flags & SAVE_F_INCR) && base)
+        fprintf (sfile, "%s\n%" LL_FMT "u %016" LL_FMT "X\n", base,
+                 (unsigned LL_TYPE)save_base_len, (unsigned LL_TYPE)save_base_sig);
+    else
+        fprintf (sfile, "\n0 0\n");
+    }
+fprintf (sfile, "%s\n%s\n%s\n%.0f\n",
     sim_si64, sim_sa64, eth_capabilities(),             /* [V3.5] options */
     sim_time);                                          /* [V3.2] sim time */
 WRITE_I (sim_rtime);                                    /* [V2.6] sim rel time */
@@ -8773,10 +9220,17 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
                 uptr->hwmark &&                         /* files need to be */
                 ((uptr->flags & UNIT_RO) == 0)) {       /* written on save */
                 uint32 cap = (uptr->hwmark + dptr->aincr - 1) / dptr->aincr;
-                rewind (uptr->fileref);
-                sim_fwrite (uptr->filebuf, SZ_D (dptr), cap, uptr->fileref);
-                fclose (uptr->fileref);                 /* flush data and state */
-                uptr->fileref = sim_fopen (uptr->filename, "rb+");/* reopen r/w */
+
+                if (uptr->filemap) {                    /* mapped? */
+                    if (sim_fmap_sync ((FILEMAP *) uptr->filemap) != SCPE_OK)
+                        sim_printf ("%s: I/O error - %s", sim_uname (uptr), strerror (errno));
+                    }
+                else {
+                    rewind (uptr->fileref);
+                    sim_fwrite (uptr->filebuf, SZ_D (dptr), cap, uptr->fileref);
+                    fclose (uptr->fileref);             /* flush data and state */
+                    uptr->fileref = sim_fopen (uptr->filename, "rb+");/* reopen r/w */
+                    }
                 }
             }
         fputc ('\n', sfile);
@@ -8789,28 +9243,110 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
                 fclose (sfile);
                 return SCPE_MEM;
                 }
-            for (k = 0; k < high; ) {                   /* loop thru mem */
+            b = (uint32)((((high + dptr->aincr - 1) / dptr->aincr) + SRBSIZ - 1) / SRBSIZ);
+            ms = save_sig_find (uptr);
+            if ((ms != NULL) &&                         /* stale signatures? */
+                ((ms->capac != high) || (ms->nblks != b))) {
+                free (ms->sig);
+                ms->sig = NULL;
+                ms->nblks = 0;
+                }
+            sigs = NULL;
+            if ((flags & SAVE_F_RECORD) &&
+                ((sigs = (t_uint64 *)calloc (b, sizeof (*sigs))) == NULL)) {
+                free (mbuf);
+                return SCPE_MEM;
+                }
+#if defined(HAVE_ZLIB)
+            if ((flags & SAVE_F_ZLIB) &&
+                ((zbuf = (Bytef *)malloc (compressBound (SRBSIZ * sz))) == NULL)) {
+                free (sigs);
+                free (mbuf);
+                return SCPE_MEM;
+                }
+#endif
+            for (k = 0, b = 0; k < high; b++) {         /* loop thru mem */
                 zeroflg = TRUE;
                 for (l = 0; (l < SRBSIZ) && (k < high); l++,
                      k = k + (dptr->aincr)) {           /* check for 0 block */
                     r = dptr->examine (&val, k, uptr, SIM_SW_REST);
                     if (r != SCPE_OK) {
+#if defined(HAVE_ZLIB)
+                        free (zbuf);
+#endif
+                        free (sigs);
                         free (mbuf);
                         return r;
                         }
                     if (val) zeroflg = FALSE;
                     SZ_STORE (sz, val, mbuf, l);
                     }                                   /* end for l */
-                if (zeroflg) {                          /* all zero's? */
+                sig = 0;
+                if (flags & (SAVE_F_INCR | SAVE_F_RECORD))
+                    sig = save_sig_block ((uint8 *)mbuf, l * sz);
+                if (sigs)
+                    sigs[b] = sig;
+                if ((!zeroflg) &&                       /* unchanged since base? */
+                    (flags & SAVE_F_INCR) &&
+                    (ms != NULL) && (ms->sig != NULL) && (ms->sig[b] == sig)) {
+                    t = 0;                              /* [V4.1] escape */
+                    WRITE_I (t);
+                    t = SAVE_BLK_SAME;
+                    WRITE_I (t);
+                    WRITE_I (l);                        /* value count */
+                    }
+                else if (zeroflg) {                     /* all zero's? */
                     l = -l;                             /* invert block count */
                     WRITE_I (l);                        /* write only count */
                     }
                 else {
+#if defined(HAVE_ZLIB)
+                    zlen = (uLongf)compressBound (SRBSIZ * sz);
+                    if (flags & SAVE_F_ZLIB)
+                        sim_buf_swap_data (mbuf, sz, l);/* compress little endian values */
+                    if ((flags & SAVE_F_ZLIB) &&
+                        (compress2 (zbuf, &zlen, (const Bytef *)mbuf, (uLong)(l * sz), Z_BEST_SPEED) == Z_OK) &&
+                        (zlen < l * sz)) {
+                        t = 0;                          /* [V4.1] escape */
+                        WRITE_I (t);
+                        t = SAVE_BLK_ZLIB;
+                        WRITE_I (t);
+                        WRITE_I (l);                    /* value count */
+                        t = (int32)zlen;
+                        WRITE_I (t);                    /* compressed length */
+                        sim_fwrite (zbuf, 1, zlen, sfile);
+                        continue;
+                        }
+                    if (flags & SAVE_F_ZLIB)
+                        sim_buf_swap_data (mbuf, sz, l);/* back to host order */
+#endif
                     WRITE_I (l);                        /* block count */
                     sim_fwrite (mbuf, sz, l, sfile);
                     }
                 }                                       /* end for k */
+#if defined(HAVE_ZLIB)
+            free (zbuf);
+            zbuf = NULL;
+#endif
             free (mbuf);                                /* dealloc buffer */
+            if (sigs) {                                 /* record signatures */
+                if (ms == NULL) {
+                    SAVE_MEMSIG *nsigs = (SAVE_MEMSIG *)realloc (save_sigs, (save_nsigs + 1) * sizeof (*save_sigs));
+
+                    if (nsigs == NULL) {
+                        free (sigs);
+                        return SCPE_MEM;
+                        }
+                    save_sigs = nsigs;
+                    ms = &save_sigs[save_nsigs++];
+                    ms->uptr = uptr;
+                    ms->sig = NULL;
+                    }
+                free (ms->sig);
+                ms->sig = sigs;
+                ms->nblks = b;
+                ms->capac = high;
+                }
             }                                           /* end if mem */
         else {                                          /* no memory */
             high = 0;                                   /* write 0 */
@@ -8859,10 +9395,50 @@ if (*cptr == 0)                                         /* must be more */
 gbuf[sizeof(gbuf)-1] = '\0';
 strlcpy (gbuf, cptr, sizeof(gbuf));
 sim_trim_endspc (gbuf);
+save_bg_wait ();                                        /* file may still be being written */
 if ((rfile = sim_fopen (gbuf, "rb")) == NULL)
     return SCPE_OPENERR;
 r = sim_rest (rfile);
 fclose (rfile);
+save_sig_clear ();                                      /* memory no longer matches last save */
+return r;
+}
+
+/* Restore the save file an incremental save is based on.  Only its state
+   is restored; attaching devices is left to the incremental file. */
+
+static t_stat sim_rest_base (const char *base, const char *basesig, t_bool force_restore)
+{
+static int32 depth = 0;
+FILE *bfile;
+int32 saved_switches = sim_switches;
+unsigned LL_TYPE len, sig;
+t_offset flen;
+t_uint64 fsig;
+t_stat r;
+
+sim_debug (SIM_DBG_RESTORE, &sim_scp_dev, "restoring incremental base %s (%s)\n", base, basesig);
+if (depth >= SAVE_MAX_CHAIN)                            /* base replaced by a later save? */
+    return sim_messagef (SCPE_INCOMP, "Incremental save base files are circular or nested too deeply\n");
+if (sscanf (basesig, "%" LL_FMT "u %" LL_FMT "X", &len, &sig) != 2)
+    return sim_messagef (SCPE_INCOMP, "Invalid incremental save base signature: %s\n", basesig);
+r = save_sig_file (base, &flen, &fsig);
+if (r == SCPE_OPENERR)
+    return sim_messagef (SCPE_OPENERR, "Can't open incremental save base file: %s\n", base);
+if (r != SCPE_OK)
+    return sim_messagef (r, "Error reading incremental save base file: %s\n", base);
+if (((t_uint64)flen != (t_uint64)len) || (fsig != (t_uint64)sig))
+    return sim_messagef (SCPE_INCOMP, "Incremental save base file has changed since the save: %s\n", base);
+if ((bfile = sim_fopen (base, "rb")) == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't open incremental save base file: %s\n", base);
+sim_switches = SWMASK ('D') | SWMASK ('Q') | (force_restore ? SWMASK ('F') : 0);
+++depth;
+r = sim_rest (bfile);
+--depth;
+sim_switches = saved_switches;
+fclose (bfile);
+if ((r != SCPE_OK) && (depth == 0))
+    sim_printf ("Error restoring incremental save base file: %s\n", base);
 return r;
 }
 
@@ -8880,7 +9456,7 @@ t_addr k, high, old_capac;
 t_value val, max;
 t_stat r;
 size_t sz;
-t_bool v40, v35, v32;
+t_bool v41, v40, v35, v32;
 DEVICE *dptr;
 UNIT *uptr;
 REG *rptr;
@@ -8907,8 +9483,10 @@ if (fstat (fileno (rfile), &rstat)) {
     }
 READ_S (buf);                                           /* [V2.5+] read version */
 sim_debug (SIM_DBG_RESTORE, &sim_scp_dev, "version=%s\n", buf);
-v40 = v35 = v32 = FALSE;
-if (strcmp (buf, save_ver40) == 0)                      /* version 4.0? */
+v41 = v40 = v35 = v32 = FALSE;
+if (strcmp (buf, save_ver41) == 0)                      /* version 4.1? */
+    v41 = v40 = v35 = v32 = TRUE;
+else if (strcmp (buf, save_ver40) == 0)                 /* version 4.0? */
     v40 = v35 = v32 = TRUE;
 else if (strcmp (buf, save_ver35) == 0)                 /* version 3.5? */
     v35 = v32 = TRUE;
@@ -8918,7 +9496,7 @@ else if (strcmp (buf, save_ver30) != 0) {               /* version 3.0? */
     sim_printf ("Invalid file version: %s\n", buf);
     return SCPE_INCOMP;
     }
-if ((strcmp (buf, save_ver40) != 0) && (!sim_quiet) && (!suppress_warning)) {
+if ((!v40) && (!sim_quiet) && (!suppress_warning)) {
     sim_printf ("warning - attempting to restore a saved simulator image in %s image format.\n", buf);
     warned = TRUE;
     }
@@ -8928,6 +9506,15 @@ if (strcmp (buf, sim_savename)) {                       /* name match? */
     sim_printf ("Wrong system type: %s\n", buf);
     return SCPE_INCOMP;
     }
+if (v41) {                                              /* [V4.1+] incremental base */
+    char basesig[CBUFSIZE];
+
+    READ_S (buf);
+    READ_S (basesig);                                   /* base length and signature */
+    if ((buf[0] != '\0') &&
+        ((r = sim_rest_base (buf, basesig, force_restore)) != SCPE_OK))
+        goto Cleanup_Return;
+    }
 if (v35) {                                              /* [V3.5+] options */
     READ_S (buf);                                       /* integer size */
     if (strcmp (buf, sim_si64) != 0) {
@@ -9106,7 +9693,52 @@ for ( ;; ) {                                            /* device loop */
                     r = SCPE_IOERR;
                     goto Cleanup_Return;
                     }
-                if (blkcnt < 0)                         /* compressed? */
+                if ((blkcnt == 0) && v41) {             /* [V4.1+] escape? */
+                    int32 kind;
+
+                    READ_I (kind);
+                    READ_I (limit);                     /* value count */
+                    if ((limit <= 0) || (limit > SRBSIZ)) {
+                        r = SCPE_IOERR;
+                        goto Cleanup_Return;
+                        }
+                    if (kind == SAVE_BLK_SAME) {        /* unchanged from base */
+                        k = k + limit * dptr->aincr;
+                        continue;
+                        }
+                    if (kind == SAVE_BLK_ZLIB) {        /* compressed */
+#if defined(HAVE_ZLIB)
+                        int32 clen;
+                        uLongf dlen = (uLongf)(limit * sz);
+                        Bytef *cbuf;
+
+                        READ_I (clen);
+                        if ((clen <= 0) || ((cbuf = (Bytef *)malloc (clen)) == NULL)) {
+                            r = SCPE_IOERR;
+                            goto Cleanup_Return;
+                            }
+                        if ((sim_fread (cbuf, 1, clen, rfile) != (size_t)clen) ||
+                            (uncompress ((Bytef *)mbuf, &dlen, cbuf, (uLong)clen) != Z_OK) ||
+                            (dlen != (uLongf)(limit * sz))) {
+                            free (cbuf);
+                            r = SCPE_IOERR;
+                            goto Cleanup_Return;
+                            }
+                        free (cbuf);
+                        sim_buf_swap_data (mbuf, sz, limit);/* little endian values */
+                        blkcnt = limit;
+#else
+                        sim_printf ("Compressed save files require zlib support\n");
+                        r = SCPE_INCOMP;
+                        goto Cleanup_Return;
+#endif
+                        }
+                    else {
+                        r = SCPE_IOERR;
+                        goto Cleanup_Return;
+                        }
+                    }
+                else if (blkcnt < 0)                    /* compressed? */
                     limit = -blkcnt;
                 else
                     limit = (int32)sim_fread (mbuf, sz, blkcnt, rfile);
@@ -9234,6 +9866,8 @@ for (i = 1; (dptr = sim_devices[i]) != NULL; i++) {     /* flush attached files
                     !sim_is_running)
                     uptr->io_flush (uptr);              /* call it */
                 }
+            else if (uptr->filemap)                     /* mapped? */
+                sim_fmap_sync ((FILEMAP *) uptr->filemap);
             else {
                 if (!(uptr->flags & UNIT_BUF) &&        /* not buffered, */
                     (uptr->fileref) &&                  /* real file, */
@@ -12000,86 +12634,441 @@ for (c=0, p=buf; c < len; c++) {
 return buf;
 }
 
-/* Event queue package
-
-        sim_activate            add entry to event queue
-        sim_activate_abs        add entry to event queue even if event already scheduled
-        sim_activate_notbefore  add entry to event queue even if event already scheduled
-                                but not before the specified time
-        sim_activate_after      add entry to event queue after a specified amount of wall time
-        sim_cancel              remove entry from event queue
-        sim_process_event       process entries on event queue
-        sim_is_active           see if entry is on event queue
-        sim_activate_time       return time until activation
-        sim_atime               return absolute time for an entry
-        sim_gtime               return global time
-        sim_qcount              return event queue entry count
+/* Event queue engines
 
-   Asynchronous events are set up by queueing a unit data structure
-   to the event queue with a timeout (in simulator units, relative
-   to the current time).  Each simulator 'times' these events by
-   counting down interval counter sim_interval.  When this reaches
-   zero the simulator calls sim_process_event to process the event
-   and to see if further events need to be processed, or sim_interval
-   reset to count the next one.
+   The event queue can be maintained by one of two engines, selected with
+   the SET QUEUE ENGINE=LIST|HEAP command:
 
-   The event queue is maintained in clock order; entry timeouts are
-   RELATIVE to the time in the previous entry.
+        LIST    the original singly linked list threaded through uptr->next,
+                kept in clock order with each entry's time RELATIVE to the
+                entry ahead of it.  Activation and cancellation walk the
+                list and are O(n) in the number of queued events.
+        HEAP    a binary min-heap of units ordered by absolute due time
+                (uptr->q_key) and then by activation order (uptr->q_seq),
+                so events due at the same time still fire first-in
+                first-out.  Activation and cancellation are O(log n).
 
-   sim_process_event - process event
+   With either engine sim_clock_queue points at the next unit to fire and
+   sim_clock_queue->time is the delay until it fires, so UPDATE_SIM_TIME
+   and simulator code which looks at the head of the queue see identical
+   state.  With the HEAP engine every queued unit has its next pointer set
+   to QUEUE_LIST_END (so uptr->next still indicates a queued unit), and the
+   time of units other than the head is not meaningful.  Code which needs
+   to visit the queued units in order uses _sim_queue_snapshot.
 
-   Inputs:
-        none
-   Outputs:
-        reason  =       reason code returned by any event processor,
-                        or 0 (SCPE_OK) if no exceptions
+   The engine routines assume that UPDATE_SIM_TIME has been performed by
+   the caller, so that sim_clock_queue->time is current.
 */
 
-t_stat sim_process_event (void)
+static t_bool _sim_heap_before (UNIT *a, UNIT *b)
 {
-UNIT *uptr;
-t_stat reason, bare_reason;
-int32 sim_interval_catchup;
+return ((a->q_key < b->q_key) ||
+        ((a->q_key == b->q_key) && (a->q_seq < b->q_seq)));
+}
 
-if (stop_cpu) {                                         /* stop CPU? */
-    stop_cpu = FALSE;
-    return SCPE_STOP;
-    }
-AIO_UPDATE_QUEUE;
-UPDATE_SIM_TIME;                                        /* update sim time */
-if (sim_interval > 0) {
-    sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Interval not yet expired: %d\n", sim_interval);
-    return SCPE_OK;
-    }
-if (sim_clock_queue == QUEUE_LIST_END) {                /* queue empty? */
-    sim_interval = noqueue_time = NOQUEUE_WAIT;         /* flag queue empty */
-    sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Queue Empty New Interval = %d\n", sim_interval);
-    return SCPE_OK;
+static void _sim_heap_place (UNIT *uptr, int32 idx)
+{
+sim_queue_heap[idx] = uptr;
+uptr->q_index = idx;
+}
+
+static void _sim_heap_sift_up (int32 idx)
+{
+UNIT *uptr = sim_queue_heap[idx];
+
+while (idx > 0) {
+    int32 parent = (idx - 1) / 2;
+
+    if (!_sim_heap_before (uptr, sim_queue_heap[parent]))
+        break;
+    _sim_heap_place (sim_queue_heap[parent], idx);
+    idx = parent;
     }
-sim_processing_event = TRUE;
-/* If sim_interval is negative, we've missed the opportunity to  */
-/* dispatch one or more events when they were scheduled to fire. */
-/* To accomodate this, we backup time to when the first event    */
-/* was supposed to fire and advance it from there until things   */
-/* have caught up.                                               */
-if (sim_interval < 0) {
-    sim_interval_catchup = sim_interval;
-    sim_interval = 0;
-    UPDATE_SIM_TIME;                          /* update sim time */
-    sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "Processing event for %s with sim_interval = %d, event time = %.0f\n",
-        sim_uname (sim_clock_queue), sim_interval_catchup, sim_gtime ());
-    if (sim_clock_queue->next != QUEUE_LIST_END)
-        sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "- Next event for %s after = %d\n",
-            sim_uname (sim_clock_queue->next), sim_clock_queue->next->time);
-    sim_time -= sim_clock_queue->time;
-    sim_rtime -= sim_clock_queue->time;
+_sim_heap_place (uptr, idx);
+}
+
+static void _sim_heap_sift_down (int32 idx)
+{
+UNIT *uptr = sim_queue_heap[idx];
+
+while (1) {
+    int32 child = 2 * idx + 1;
+
+    if (child >= sim_queue_heap_count)
+        break;
+    if ((child + 1 < sim_queue_heap_count) &&
+        _sim_heap_before (sim_queue_heap[child + 1], sim_queue_heap[child]))
+        ++child;
+    if (!_sim_heap_before (sim_queue_heap[child], uptr))
+        break;
+    _sim_heap_place (sim_queue_heap[child], idx);
+    idx = child;
     }
+_sim_heap_place (uptr, idx);
+}
+
+static t_bool _sim_heap_contains (UNIT *uptr)
+{
+return ((uptr->next != NULL) &&
+        (uptr->q_index >= 0) &&
+        (uptr->q_index < sim_queue_heap_count) &&
+        (sim_queue_heap[uptr->q_index] == uptr));
+}
+
+static void _sim_heap_remove (UNIT *uptr)
+{
+int32 idx = uptr->q_index;
+UNIT *last = sim_queue_heap[--sim_queue_heap_count];
+
+uptr->q_index = -1;
+if (idx == sim_queue_heap_count)                        /* removed last entry? */
+    return;
+_sim_heap_place (last, idx);
+if ((idx > 0) && _sim_heap_before (last, sim_queue_heap[(idx - 1) / 2]))
+    _sim_heap_sift_up (idx);
 else
-    sim_interval_catchup = 0;
-do {
-    uptr = sim_clock_queue;                             /* get first */
-    sim_clock_queue = uptr->next;                       /* remove first */
+    _sim_heap_sift_down (idx);
+}
+
+/* Insert a unit in the queue to fire event_time from now */
+
+static void _sim_queue_insert (UNIT *uptr, int32 event_time)
+{
+UNIT *cptr, *prvptr;
+int32 accum;
+
+if (sim_queue_engine == SIM_QUEUE_HEAP) {
+    t_int64 now = 0;
+
+    if (sim_queue_heap_count == sim_queue_heap_size) {
+        sim_queue_heap_size = (sim_queue_heap_size == 0) ? 64 : 2 * sim_queue_heap_size;
+        sim_queue_heap = (UNIT **)realloc (sim_queue_heap, sim_queue_heap_size * sizeof (*sim_queue_heap));
+        if (sim_queue_heap == NULL) {
+            sim_printf ("Event queue allocation failed for %s\n", sim_uname (uptr));
+            abort ();
+            }
+        }
+    if (sim_queue_heap_count > 0)
+        now = sim_queue_heap[0]->q_key - sim_queue_heap[0]->time;
+    uptr->q_key = now + event_time;
+    uptr->q_seq = sim_queue_seq++;
+    uptr->next = QUEUE_LIST_END;
+    sim_queue_heap[sim_queue_heap_count] = uptr;
+    _sim_heap_sift_up (sim_queue_heap_count++);
+    sim_clock_queue = sim_queue_heap[0];
+    if (sim_clock_queue == uptr)                        /* new head? */
+        uptr->time = event_time;
+    else
+        uptr->time = (int32)(uptr->q_key - sim_clock_queue->q_key);
+    return;
+    }
+prvptr = NULL;
+accum = 0;
+for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
+    if (event_time < (accum + cptr->time))
+        break;
+    accum = accum + cptr->time;
+    prvptr = cptr;
+    }
+if (prvptr == NULL) {                                   /* insert at head */
+    cptr = uptr->next = sim_clock_queue;
+    sim_clock_queue = uptr;
+    }
+else {
+    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
+    prvptr->next = uptr;
+    }
+uptr->time = event_time - accum;
+if (cptr != QUEUE_LIST_END)
+    cptr->time = cptr->time - uptr->time;
+}
+
+/* Remove the head of the queue because it is firing.  The new head's
+   time is its delay relative to the firing unit. */
+
+static UNIT *_sim_queue_pop (void)
+{
+UNIT *uptr = sim_clock_queue;
+
+if (sim_queue_engine == SIM_QUEUE_HEAP) {
+    _sim_heap_remove (uptr);
+    if (sim_queue_heap_count > 0) {
+        sim_clock_queue = sim_queue_heap[0];
+        sim_clock_queue->time = (int32)(sim_clock_queue->q_key - uptr->q_key);
+        }
+    else
+        sim_clock_queue = QUEUE_LIST_END;
+    }
+else
+    sim_clock_queue = uptr->next;
+uptr->next = NULL;                                      /* hygiene */
+return uptr;
+}
+
+/* Remove an arbitrary unit from the queue.  Any remaining delay on the
+   removed unit is passed on to its successor. */
+
+static void _sim_queue_remove (UNIT *uptr)
+{
+UNIT *cptr, *nptr;
+
+if (sim_queue_engine == SIM_QUEUE_HEAP) {
+    if (!_sim_heap_contains (uptr))
+        return;
+    _sim_heap_remove (uptr);
     uptr->next = NULL;                                  /* hygiene */
+    if (sim_clock_queue == uptr) {                      /* removed head? */
+        if (sim_queue_heap_count > 0) {
+            sim_clock_queue = sim_queue_heap[0];
+            sim_clock_queue->time = (int32)(sim_clock_queue->q_key - uptr->q_key) + uptr->time;
+            }
+        else
+            sim_clock_queue = QUEUE_LIST_END;
+        }
+    uptr->time = 0;
+    return;
+    }
+nptr = QUEUE_LIST_END;
+if (sim_clock_queue == uptr) {
+    nptr = sim_clock_queue = uptr->next;
+    uptr->next = NULL;                                  /* hygiene */
+    }
+else {
+    for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
+        if (cptr->next == uptr) {
+            nptr = cptr->next = uptr->next;
+            uptr->next = NULL;                          /* hygiene */
+            break;                                      /* end queue scan */
+            }
+        }
+    }
+if (nptr != QUEUE_LIST_END)
+    nptr->time += (uptr->next) ? 0 : uptr->time;
+if (!uptr->next)
+    uptr->time = 0;
+}
+
+/* Return the delay of a queued unit relative to the head of the queue,
+   or -1 if the unit is not in the queue */
+
+static int32 _sim_queue_offset (UNIT *uptr)
+{
+UNIT *cptr;
+int32 accum;
+
+if (sim_queue_engine == SIM_QUEUE_HEAP) {
+    if (!_sim_heap_contains (uptr))
+        return -1;
+    return (int32)(uptr->q_key - sim_clock_queue->q_key);
+    }
+accum = 0;
+for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
+    if (cptr != sim_clock_queue)
+        accum = accum + cptr->time;
+    if (cptr == uptr)
+        return accum;
+    }
+return -1;
+}
+
+/* Return the unit which fires after the head of the queue, and its delay
+   relative to the head */
+
+static UNIT *_sim_queue_following (int32 *delay)
+{
+UNIT *uptr;
+
+if (sim_queue_engine == SIM_QUEUE_HEAP) {
+    if (sim_queue_heap_count < 2)
+        return QUEUE_LIST_END;
+    uptr = sim_queue_heap[1];
+    if ((sim_queue_heap_count > 2) && _sim_heap_before (sim_queue_heap[2], uptr))
+        uptr = sim_queue_heap[2];
+    *delay = (int32)(uptr->q_key - sim_clock_queue->q_key);
+    return uptr;
+    }
+uptr = sim_clock_queue->next;
+if (uptr != QUEUE_LIST_END)
+    *delay = uptr->time;
+return uptr;
+}
+
+static int _sim_queue_compare (const void *pa, const void *pb)
+{
+UNIT *a = *(UNIT * const *)pa;
+UNIT *b = *(UNIT * const *)pb;
+
+if (_sim_heap_before (a, b))
+    return -1;
+return (a == b) ? 0 : 1;
+}
+
+/* Return a malloc'ed array of the queued units in firing order */
+
+static int32 _sim_queue_snapshot (UNIT ***units)
+{
+UNIT *uptr;
+int32 count = sim_qcount ();
+int32 i = 0;
+
+*units = (UNIT **)calloc (count + 1, sizeof (**units));
+if (*units == NULL)
+    return 0;
+if (sim_queue_engine == SIM_QUEUE_HEAP) {
+    memcpy (*units, sim_queue_heap, count * sizeof (**units));
+    qsort (*units, count, sizeof (**units), _sim_queue_compare);
+    }
+else {
+    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next)
+        (*units)[i++] = uptr;
+    }
+return count;
+}
+
+/* Change the event queue engine, preserving the queued events, their
+   delays and the order of events due at the same time */
+
+static t_stat _sim_queue_set_engine (int32 engine)
+{
+UNIT **units;
+int32 *delays;
+int32 i, count;
+
+if (engine == sim_queue_engine)
+    return SCPE_OK;
+UPDATE_SIM_TIME;                                        /* update sim time */
+count = _sim_queue_snapshot (&units);
+delays = (int32 *)calloc (count + 1, sizeof (*delays));
+if ((delays == NULL) || ((count == 0) && (sim_clock_queue != QUEUE_LIST_END))) {
+    free (units);
+    free (delays);
+    return SCPE_MEM;
+    }
+for (i = 0; i < count; i++) {
+    delays[i] = sim_clock_queue->time + _sim_queue_offset (units[i]);
+    }
+for (i = 0; i < count; i++) {
+    units[i]->next = NULL;
+    units[i]->q_index = -1;
+    }
+sim_clock_queue = QUEUE_LIST_END;
+sim_queue_heap_count = 0;
+sim_queue_engine = engine;
+for (i = 0; i < count; i++)
+    _sim_queue_insert (units[i], delays[i]);
+free (units);
+free (delays);
+return SCPE_OK;
+}
+
+/* Set queue routine */
+
+t_stat sim_set_queue (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+CONST char *tptr;
+int32 i;
+
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_2FARG;
+tptr = get_glyph (cptr, gbuf, '=');
+if (strcmp (gbuf, "ENGINE") != 0)
+    return sim_messagef (SCPE_ARG, "Unknown SET QUEUE option: %s\n", gbuf);
+if ((tptr == NULL) || (*tptr == 0))
+    return SCPE_MISVAL;
+tptr = get_glyph (tptr, gbuf, 0);
+if (*tptr != 0)
+    return SCPE_2MARG;
+for (i = 0; i < (int32)(sizeof (sim_queue_engine_names) / sizeof (sim_queue_engine_names[0])); i++) {
+    if (strcmp (gbuf, sim_queue_engine_names[i]) == 0)
+        return _sim_queue_set_engine (i);
+    }
+return sim_messagef (SCPE_ARG, "Unknown event queue engine: %s\n", gbuf);
+}
+
+/* Event queue package
+
+        sim_activate            add entry to event queue
+        sim_activate_abs        add entry to event queue even if event already scheduled
+        sim_activate_notbefore  add entry to event queue even if event already scheduled
+                                but not before the specified time
+        sim_activate_after      add entry to event queue after a specified amount of wall time
+        sim_cancel              remove entry from event queue
+        sim_process_event       process entries on event queue
+        sim_is_active           see if entry is on event queue
+        sim_activate_time       return time until activation
+        sim_atime               return absolute time for an entry
+        sim_gtime               return global time
+        sim_qcount              return event queue entry count
+
+   Asynchronous events are set up by queueing a unit data structure
+   to the event queue with a timeout (in simulator units, relative
+   to the current time).  Each simulator 'times' these events by
+   counting down interval counter sim_interval.  When this reaches
+   zero the simulator calls sim_process_event to process the event
+   and to see if further events need to be processed, or sim_interval
+   reset to count the next one.
+
+   The event queue is maintained in clock order; entry timeouts are
+   RELATIVE to the time in the previous entry.
+
+   sim_process_event - process event
+
+   Inputs:
+        none
+   Outputs:
+        reason  =       reason code returned by any event processor,
+                        or 0 (SCPE_OK) if no exceptions
+*/
+
+t_stat sim_process_event (void)
+{
+UNIT *uptr;
+t_stat reason, bare_reason;
+int32 sim_interval_catchup;
+
+if (stop_cpu) {                                         /* stop CPU? */
+    stop_cpu = FALSE;
+    return SCPE_STOP;
+    }
+AIO_UPDATE_QUEUE;
+UPDATE_SIM_TIME;                                        /* update sim time */
+if (sim_interval > 0) {
+    sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Interval not yet expired: %d\n", sim_interval);
+    return SCPE_OK;
+    }
+if (sim_clock_queue == QUEUE_LIST_END) {                /* queue empty? */
+    sim_interval = noqueue_time = NOQUEUE_WAIT;         /* flag queue empty */
+    sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Queue Empty New Interval = %d\n", sim_interval);
+    return SCPE_OK;
+    }
+sim_processing_event = TRUE;
+/* If sim_interval is negative, we've missed the opportunity to  */
+/* dispatch one or more events when they were scheduled to fire. */
+/* To accomodate this, we backup time to when the first event    */
+/* was supposed to fire and advance it from there until things   */
+/* have caught up.                                               */
+if (sim_interval < 0) {
+    sim_interval_catchup = sim_interval;
+    sim_interval = 0;
+    UPDATE_SIM_TIME;                          /* update sim time */
+    sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "Processing event for %s with sim_interval = %d, event time = %.0f\n",
+        sim_uname (sim_clock_queue), sim_interval_catchup, sim_gtime ());
+    if (1) {
+        int32 next_delay;
+        UNIT *next_uptr = _sim_queue_following (&next_delay);
+
+        if (next_uptr != QUEUE_LIST_END)
+            sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "- Next event for %s after = %d\n",
+                sim_uname (next_uptr), next_delay);
+        }
+    sim_time -= sim_clock_queue->time;
+    sim_rtime -= sim_clock_queue->time;
+    }
+else
+    sim_interval_catchup = 0;
+do {
+    uptr = _sim_queue_pop ();                           /* remove first */
     uptr->time = 0;
     if (sim_clock_queue != QUEUE_LIST_END) {
         if (sim_interval_catchup < 0)
@@ -12161,9 +13150,6 @@ return _sim_activate (uptr, event_time);
 
 t_stat _sim_activate (UNIT *uptr, int32 event_time)
 {
-UNIT *cptr, *prvptr;
-int32 accum;
-
 AIO_ACTIVATE (_sim_activate, uptr, event_time);
 if (sim_is_active (uptr))                               /* already active? */
     return SCPE_OK;
@@ -12171,25 +13157,7 @@ UPDATE_SIM_TIME;                                        /* update sim time */
 
 sim_debug (SIM_DBG_ACTIVATE, &sim_scp_dev, "Activating %s delay=%d\n", sim_uname (uptr), event_time);
 
-prvptr = NULL;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (event_time < (accum + cptr->time))
-        break;
-    accum = accum + cptr->time;
-    prvptr = cptr;
-    }
-if (prvptr == NULL) {                                   /* insert at head */
-    cptr = uptr->next = sim_clock_queue;
-    sim_clock_queue = uptr;
-    }
-else {
-    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
-    prvptr->next = uptr;
-    }
-uptr->time = event_time - accum;
-if (cptr != QUEUE_LIST_END)
-    cptr->time = cptr->time - uptr->time;
+_sim_queue_insert (uptr, event_time);
 sim_interval = sim_clock_queue->time;
 return SCPE_OK;
 }
@@ -12289,8 +13257,6 @@ return sim_timer_activate_after (uptr, usec_delay);
 
 t_stat sim_cancel (UNIT *uptr)
 {
-UNIT *cptr, *nptr;
-
 AIO_VALIDATE(uptr);
 if ((uptr->cancel) && uptr->cancel (uptr))
     return SCPE_OK;
@@ -12304,25 +13270,7 @@ if (!sim_is_active (uptr))
     return SCPE_OK;
 UPDATE_SIM_TIME;                                        /* update sim time */
 sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Canceling Event for %s\n", sim_uname(uptr));
-nptr = QUEUE_LIST_END;
-
-if (sim_clock_queue == uptr) {
-    nptr = sim_clock_queue = uptr->next;
-    uptr->next = NULL;                                  /* hygiene */
-    }
-else {
-    for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-        if (cptr->next == uptr) {
-            nptr = cptr->next = uptr->next;
-            uptr->next = NULL;                          /* hygiene */
-            break;                                      /* end queue scan */
-            }
-        }
-    }
-if (nptr != QUEUE_LIST_END)
-    nptr->time += (uptr->next) ? 0 : uptr->time;
-if (!uptr->next)
-    uptr->time = 0;
+_sim_queue_remove (uptr);
 uptr->usecs_remaining = 0;
 if (sim_clock_queue != QUEUE_LIST_END)
     sim_interval = sim_clock_queue->time;
@@ -12362,21 +13310,14 @@ return (((uptr->next) || AIO_IS_ACTIVE(uptr) || ((uptr->dynflags & UNIT_TMR_UNIT
 
 int32 _sim_activate_queue_time (UNIT *uptr)
 {
-UNIT *cptr;
 int32 accum;
 
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return accum + 1;
-    }
-return 0;
+accum = _sim_queue_offset (uptr);
+if (accum < 0)
+    return 0;
+if (sim_interval > 0)
+    accum = accum + sim_interval;
+return accum + 1;
 }
 
 int32 _sim_activate_time (UNIT *uptr)
@@ -12401,7 +13342,6 @@ return _sim_activate_time (uptr);
 
 double sim_activate_time_usecs (UNIT *uptr)
 {
-UNIT *cptr;
 int32 accum;
 double result;
 
@@ -12409,17 +13349,9 @@ AIO_VALIDATE(uptr);
 result = sim_timer_activate_time_usecs (uptr);
 if (result >= 0)
     return result;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return 1.0 + uptr->usecs_remaining + ((1000000.0 * accum) / sim_timer_inst_per_sec ());
-    }
+accum = _sim_activate_queue_time (uptr);
+if (accum)
+    return 1.0 + uptr->usecs_remaining + ((1000000.0 * (accum - 1)) / sim_timer_inst_per_sec ());
 return 0.0;
 }
 
@@ -12457,6 +13389,8 @@ int32 sim_qcount (void)
 int32 cnt;
 UNIT *uptr;
 
+if (sim_queue_engine == SIM_QUEUE_HEAP)
+    return sim_queue_heap_count;
 cnt = 0;
 for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next)
     cnt++;
@@ -12482,6 +13416,12 @@ return cnt;
    is the bitwise OR of all the type fields).  A simulator need only check for
    a breakpoint of type X if bit SWMASK('X') is set in sim_brk_summ.
 
+   sim_brk_filter is a bitmap indexed by a hash of the breakpoint addresses.
+   sim_brk_test consults it before searching sim_brk_tab, so testing an
+   address which has no breakpoint costs a single memory reference no matter
+   how many breakpoints are set.  Bits are set as breakpoints are added and
+   the map is rebuilt from the table when breakpoints are removed.
+
    The package contains the following public routines:
 
         sim_brk_init            initialize
@@ -12519,6 +13459,7 @@ sim_brk_tab = (BRKTAB **) realloc (sim_brk_tab, sim_brk_lnt*sizeof (BRKTAB*));
 if (sim_brk_tab == NULL)
     return SCPE_MEM;
 memset (sim_brk_tab, 0, sim_brk_lnt*sizeof (BRKTAB*));
+memset (sim_brk_filter, 0, sizeof (sim_brk_filter));
 sim_brk_ent = sim_brk_ins = 0;
 sim_brk_clract ();
 sim_brk_npc (0);
@@ -12601,8 +13542,10 @@ if ((sim_brk_ins == sim_brk_ent) ||
 bp = (BRKTAB *)calloc (1, sizeof (*bp));
 bp->next = sim_brk_tab[sim_brk_ins];
 sim_brk_tab[sim_brk_ins] = bp;
-if (bp->next == NULL)
+if (bp->next == NULL) {
     sim_brk_ent += 1;
+    sim_brk_filter[SIM_BRK_FLT_IDX (loc) >> 5] |= 1u << (SIM_BRK_FLT_IDX (loc) & 0x1F);
+    }
 bp->addr = loc;
 bp->typ = btyp;
 bp->cnt = 0;
@@ -12689,8 +13632,10 @@ if (sim_brk_tab[sim_brk_ins] == NULL) {                 /* erased entry */
         sim_brk_tab[i] = sim_brk_tab[i+1];
     }
 sim_brk_summ = 0;                                       /* recalc summary */
+memset (sim_brk_filter, 0, sizeof (sim_brk_filter));    /* and address filter */
 for (i = 0; i < sim_brk_ent; i++) {
     bp = sim_brk_tab[i];
+    sim_brk_filter[SIM_BRK_FLT_IDX (bp->addr) >> 5] |= 1u << (SIM_BRK_FLT_IDX (bp->addr) & 0x1F);
     while (bp) {
         sim_brk_summ |= (bp->typ & ~BRK_TYP_TEMP);
         bp = bp->next;
@@ -12833,8 +13778,12 @@ return SCPE_OK;
 uint32 sim_brk_test (t_addr loc, uint32 btyp)
 {
 BRKTAB *bp;
-uint32 spc = (btyp >> SIM_BKPT_V_SPC) & (SIM_BKPT_N_SPC - 1);
+uint32 spc;
+uint32 idx = SIM_BRK_FLT_IDX (loc);
 
+if ((sim_brk_filter[idx >> 5] & (1u << (idx & 0x1F))) == 0)    /* no bpt here? */
+    return 0;
+spc = (btyp >> SIM_BKPT_V_SPC) & (SIM_BKPT_N_SPC - 1);
 if (sim_brk_summ & BRK_TYP_DYN_ALL)
     btyp |= BRK_TYP_DYN_ALL;
 
@@ -13899,10 +14848,190 @@ while (len > 0) {
     }
 }
 
+/* Debug writer thread (SET DEBUG -W)
+
+   Debug output is copied into a ring buffer and written to sim_deb by a
+   separate thread, so the simulator doesn't wait for file I/O.  Producers
+   are already serialized by sim_debug_io_lock, so the ring has a single
+   producer and a single consumer and is coordinated only by the head and
+   tail counters.  When the ring is full, output is dropped and counted
+   rather than stalling the simulator.
+*/
+
+#define DEB_RING_SIZE   (8*1024*1024)                   /* power of 2 */
+
+#if defined (SIM_ASYNCH_IO)
+static struct {
+    char                *buf;
+    size_t              size;
+    sim_atomic_t        head;                           /* producer position */
+    sim_atomic_t        tail;                           /* consumer position */
+    sim_atomic_t        stop;
+    sim_atomic_t        idle;                           /* writer waiting for output */
+    t_uint64            written;                        /* bytes accepted */
+    t_uint64            dropped;                        /* bytes dropped */
+    t_uint64            dropped_writes;                 /* writes dropped */
+    size_t              high_water;                     /* max bytes in ring */
+    pthread_t           thread;
+    pthread_mutex_t     lock;
+    pthread_cond_t      wake;
+    } deb_ring;
+
+static size_t _debug_ring_used (void)
+{
+return (size_t)((unsigned long)sim_load_atomic (&deb_ring.head) - (unsigned long)sim_load_atomic (&deb_ring.tail));
+}
+
+static void *_debug_ring_writer (void *arg)
+{
+size_t tail, used, off, chunk;
+t_bool flushed = TRUE;
+
+sim_os_set_thread_priority (PRIORITY_BELOW_NORMAL);
+while (1) {
+    used = _debug_ring_used ();
+    if (used == 0) {
+        struct timespec deadline;
+
+        if (sim_load_atomic (&deb_ring.stop))
+            break;
+        if (!flushed) {                                 /* caught up? */
+            fflush (sim_deb);
+            flushed = TRUE;
+            }
+        clock_gettime (CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 10000000;                   /* collect output for 10ms */
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_nsec -= 1000000000;
+            ++deadline.tv_sec;
+            }
+        pthread_mutex_lock (&deb_ring.lock);
+        sim_store_atomic (&deb_ring.idle, 1);
+        if (_debug_ring_used () == 0)
+            pthread_cond_timedwait (&deb_ring.wake, &deb_ring.lock, &deadline);
+        sim_store_atomic (&deb_ring.idle, 0);
+        pthread_mutex_unlock (&deb_ring.lock);
+        continue;
+        }
+    tail = (size_t)(unsigned long)sim_load_atomic (&deb_ring.tail);
+    off = tail & (deb_ring.size - 1);
+    chunk = MIN (used, deb_ring.size - off);
+    _debug_fwrite_all (deb_ring.buf + off, chunk, sim_deb);
+    sim_store_atomic (&deb_ring.tail, (sim_atomic_value_t)(tail + chunk));
+    flushed = FALSE;
+    }
+return NULL;
+}
+
+static void _debug_ring_put (const char *buf, size_t len)
+{
+size_t head = (size_t)(unsigned long)sim_load_atomic (&deb_ring.head);
+size_t used = _debug_ring_used ();
+size_t off, chunk;
+
+if (len > deb_ring.size - used) {                       /* full? */
+    deb_ring.dropped += len;
+    ++deb_ring.dropped_writes;
+    return;
+    }
+deb_ring.written += len;
+if (used + len > deb_ring.high_water)
+    deb_ring.high_water = used + len;
+off = head & (deb_ring.size - 1);
+chunk = MIN (len, deb_ring.size - off);
+memcpy (deb_ring.buf + off, buf, chunk);
+memcpy (deb_ring.buf, buf + chunk, len - chunk);
+sim_store_atomic (&deb_ring.head, (sim_atomic_value_t)(head + len));
+if ((used + len > deb_ring.size / 2) &&                 /* filling up and */
+    sim_load_atomic (&deb_ring.idle))                   /* writer waiting? */
+    pthread_cond_signal (&deb_ring.wake);
+}
+
+/* Wait for the writer to empty the ring */
+
+static void _debug_ring_drain (void)
+{
+while ((deb_ring.buf != NULL) && (_debug_ring_used () != 0)) {
+    pthread_cond_signal (&deb_ring.wake);
+    sim_os_ms_sleep (1);
+    }
+}
+#endif
+
+t_stat sim_debug_writer_start (void)
+{
+#if defined (SIM_ASYNCH_IO)
+if (deb_ring.buf != NULL)
+    return SCPE_OK;
+if ((deb_ring.buf = (char *)malloc (DEB_RING_SIZE)) == NULL)
+    return SCPE_MEM;
+deb_ring.size = DEB_RING_SIZE;
+sim_store_atomic (&deb_ring.head, 0);
+sim_store_atomic (&deb_ring.tail, 0);
+sim_store_atomic (&deb_ring.stop, 0);
+sim_store_atomic (&deb_ring.idle, 0);
+deb_ring.written = deb_ring.dropped = deb_ring.dropped_writes = 0;
+deb_ring.high_water = 0;
+pthread_mutex_init (&deb_ring.lock, NULL);
+pthread_cond_init (&deb_ring.wake, NULL);
+if (pthread_create (&deb_ring.thread, NULL, _debug_ring_writer, NULL)) {
+    pthread_cond_destroy (&deb_ring.wake);
+    pthread_mutex_destroy (&deb_ring.lock);
+    free (deb_ring.buf);
+    deb_ring.buf = NULL;
+    return sim_messagef (SCPE_IERR, "Can't start debug writer thread\n");
+    }
+return SCPE_OK;
+#else
+return sim_messagef (SCPE_NOFNC, "Debug writer thread requires asynchronous I/O support\n");
+#endif
+}
+
+void sim_debug_writer_stop (void)
+{
+#if defined (SIM_ASYNCH_IO)
+char msg[128];
+
+if (deb_ring.buf == NULL)
+    return;
+_sim_debug_flush ();                                    /* pending filtered line, then drain */
+sim_store_atomic (&deb_ring.stop, 1);
+pthread_cond_signal (&deb_ring.wake);
+pthread_join (deb_ring.thread, NULL);
+pthread_cond_destroy (&deb_ring.wake);
+pthread_mutex_destroy (&deb_ring.lock);
+free (deb_ring.buf);
+deb_ring.buf = NULL;
+if (deb_ring.dropped_writes) {
+    snprintf (msg, sizeof (msg), "Debug writer dropped %" T_UINT64_FMT "u writes (%" T_UINT64_FMT "u bytes)\r\n",
+              deb_ring.dropped_writes, deb_ring.dropped);
+    _debug_fwrite_all (msg, strlen (msg), sim_deb);
+    }
+#endif
+}
+
+void sim_debug_writer_show (FILE *st)
+{
+#if defined (SIM_ASYNCH_IO)
+if (deb_ring.buf == NULL)
+    return;
+fprintf (st, "   Debug messages are written by a separate thread through a %u MB ring\n",
+              (unsigned int)(deb_ring.size / (1024 * 1024)));
+fprintf (st, "      %" T_UINT64_FMT "u bytes written, %" T_UINT64_FMT "u writes (%" T_UINT64_FMT "u bytes) dropped, %u KB maximum queued\n",
+              deb_ring.written, deb_ring.dropped_writes, deb_ring.dropped, (unsigned int)(deb_ring.high_water / 1024));
+#endif
+}
+
 static void _debug_fwrite (const char *buf, size_t len)
 {
 size_t move_size;
 
+#if defined (SIM_ASYNCH_IO)
+if (deb_ring.buf != NULL) {
+    _debug_ring_put (buf, len);
+    return;
+    }
+#endif
 if (sim_deb_buffer == NULL) {
     _debug_fwrite_all (buf, len, sim_deb);  /* output now. */
     return;
@@ -13934,8 +15063,11 @@ static void _sim_debug_write_flush (const char *buf, size_t len, t_bool flush)
 char *eol;
 
 if (sim_deb_switches & SWMASK ('F')) {              /* filtering disabled? */
-    if (len > 0)
+    if (len > 0) {
+        AIO_DEBUG_IO_ACTIVE;
         _debug_fwrite (buf, len);                   /* output now. */
+        AIO_DEBUG_IO_DONE;
+        }
     return;                                         /* done */
     }
 
@@ -14038,6 +15170,9 @@ if (sim_deb == NULL)                                    /* no debug? */
     return SCPE_OK;
 
 _sim_debug_write_flush ("", 0, TRUE);
+#if defined (SIM_ASYNCH_IO)
+_debug_ring_drain ();
+#endif
 fflush (sim_deb);
 fsync(fileno(sim_deb));
 
@@ -16763,6 +17898,492 @@ sim_set_deb_switches (start_deb_switches);
 return r;
 }
 
+/* Event queue engine tests.  A pseudo random mix of activations and
+   cancellations (including activations and cancellations performed by
+   event service routines) must fire in exactly the same order and at
+   the same times with each queue engine.  Per operation timings of both
+   engines are reported when the tests are run with TESTLIB -D. */
+
+#define QTEST_UNITS     64
+#define QTEST_EVENTS    5000
+
+static UNIT *qtest_units;
+static uint32 qtest_seed;
+static int32 qtest_fired;
+static int32 qtest_log_count;
+static double *qtest_log;
+
+static uint32 qtest_random (void)
+{
+qtest_seed = qtest_seed * 1103515245 + 12345;
+return (qtest_seed >> 8) & 0xFFFFFF;
+}
+
+static t_stat qtest_svc (UNIT *uptr)
+{
+int32 idx = (int32)(uptr - qtest_units);
+uint32 r = qtest_random ();
+
+if (qtest_log_count < 2 * QTEST_EVENTS) {
+    qtest_log[qtest_log_count++] = idx;
+    qtest_log[qtest_log_count++] = sim_gtime ();
+    }
+if (++qtest_fired >= QTEST_EVENTS)
+    return SCPE_OK;
+sim_activate (uptr, r % 97);                            /* reschedule self */
+if ((r & 3) == 0)                                       /* sometimes cancel another */
+    sim_cancel (&qtest_units[(r >> 4) % QTEST_UNITS]);
+else                                                    /* or schedule another */
+    sim_activate_abs (&qtest_units[(r >> 4) % QTEST_UNITS], (r >> 10) % 31);
+return SCPE_OK;
+}
+
+static t_stat qtest_run (int32 engine, double *log)
+{
+int32 i;
+
+while (sim_clock_queue != QUEUE_LIST_END)
+    sim_cancel (sim_clock_queue);
+_sim_queue_set_engine (engine);
+sim_time = sim_rtime = 0;
+noqueue_time = sim_interval = 0;
+qtest_seed = 1;
+qtest_fired = 0;
+qtest_log_count = 0;
+qtest_log = log;
+for (i = 0; i < QTEST_UNITS; i++) {
+    qtest_units[i].action = &qtest_svc;
+    sim_activate (&qtest_units[i], qtest_random () % 50);
+    }
+for (i = 0; (sim_clock_queue != QUEUE_LIST_END) && (qtest_fired < QTEST_EVENTS); i++) {
+    sim_interval = (i & 1) ? 0 : -(int32)(qtest_random () % 5); /* sometimes run late */
+    sim_process_event ();
+    }
+while (sim_clock_queue != QUEUE_LIST_END)
+    sim_cancel (sim_clock_queue);
+return (qtest_fired >= QTEST_EVENTS) ? SCPE_OK : SCPE_IERR;
+}
+
+/* Event queue micro-benchmark: activate and then cancel N units with
+   pseudo random delays, reporting the cost per operation for each engine */
+
+static void qtest_benchmark (int32 engine, int32 nunits)
+{
+int32 i, round, rounds = 400000 / nunits;
+uint32 start_ms, elapsed_ms;
+UNIT *units = (UNIT *)calloc (nunits, sizeof (*units));
+
+if (units == NULL)
+    return;
+_sim_queue_set_engine (engine);
+qtest_seed = 1;
+start_ms = sim_os_msec ();
+for (round = 0; round < rounds; round++) {
+    for (i = 0; i < nunits; i++)
+        sim_activate (&units[i], qtest_random () % 100000);
+    for (i = 0; i < nunits; i++)
+        sim_cancel (&units[(i * 7919) % nunits]);
+    }
+elapsed_ms = sim_os_msec () - start_ms;
+sim_printf ("  %s engine, %5d units: %8.1f nsec per activate/cancel pair\n",
+            sim_queue_engine_names[engine], nunits,
+            (1000000.0 * elapsed_ms) / ((double)rounds * nunits));
+free (units);
+}
+
+static t_stat test_scp_event_queue_engines (void)
+{
+int32 saved_engine = sim_queue_engine;
+double *list_log = (double *)calloc (2 * QTEST_EVENTS, sizeof (*list_log));
+double *heap_log = (double *)calloc (2 * QTEST_EVENTS, sizeof (*heap_log));
+t_stat r = SCPE_OK;
+int32 i;
+
+qtest_units = (UNIT *)calloc (QTEST_UNITS, sizeof (*qtest_units));
+if ((list_log == NULL) || (heap_log == NULL) || (qtest_units == NULL)) {
+    free (list_log);
+    free (heap_log);
+    free (qtest_units);
+    return SCPE_MEM;
+    }
+if ((qtest_run (SIM_QUEUE_LIST, list_log) != SCPE_OK) ||
+    (qtest_run (SIM_QUEUE_HEAP, heap_log) != SCPE_OK))
+    r = sim_messagef (SCPE_IERR, "Event queue engine test did not dispatch %d events\n", QTEST_EVENTS);
+for (i = 0; (r == SCPE_OK) && (i < 2 * QTEST_EVENTS); i += 2) {
+    if ((list_log[i] != heap_log[i]) || (list_log[i + 1] != heap_log[i + 1]))
+        r = sim_messagef (SCPE_IERR, "Event %d differs between engines: LIST unit %.0f at %.0f, HEAP unit %.0f at %.0f\n",
+                          i / 2, list_log[i], list_log[i + 1], heap_log[i], heap_log[i + 1]);
+    }
+if (r == SCPE_OK) {
+    sim_printf ("Event queue engines dispatched %d identical events\n", QTEST_EVENTS);
+    _sim_queue_set_engine (SIM_QUEUE_HEAP);
+    r = test_scp_event_sequencing ();
+    }
+if ((r == SCPE_OK) && (sim_deb != NULL)) {             /* timings only when debugging */
+    for (i = 16; i <= 4096; i *= 16) {
+        qtest_benchmark (SIM_QUEUE_LIST, i);
+        qtest_benchmark (SIM_QUEUE_HEAP, i);
+        }
+    }
+_sim_queue_set_engine (saved_engine);
+free (list_log);
+free (heap_log);
+free (qtest_units);
+qtest_units = NULL;
+return r;
+}
+
+/* Breakpoint lookup tests.  Breakpoints are set at scattered addresses and a
+   range of addresses is swept with sim_brk_test, checking that exactly the
+   breakpoint addresses match as breakpoints are set and cleared.  With
+   TESTLIB -D the sweep is then timed with 0, 10 and 1000 breakpoints set,
+   which is the per instruction cost a simulator pays when sim_brk_summ is
+   non-zero, along with the cost of the table search alone. */
+
+#define BTEST_RANGE     0x40000                         /* addresses swept */
+
+static t_addr btest_addr (int32 i)
+{
+return (t_addr)((i * 7919 + 4243) % BTEST_RANGE);
+}
+
+static int32 btest_sweep (uint32 typ)
+{
+t_addr loc;
+int32 hits = 0;
+
+for (loc = 0; loc < BTEST_RANGE; loc++)
+    if (sim_brk_test (loc, typ))
+        ++hits;
+sim_time += 1.0;                                        /* allow bpts to fire again */
+return hits;
+}
+
+static t_stat test_scp_breakpoints (void)
+{
+uint32 typ = sim_brk_dflt ? sim_brk_dflt : (sim_brk_types & (~sim_brk_types + 1));
+uint32 saved_summ = sim_brk_summ;
+double saved_time = sim_time;
+static const int32 nbkpts[] = {0, 10, 1000};
+int32 i, j, hits;
+t_stat r = SCPE_OK;
+
+if ((typ == 0) || (sim_brk_ent != 0)) {
+    sim_printf ("Breakpoint tests skipped: %s\n", typ ? "breakpoints are set" : "no breakpoint types");
+    return SCPE_OK;
+    }
+for (i = 0; (r == SCPE_OK) && (i < 1000); i++)
+    r = sim_brk_set (btest_addr (i), typ, 0, NULL);
+if ((r == SCPE_OK) && ((hits = btest_sweep (typ)) != 1000))
+    r = sim_messagef (SCPE_IERR, "Breakpoint sweep matched %d addresses, expected 1000\n", hits);
+for (i = 0; (r == SCPE_OK) && (i < 1000); i += 2)
+    r = sim_brk_clr (btest_addr (i), typ);
+if ((r == SCPE_OK) && ((hits = btest_sweep (typ)) != 500))
+    r = sim_messagef (SCPE_IERR, "Breakpoint sweep matched %d addresses after clearing 500, expected 500\n", hits);
+sim_brk_clrall (SIM_BRK_ALLTYP);
+if ((r == SCPE_OK) && ((sim_brk_ent != 0) || ((hits = btest_sweep (typ)) != 0)))
+    r = sim_messagef (SCPE_IERR, "Breakpoints remain after clearing all\n");
+if (r == SCPE_OK)
+    sim_printf ("Breakpoint set/clear/test checks passed\n");
+for (j = 0; (r == SCPE_OK) && (j < (int32)(sizeof (nbkpts) / sizeof (nbkpts[0]))); j++) {
+    uint32 start_ms, test_ms, fnd_ms;
+    int32 rounds = (sim_deb != NULL) ? 40 : 1;         /* timed only when debugging */
+    t_addr loc;
+
+    for (i = 0; i < nbkpts[j]; i++)                     /* bpts outside the swept range */
+        sim_brk_set (BTEST_RANGE + btest_addr (i), typ, 0, NULL);
+    sim_brk_summ |= typ;                                /* simulator would test even with none */
+    start_ms = sim_os_msec ();
+    for (i = 0; i < rounds; i++)
+        btest_sweep (typ);
+    test_ms = sim_os_msec () - start_ms;
+    start_ms = sim_os_msec ();
+    for (i = 0; i < rounds; i++)
+        for (loc = 0; loc < BTEST_RANGE; loc++)
+            if (sim_brk_fnd_ex (loc, typ, TRUE, 0))
+                r = SCPE_IERR;
+    fnd_ms = sim_os_msec () - start_ms;
+    if (sim_deb != NULL)
+        sim_printf ("  %4d breakpoints: sim_brk_test %8.1f M/sec, table search only %8.1f M/sec\n", nbkpts[j],
+                    ((double)rounds * BTEST_RANGE) / (1000.0 * (test_ms ? test_ms : 1)),
+                    ((double)rounds * BTEST_RANGE) / (1000.0 * (fnd_ms ? fnd_ms : 1)));
+    sim_brk_clrall (SIM_BRK_ALLTYP);
+    }
+sim_brk_summ = saved_summ;
+sim_time = saved_time;
+return r;
+}
+
+/* Check the sim_fio byte swapping and 36 bit packing routines against
+   element at a time reference conversions and, with TESTLIB -D, report
+   their throughput */
+
+#define XTEST_BYTES     (8*1024*1024)
+
+static void xtest_ref_pack_36 (uint8 *b, const t_uint64 *w, size_t count, t_bool big_endian)
+{
+size_t i;
+
+for (i = 0; i < count; i += 2, b += 9) {
+    if (big_endian) {
+        b[0] = (uint8)(w[i] >> 28); b[1] = (uint8)(w[i] >> 20); b[2] = (uint8)(w[i] >> 12); b[3] = (uint8)(w[i] >> 4);
+        b[4] = (uint8)(((w[i] & 0xF) << 4) | ((w[i + 1] >> 32) & 0xF));
+        b[5] = (uint8)(w[i + 1] >> 24); b[6] = (uint8)(w[i + 1] >> 16); b[7] = (uint8)(w[i + 1] >> 8); b[8] = (uint8)w[i + 1];
+        }
+    else {
+        b[0] = (uint8)w[i]; b[1] = (uint8)(w[i] >> 8); b[2] = (uint8)(w[i] >> 16); b[3] = (uint8)(w[i] >> 24);
+        b[4] = (uint8)(((w[i] >> 32) & 0xF) | ((w[i + 1] << 4) & 0xF0));
+        b[5] = (uint8)(w[i + 1] >> 4); b[6] = (uint8)(w[i + 1] >> 12); b[7] = (uint8)(w[i + 1] >> 20); b[8] = (uint8)(w[i + 1] >> 28);
+        }
+    }
+}
+
+static t_stat test_scp_data_transforms (void)
+{
+static const size_t sizes[] = {2, 3, 4, 6, 8};
+uint8 *buf = (uint8 *)malloc (XTEST_BYTES);
+uint8 *ref = (uint8 *)malloc (XTEST_BYTES);
+t_uint64 *words = (t_uint64 *)malloc (XTEST_BYTES);
+t_uint64 *back = (t_uint64 *)malloc (XTEST_BYTES);
+size_t nwords = XTEST_BYTES / 9;
+size_t i, k, s;
+t_bool saved_end = sim_end;
+uint32 start_ms, ms;
+int be;
+t_stat r = SCPE_OK;
+
+if ((buf == NULL) || (ref == NULL) || (words == NULL) || (back == NULL)) {
+    free (buf); free (ref); free (words); free (back);
+    return SCPE_MEM;
+    }
+sim_printf ("Data transform tests\n");
+for (i = 0; i < XTEST_BYTES; i++)
+    ref[i] = (uint8)(i * 7 + (i >> 8));
+sim_end = FALSE;                                /* force swapping as on a big endian host */
+for (s = 0; (r == SCPE_OK) && (s < sizeof (sizes) / sizeof (sizes[0])); s++) {
+    size_t count = (4096 / sizes[s]) + 1;
+
+    memcpy (buf, ref + 1, count * sizes[s]);
+    sim_byte_swap_data (buf, sizes[s], count);
+    for (i = 0; (r == SCPE_OK) && (i < count); i++)
+        for (k = 0; k < sizes[s]; k++)
+            if (buf[i * sizes[s] + k] != ref[1 + i * sizes[s] + sizes[s] - 1 - k]) {
+                r = sim_messagef (SCPE_IERR, "sim_byte_swap_data size %d element %d is wrong\n", (int)sizes[s], (int)i);
+                break;
+                }
+    sim_buf_copy_swapped (buf + count * sizes[s], buf, sizes[s], count);
+    if ((r == SCPE_OK) && memcmp (buf + count * sizes[s], ref + 1, count * sizes[s]))
+        r = sim_messagef (SCPE_IERR, "sim_buf_copy_swapped size %d didn't restore the data\n", (int)sizes[s]);
+    }
+if ((r == SCPE_OK) && (sim_deb != NULL)) {             /* timings only when debugging */
+    memcpy (buf, ref, XTEST_BYTES);
+    start_ms = sim_os_msec ();
+    for (i = 0; i < 8; i++)
+        sim_byte_swap_data (buf, sizeof (uint32), XTEST_BYTES / sizeof (uint32));
+    ms = sim_os_msec () - start_ms;
+    sim_printf ("  byte swap (32 bit elements): %8.1f MB/sec\n", (8.0 * XTEST_BYTES) / (1000.0 * (ms ? ms : 1)));
+    }
+sim_end = saved_end;
+nwords &= ~((size_t)1);
+for (i = 0; i < nwords; i++)
+    words[i] = ((((t_uint64)ref[i % 4096]) << 28) ^ (((t_uint64)i) * 2654435761u)) & ((((t_uint64)1) << 36) - 1);
+for (be = 0; (r == SCPE_OK) && (be < 2); be++) {
+    xtest_ref_pack_36 (ref, words, nwords, be);
+    sim_buf_pack_36 (buf, words, nwords, be);
+    if (memcmp (buf, ref, (nwords / 2) * 9))
+        r = sim_messagef (SCPE_IERR, "sim_buf_pack_36 %s endian result is wrong\n", be ? "big" : "little");
+    sim_buf_unpack_36 (back, buf, nwords, be);
+    if ((r == SCPE_OK) && memcmp (back, words, nwords * sizeof (*words)))
+        r = sim_messagef (SCPE_IERR, "sim_buf_unpack_36 %s endian result is wrong\n", be ? "big" : "little");
+    if ((r == SCPE_OK) && (sim_deb != NULL)) {
+        uint32 pack_ms;
+
+        start_ms = sim_os_msec ();
+        for (i = 0; i < 8; i++)
+            sim_buf_pack_36 (buf, words, nwords, be);
+        pack_ms = sim_os_msec () - start_ms;
+        start_ms = sim_os_msec ();
+        for (i = 0; i < 8; i++)
+            sim_buf_unpack_36 (back, buf, nwords, be);
+        ms = sim_os_msec () - start_ms;
+        sim_printf ("  36 bit %s endian: pack %8.1f M words/sec, unpack %8.1f M words/sec\n", be ? "big" : "little",
+                    (8.0 * nwords) / (1000.0 * (pack_ms ? pack_ms : 1)), (8.0 * nwords) / (1000.0 * (ms ? ms : 1)));
+        }
+    }
+free (buf);
+free (ref);
+free (words);
+free (back);
+return r;
+}
+
+/* SAVE -I, -Z and -B round trips through RESTORE, using a few words
+   spread through the first memory-like unit */
+
+#define SAVE_TEST_WORDS 8
+
+static t_stat save_test_op (t_bool save, const char *args)
+{
+sim_switches = 0;
+return save ? save_cmd (0, args) : restore_cmd (0, args);
+}
+
+static t_value save_test_value (DEVICE *dptr, uint32 state, uint32 i)
+{
+t_value mask = (dptr->dwidth < 32) ? ((((t_value)1) << dptr->dwidth) - 1) : 0xFFFFFFFF;
+
+return ((t_value)(state * 0x1357 + i * 0x2469 + 1)) & mask;
+}
+
+static t_stat save_test_set (DEVICE *dptr, const t_addr *addrs, uint32 state)
+{
+uint32 i;
+t_stat r = SCPE_OK;
+
+for (i = 0; (r == SCPE_OK) && (i < SAVE_TEST_WORDS); i++)
+    r = dptr->deposit (save_test_value (dptr, state, i), addrs[i], dptr->units, 0);
+return r;
+}
+
+static t_stat save_test_check (DEVICE *dptr, const t_addr *addrs, uint32 state, const char *file)
+{
+uint32 i;
+t_value val;
+t_stat r = SCPE_OK;
+
+for (i = 0; (r == SCPE_OK) && (i < SAVE_TEST_WORDS); i++) {
+    r = dptr->examine (&val, addrs[i], dptr->units, 0);
+    if ((r == SCPE_OK) && (val != save_test_value (dptr, state, i)))
+        r = sim_messagef (SCPE_IERR, "RESTORE %s gave the wrong contents for word %u\n", file, i);
+    }
+return r;
+}
+
+static t_stat test_scp_save_restore (void)
+{
+DEVICE *dptr = NULL;
+t_addr addrs[SAVE_TEST_WORDS];
+char name[CBUFSIZE];
+int32 saved_switches = sim_switches;
+uint32 i;
+t_stat r;
+
+sim_printf ("SAVE and RESTORE tests\n");
+for (i = 0; sim_devices[i] != NULL; i++) {
+    UNIT *uptr = sim_devices[i]->units;
+
+    if ((sim_devices[i]->numunits > 0) &&
+        ((uptr->flags & (UNIT_FIX + UNIT_ATTABLE)) == UNIT_FIX) &&
+        (uptr->capac != 0) &&
+        (sim_devices[i]->examine != NULL) && (sim_devices[i]->deposit != NULL) &&
+        !(sim_devices[i]->flags & DEV_NOSAVE)) {
+        dptr = sim_devices[i];
+        break;
+        }
+    }
+if (dptr == NULL) {
+    sim_printf ("  skipped, no memory unit to save\n");
+    return SCPE_OK;
+    }
+for (i = 0; i < SAVE_TEST_WORDS; i++)
+    addrs[i] = ((dptr->units->capac / dptr->aincr) / SAVE_TEST_WORDS) * i * dptr->aincr;
+/* A full save followed by two incremental ones */
+r = save_test_set (dptr, addrs, 0);
+if (r == SCPE_OK)
+    r = save_test_op (TRUE, "Test-Save-0.sav");
+if (r == SCPE_OK)
+    r = save_test_set (dptr, addrs, 1);
+if (r == SCPE_OK)
+    r = save_test_op (TRUE, "-I Test-Save-1.sav");
+if (r == SCPE_OK)
+    r = save_test_set (dptr, addrs, 2);
+#if defined(HAVE_ZLIB)
+if (r == SCPE_OK)
+    r = save_test_op (TRUE, "-I -Z Test-Save-2.sav");
+#else
+if (r == SCPE_OK)
+    r = save_test_op (TRUE, "-I Test-Save-2.sav");
+#endif
+if ((r == SCPE_OK) &&
+    (save_test_op (TRUE, "-I Test-Save-0.sav") == SCPE_OK))
+    r = sim_messagef (SCPE_IERR, "SAVE -I replaced the full save it is based on\n");
+if (r == SCPE_OK)
+    r = save_test_set (dptr, addrs, 9);
+for (i = 1; (r == SCPE_OK) && (i <= 3); i++) {          /* 1, 2, then 0 */
+    sprintf (name, "Test-Save-%u.sav", i % 3);
+    r = save_test_op (FALSE, name);
+    if (r == SCPE_OK)
+        r = save_test_check (dptr, addrs, i % 3, name);
+    }
+#if defined(HAVE_ZLIB)
+/* A compressed full save */
+if (r == SCPE_OK)
+    r = save_test_set (dptr, addrs, 3);
+if (r == SCPE_OK)
+    r = save_test_op (TRUE, "-Z Test-Save-Z.sav");
+if (r == SCPE_OK)
+    r = save_test_set (dptr, addrs, 9);
+if (r == SCPE_OK)
+    r = save_test_op (FALSE, "Test-Save-Z.sav");
+if (r == SCPE_OK)
+    r = save_test_check (dptr, addrs, 3, "Test-Save-Z.sav");
+#endif
+/* The longest chain RESTORE follows, then a fall back to a full save */
+if (r == SCPE_OK)
+    r = save_test_op (TRUE, "Test-Save-0.sav");
+for (i = 1; (r == SCPE_OK) && (i <= SAVE_MAX_CHAIN + 1); i++) {
+    sprintf (name, "-I Test-Save-C%u.sav", i);
+    r = save_test_set (dptr, addrs, i);
+    if (r == SCPE_OK)
+        r = save_test_op (TRUE, name);
+    }
+if ((r == SCPE_OK) && (save_chain_len != 1))
+    r = sim_messagef (SCPE_IERR, "SAVE -I didn't fall back to a full save after %d incremental saves\n", SAVE_MAX_CHAIN);
+for (i = SAVE_MAX_CHAIN; (r == SCPE_OK) && (i <= SAVE_MAX_CHAIN + 1); i++) {
+    sprintf (name, "Test-Save-C%u.sav", i);
+    r = save_test_set (dptr, addrs, 9);
+    if (r == SCPE_OK)
+        r = save_test_op (FALSE, name);
+    if (r == SCPE_OK)
+        r = save_test_check (dptr, addrs, i, name);
+    }
+#if defined(SAVE_BACKGROUND)
+/* Background saves, the second based on the first */
+if (r == SCPE_OK)
+    r = save_test_set (dptr, addrs, 4);
+if (r == SCPE_OK)
+    r = save_test_op (TRUE, "-B Test-Save-B.sav");
+if (r == SCPE_OK)
+    r = save_test_set (dptr, addrs, 5);
+if (r == SCPE_OK)
+    r = save_test_op (TRUE, "-I -B Test-Save-BI.sav");
+if (r == SCPE_OK)
+    r = save_test_set (dptr, addrs, 9);
+if (r == SCPE_OK)
+    r = save_test_op (FALSE, "Test-Save-BI.sav");
+if (r == SCPE_OK)
+    r = save_test_check (dptr, addrs, 5, "Test-Save-BI.sav");
+if (r == SCPE_OK)
+    r = save_test_op (FALSE, "Test-Save-B.sav");
+if (r == SCPE_OK)
+    r = save_test_check (dptr, addrs, 4, "Test-Save-B.sav");
+#endif
+save_bg_wait ();
+for (i = 0; i < 3; i++) {
+    sprintf (name, "Test-Save-%u.sav", i);
+    (void)remove (name);
+    }
+for (i = 1; i <= SAVE_MAX_CHAIN + 1; i++) {
+    sprintf (name, "Test-Save-C%u.sav", i);
+    (void)remove (name);
+    }
+(void)remove ("Test-Save-Z.sav");
+(void)remove ("Test-Save-B.sav");
+(void)remove ("Test-Save-BI.sav");
+sim_switches = saved_switches;
+return r;
+}
+
 static t_stat test_scp_debug_logging()
 {
 uint32 saved_scp_dev_dbits = sim_scp_dev.dctrl;
@@ -16837,8 +18458,16 @@ if ((strcmp (gbuf, "ALL") == 0) || (strcmp (gbuf, "SCP") == 0)) {
         return sim_messagef (SCPE_IERR, "SCP argument parsing test failed\n");
     if (test_scp_event_sequencing () != SCPE_OK)
         return sim_messagef (SCPE_IERR, "SCP event sequencing test failed\n");
+    if (test_scp_event_queue_engines () != SCPE_OK)
+        return sim_messagef (SCPE_IERR, "SCP event queue engine test failed\n");
+    if (test_scp_breakpoints () != SCPE_OK)
+        return sim_messagef (SCPE_IERR, "SCP breakpoint test failed\n");
     if (test_scp_debug_logging () != SCPE_OK)
         return sim_messagef (SCPE_IERR, "SCP debug logging test failed\n");
+    if (test_scp_data_transforms () != SCPE_OK)
+        return sim_messagef (SCPE_IERR, "SCP data transform test failed\n");
+    if (test_scp_save_restore () != SCPE_OK)
+        return sim_messagef (SCPE_IERR, "SCP SAVE and RESTORE test failed\n");
 }
 for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
     t_stat tstat = SCPE_OK;
@@ -2320,7 +2320,7 @@ sim_deb_switches = switches &
                     SWMASK ('T') | SWMASK ('A') |
                     SWMASK ('F') | SWMASK ('N') |
                     SWMASK ('B') | SWMASK ('E') |
-                    SWMASK ('D') );                 /* save debug switches */
+                    SWMASK ('D') | SWMASK ('W') );  /* save debug switches */
 return old_deb_switches;
 }
 
@@ -2335,6 +2335,8 @@ size_t buffer_size = 0;
 
 if ((cptr == NULL) || (*cptr == 0))                     /* need arg */
     return SCPE_2FARG;
+if ((sim_switches & SWMASK ('B')) && (sim_switches & SWMASK ('W')))
+    return sim_messagef (SCPE_ARG, "Debug -B and -W switches are mutually exclusive\n");
 if (sim_switches & SWMASK ('B')) {
     cptr = get_glyph_nc (cptr, gbuf, 0);                /* buffer size */
     buffer_size = (size_t)strtoul (gbuf, NULL, 10);
@@ -2344,6 +2346,7 @@ if (sim_switches & SWMASK ('B')) {
 cptr = get_glyph_nc (cptr, gbuf, 0);                    /* get file name */
 if (*cptr != 0)                                         /* now eol? */
     return SCPE_2MARG;
+sim_debug_writer_stop ();                               /* drain output to any prior file */
 r = sim_open_logfile (gbuf, FALSE, &sim_deb, &sim_deb_ref);
 
 if (r != SCPE_OK)
@@ -2378,6 +2381,13 @@ if (sim_deb_switches & SWMASK ('E'))
 if (sim_deb_switches & SWMASK ('B'))
     sim_messagef (SCPE_OK, "   Debug messages will be written to a %u MB circular memory buffer\n",
                                 (unsigned int)buffer_size);
+if (sim_deb_switches & SWMASK ('W')) {
+    r = sim_debug_writer_start ();
+    if (r != SCPE_OK)
+        sim_deb_switches &= ~SWMASK ('W');
+    else
+        sim_messagef (SCPE_OK, "   Debug messages will be written by a separate thread\n");
+    }
 time(&now);
 if (!sim_quiet) {
     fprintf (sim_deb, "Debug output to \"%s\" at %s", sim_logfile_name (sim_deb, sim_deb_ref), ctime(&now));
@@ -2404,6 +2414,7 @@ if (cptr && (*cptr != 0))                               /* now eol? */
     return SCPE_2MARG;
 if (sim_deb == NULL)                                    /* no debug? */
     return SCPE_OK;
+sim_debug_writer_stop ();                               /* drain queued output */
 if (sim_deb_switches & SWMASK ('B')) {
     size_t offset = (sim_debug_buffer_inuse == sim_deb_buffer_size) ? sim_debug_buffer_offset : 0;
     const char *bufmsg = "Circular Buffer Contents follow here:\n\n";
@@ -2450,6 +2461,7 @@ if (sim_deb) {
         fprintf (st, "   Debug messages are not being filtered to summarize duplicate lines\n");
     if (sim_deb_switches & SWMASK ('E'))
         fprintf (st, "   Debug messages containing blob data in EBCDIC will display in readable form\n");
+    sim_debug_writer_show (st);
     for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
         t_bool unit_debug = FALSE;
         uint32 unit;
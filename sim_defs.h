@@ -688,6 +688,10 @@ struct UNIT {
     char                *uname;                         /* Unit name */
     DEVICE              *dptr;                          /* DEVICE linkage (backpointer) */
     uint32              dctrl;                          /* debug control */
+    int32               q_index;                        /* event queue engine slot */
+    t_int64             q_key;                          /* event queue engine due time */
+    t_uint64            q_seq;                          /* event queue engine insertion order */
+    void                *filemap;                       /* filebuf file mapping (ATTACH -M) */
 #ifdef SIM_ASYNCH_IO
     void                (*a_check_completion)(UNIT *);
     t_bool              (*a_is_active)(UNIT *);
@@ -149,6 +149,35 @@ return value;
 }
 #endif
 
+#if defined SIM_ASYNCH_IO
+/* Asynchronous requests are queued in a per unit ring and performed one
+   at a time, in submission order, by the unit's single I/O thread, so
+   they also complete in submission order.  Requests between ioq_next and
+   ioq_tail are waiting to be performed.  The ring indexes increase
+   monotonically and are reduced modulo DISK_IOQ_DEPTH on use.  A ring
+   slot is freed as soon as its request has been performed, and the
+   request's callback and status move to the completion list, which the
+   simulator thread drains when the unit is activated.  A submitter that
+   finds the ring full therefore only has to wait for the I/O thread. */
+
+#define DISK_IOQ_DEPTH  32                  /* Outstanding asynchronous requests per unit */
+
+struct disk_ioreq {
+    int                 dop;                /* Operation */
+    t_lba               lba;
+    uint8               *buf;
+    t_seccnt            *rsects;
+    t_seccnt            sects;
+    DISK_PCALLBACK      callback;
+    };
+
+struct disk_iodone {
+    int                 dop;                /* Operation */
+    DISK_PCALLBACK      callback;
+    t_stat              status;
+    };
+#endif
+
 struct disk_context {
     t_offset            container_size;     /* Size of the data portion (of the pseudo disk) */
     t_offset            highwater;          /* Furthest written sector in the disk */
@@ -165,6 +194,7 @@ struct disk_context {
     uint32              auto_format;        /* Format determined dynamically */
     uint32              read_count;         /* Number of read operations performed */
     uint32              write_count;        /* Number of write operations performed */
+    uint32              no_holes;           /* Container file system can't punch holes */
     struct simh_disk_footer
                         *footer;
 #if defined _WIN32
@@ -179,13 +209,17 @@ struct disk_context {
     pthread_cond_t      io_cond;
     pthread_cond_t      io_done;
     pthread_cond_t      startup_cond;
-    int                 io_dop;
-    uint8               *buf;
-    t_seccnt            *rsects;
-    t_seccnt            sects;
-    t_lba               lba;
-    DISK_PCALLBACK      callback;
-    t_stat              io_status;
+    int                 io_dop;             /* Operation in progress on the I/O thread */
+    struct disk_ioreq   ioq[DISK_IOQ_DEPTH];/* Asynchronous request ring */
+    uint32              ioq_next;           /* Next request to be performed */
+    uint32              ioq_tail;           /* Next free request slot */
+    uint32              ioq_maxdepth;       /* Most requests outstanding at once */
+    uint32              ioq_full;           /* Submissions which waited for a free slot */
+    t_bool              ioq_hold;           /* I/O thread holds off (queue tests) */
+    struct disk_iodone  *iodone;            /* Completions awaiting callback dispatch */
+    uint32              iodone_head;        /* Next completion to dispatch */
+    uint32              iodone_count;       /* Completions in iodone */
+    uint32              iodone_size;        /* Allocated iodone entries */
 #endif
     };
 
@@ -198,27 +232,8 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;   \
 if ((!callback) || !ctx->asynch_io)
 
 #define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
-    if (ctx->asynch_io) {                                       \
-        struct disk_context *ctx =                              \
-                      (struct disk_context *)uptr->disk_ctx;    \
-                                                                \
-        pthread_mutex_lock (&ctx->io_lock);                     \
-                                                                \
-        sim_debug_unit (ctx->dbit, uptr,                        \
-      "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d)\n",\
-                op, (int)(uptr - ctx->dptr->units), _lba, _sects);\
-                                                                \
-        if (ctx->callback)                                      \
-            abort(); /* horrible mistake, stop */               \
-        ctx->io_dop = op;                                       \
-        ctx->lba = _lba;                                        \
-        ctx->buf = _buf;                                        \
-        ctx->sects = _sects;                                    \
-        ctx->rsects = _rsects;                                  \
-        ctx->callback = _callback;                              \
-        pthread_cond_signal (&ctx->io_cond);                    \
-        pthread_mutex_unlock (&ctx->io_lock);                   \
-        }                                                       \
+    if (ctx->asynch_io)                                         \
+        _disk_io_submit (uptr, op, _lba, _buf, _rsects, _sects, _callback);\
     else                                                        \
         if (_callback)                                          \
             (_callback) (uptr, r);
@@ -229,6 +244,41 @@ if ((!callback) || !ctx->asynch_io)
 #define DOP_WSEC  2             /* sim_disk_wrsect_a */
 #define DOP_IAVL  3             /* sim_disk_isavailable_a */
 
+/* Queue a request for the unit's I/O thread.  If the request ring is
+   full, the simulator thread waits for the I/O thread to perform the
+   oldest request.  Callbacks are never run from here, so a device is not
+   re-entered from its own submission and requests reach the container
+   in the order they were submitted. */
+
+static void
+_disk_io_submit (UNIT *uptr, int dop, t_lba lba, uint8 *buf, t_seccnt *rsects, t_seccnt sects, DISK_PCALLBACK callback)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_ioreq *req;
+
+pthread_mutex_lock (&ctx->io_lock);
+
+sim_debug_unit (ctx->dbit, uptr, "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d, queued=%u)\n",
+                dop, (int)(uptr - ctx->dptr->units), lba, sects, ctx->ioq_tail - ctx->ioq_next);
+
+if ((ctx->ioq_tail - ctx->ioq_next) == DISK_IOQ_DEPTH)
+    ++ctx->ioq_full;
+while ((ctx->ioq_tail - ctx->ioq_next) == DISK_IOQ_DEPTH)
+    pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
+req = &ctx->ioq[ctx->ioq_tail % DISK_IOQ_DEPTH];
+req->dop = dop;
+req->lba = lba;
+req->buf = buf;
+req->sects = sects;
+req->rsects = rsects;
+req->callback = callback;
+++ctx->ioq_tail;
+if (ctx->ioq_maxdepth < (ctx->ioq_tail - ctx->ioq_next))
+    ctx->ioq_maxdepth = ctx->ioq_tail - ctx->ioq_next;
+pthread_cond_signal (&ctx->io_cond);
+pthread_mutex_unlock (&ctx->io_lock);
+}
+
 static void *
 _disk_io(void *arg)
 {
@@ -244,24 +294,54 @@ sim_debug_unit (ctx->dbit, uptr, "_disk_io(unit=%d) starting\n", (int)(uptr - ct
 
 pthread_mutex_lock (&ctx->io_lock);
 pthread_cond_signal (&ctx->startup_cond);   /* Signal we're ready to go */
-while (ctx->asynch_io) {
-    pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
-    if (ctx->io_dop == DOP_DONE)
-        break;
+while (1) {
+    struct disk_ioreq *req;
+    struct disk_iodone *done;
+    t_stat status = SCPE_OK;
+
+    if ((ctx->ioq_next == ctx->ioq_tail) ||             /* nothing to do? */
+        (ctx->ioq_hold && ctx->asynch_io)) {
+        if (!ctx->asynch_io)                            /* done once queue drained */
+            break;
+        pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
+        continue;
+        }
+    req = &ctx->ioq[ctx->ioq_next % DISK_IOQ_DEPTH];
+    ctx->io_dop = req->dop;
     pthread_mutex_unlock (&ctx->io_lock);
-    switch (ctx->io_dop) {
+    switch (req->dop) {
         case DOP_RSEC:
-            ctx->io_status = sim_disk_rdsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            status = sim_disk_rdsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_WSEC:
-            ctx->io_status = sim_disk_wrsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            status = sim_disk_wrsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_IAVL:
-            ctx->io_status = sim_disk_isavailable (uptr);
+            status = sim_disk_isavailable (uptr);
             break;
         }
     pthread_mutex_lock (&ctx->io_lock);
+    if (ctx->iodone_count == ctx->iodone_size) {        /* grow completion list? */
+        uint32 size = ctx->iodone_size ? 2 * ctx->iodone_size : DISK_IOQ_DEPTH;
+        struct disk_iodone *iodone = (struct disk_iodone *)realloc (ctx->iodone, size * sizeof (*iodone));
+
+        while (iodone == NULL) {                        /* wait for dispatch to make room */
+            pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
+            if (ctx->iodone_count < ctx->iodone_size)
+                break;
+            iodone = (struct disk_iodone *)realloc (ctx->iodone, size * sizeof (*iodone));
+            }
+        if (iodone != NULL) {
+            ctx->iodone = iodone;
+            ctx->iodone_size = size;
+            }
+        }
+    done = &ctx->iodone[ctx->iodone_count++];
+    done->dop = req->dop;
+    done->callback = req->callback;
+    done->status = status;
     ctx->io_dop = DOP_DONE;
+    ++ctx->ioq_next;
     pthread_cond_signal (&ctx->io_done);
     sim_activate (uptr, ctx->asynch_io_latency);
     }
@@ -278,25 +358,35 @@ return NULL;
    routine is to put the unit in proper condition to digest what may have
    occurred in the asynchronous thread.
 
-   Since disk processing only handles a single I/O at a time to a
-   particular disk device (due to using stdio for the SimH Disk format
-   and stdio doesn't have an atomic seek+(read|write) operation),
-   we have the opportunity to possibly detect improper attempts to
-   issue multiple concurrent I/O requests. */
+   Several requests may have completed since the unit was last activated
+   (activations from the I/O thread coalesce while the unit is still on
+   the asynchronous queue), so the callbacks for all completed requests
+   are dispatched here in the order the requests were submitted.  The
+   lock is dropped around each callback since a callback commonly submits
+   the next request for the unit. */
 static void _disk_completion_dispatch (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-DISK_PCALLBACK callback = ctx->callback;
 
-sim_debug_unit (ctx->dbit, uptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop, (void *)(ctx->callback));
+if (ctx == NULL)                                        /* detached meanwhile? */
+    return;
+pthread_mutex_lock (&ctx->io_lock);
+while (ctx->iodone_head != ctx->iodone_count) {
+    struct disk_iodone *done = &ctx->iodone[ctx->iodone_head++];
+    DISK_PCALLBACK callback = done->callback;
+    t_stat status = done->status;
 
-if (ctx->io_dop != DOP_DONE)
-    abort();                                            /* horribly wrong, stop */
+    sim_debug_unit (ctx->dbit, uptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr - ctx->dptr->units), done->dop, (void *)callback);
 
-if (ctx->callback && ctx->io_dop == DOP_DONE) {
-    ctx->callback = NULL;
-    callback (uptr, ctx->io_status);
+    if (ctx->iodone_head == ctx->iodone_count)          /* list drained? */
+        ctx->iodone_head = ctx->iodone_count = 0;
+    pthread_cond_signal (&ctx->io_done);
+    pthread_mutex_unlock (&ctx->io_lock);
+    if (callback)
+        callback (uptr, status);
+    pthread_mutex_lock (&ctx->io_lock);
     }
+pthread_mutex_unlock (&ctx->io_lock);
 }
 
 static t_bool _disk_is_active (UNIT *uptr)
@@ -304,8 +394,8 @@ static t_bool _disk_is_active (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug_unit (ctx->dbit, uptr, "_disk_is_active(unit=%d, dop=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop);
-    return (ctx->io_dop != DOP_DONE);
+    sim_debug_unit (ctx->dbit, uptr, "_disk_is_active(unit=%d, dop=%d, pending=%u)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop, ctx->ioq_tail - ctx->ioq_next);
+    return (ctx->ioq_next != ctx->ioq_tail);
     }
 return FALSE;
 }
@@ -315,10 +405,10 @@ static t_bool _disk_cancel (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug_unit (ctx->dbit, uptr, "_disk_cancel(unit=%d, dop=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop);
+    sim_debug_unit (ctx->dbit, uptr, "_disk_cancel(unit=%d, dop=%d, pending=%u)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop, ctx->ioq_tail - ctx->ioq_next);
     if (ctx->asynch_io) {
         pthread_mutex_lock (&ctx->io_lock);
-        while (ctx->io_dop != DOP_DONE)
+        while (ctx->ioq_next != ctx->ioq_tail)
             pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
         pthread_mutex_unlock (&ctx->io_lock);
         }
@@ -340,7 +430,7 @@ static FILE *sim_vhd_disk_create (const char *szVHDPath, t_offset desiredsize);
 static FILE *sim_vhd_disk_create_diff (const char *szVHDPath, const char *szParentVHDPath);
 static FILE *sim_vhd_disk_merge (const char *szVHDPath, char **ParentVHD);
 static int sim_vhd_disk_close (FILE *f);
-static void sim_vhd_disk_flush (FILE *f);
+static t_stat sim_vhd_disk_flush (FILE *f);
 static t_offset sim_vhd_disk_size (FILE *f);
 static t_stat sim_vhd_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
 static t_stat sim_vhd_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
@@ -624,7 +714,7 @@ struct disk_context *ctx;
 if (uptr == NULL || (ctx = (struct disk_context *) uptr->disk_ctx, ctx == NULL))
     return SCPE_UNATT;
 
-sim_debug_unit (ctx->dbit, uptr, "sim_disk_clr_async(unit=%d)\n", (int)(uptr - ctx->dptr->units));
+sim_debug_unit (ctx->dbit, uptr, "sim_disk_clr_async(unit=%d, max queued=%u, full waits=%u)\n", (int)(uptr - ctx->dptr->units), ctx->ioq_maxdepth, ctx->ioq_full);
 
 if (ctx->asynch_io) {
     pthread_mutex_lock (&ctx->io_lock);
@@ -760,6 +850,41 @@ return r;
 
 /* Write Sectors */
 
+static t_bool _sim_disk_is_zeros (const uint8 *buf, size_t size)
+{
+return (size == 0) || ((buf[0] == 0) && (0 == memcmp (buf, buf + 1, size - 1)));
+}
+
+/* Sectors of zeros written to a SIMH format container are stored as holes
+   in the container file rather than as data.  Zeros inside the file have
+   their storage released and zeros which extend the file only write their
+   last sector, leaving the file system to supply the rest. */
+
+static t_bool _sim_disk_wrsect_zeros (UNIT *uptr, t_offset da, uint8 *buf, uint32 tbc)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset fsize = sim_fsize_ex (uptr->fileref);
+t_offset end = da + tbc;
+
+if (da < fsize) {
+    if (ctx->no_holes ||
+        (0 != sim_punch_hole (uptr->fileref, da, ((end < fsize) ? end : fsize) - da))) {
+        ctx->no_holes = TRUE;
+        return FALSE;
+        }
+    }
+if (end > fsize) {
+    if (sim_fseeko (uptr->fileref, end - ctx->sector_size, SEEK_SET) ||
+        (sim_fwrite (buf + tbc - ctx->sector_size, ctx->xfer_element_size, ctx->sector_size/ctx->xfer_element_size, uptr->fileref) != ctx->sector_size/ctx->xfer_element_size))
+        return FALSE;
+    if ((!ctx->no_holes) &&                             /* release the last sector too */
+        (0 != sim_punch_hole (uptr->fileref, end - ctx->sector_size, ctx->sector_size)))
+        ctx->no_holes = TRUE;
+    }
+sim_debug_unit (ctx->dbit, uptr, "_sim_disk_wrsect_zeros(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), (t_lba)(da / ctx->sector_size), (int)(tbc / ctx->sector_size));
+return TRUE;
+}
+
 static t_stat _sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
 {
 t_offset da;
@@ -773,6 +898,12 @@ da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
 if (sectswritten)
     *sectswritten = 0;
+if ((tbc > 0) && _sim_disk_is_zeros (buf, tbc) &&
+    _sim_disk_wrsect_zeros (uptr, da, buf, tbc)) {
+    if (sectswritten)
+        *sectswritten = sects;
+    return SCPE_OK;
+    }
 err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
 if (err)
     return SCPE_IOERR;
@@ -929,9 +1060,12 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 uint8 *buf;
 t_lba lba;
 
-if (uptr->flags & UNIT_ATT)
+if (!(uptr->flags & UNIT_ATT))
     return SCPE_UNATT;
 
+if ((DK_GET_FMT (uptr) == DKUF_F_STD) &&             /* SIMH format container? */
+    (0 == sim_punch_hole (uptr->fileref, 0, ctx->container_size)))
+    return SCPE_OK;                                     /* release everything at once */
 buf = (uint8 *)calloc (1, ctx->storage_sector_size);
 if (buf == NULL)
     return SCPE_MEM;
@@ -966,7 +1100,8 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
         fflush (uptr->fileref);
         break;
     case DKUF_F_VHD:                                    /* Virtual Disk */
-        sim_vhd_disk_flush (uptr->fileref);
+        if (sim_vhd_disk_flush (uptr->fileref) != SCPE_OK)
+            sim_printf ("%s: Error writing block allocation table of %s: %s\n", sim_uname (uptr), uptr->filename, strerror (errno));
         break;
     case DKUF_F_RAW:                                    /* Physical */
         sim_os_disk_flush_raw (uptr->fileref);
@@ -3035,14 +3170,19 @@ if ((created) && (!copied)) {
             if the containing disk is full
          3) it leaves a Simh Format disk at the intended size so it may
             subsequently be autosized with the correct size.
+       A Simh Format disk stores zeros as holes in the container file,
+       so only the last sector is written there.  This sizes the disk
+       without allocating any storage for it.
     */
     if (secbuf == NULL)
         r = SCPE_MEM;
     if (r == SCPE_OK) { /* Write all blocks */
-        t_lba lba;
+        t_lba lba = 0;
         t_lba total_lbas = (t_lba)((((t_offset)uptr->capac)*ctx->capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1))/ctx->sector_size);
 
-        for (lba = 0; (r == SCPE_OK) && (lba < total_lbas); lba += 128) {
+        if ((DK_GET_FMT (uptr) == DKUF_F_STD) && (total_lbas > 0))
+            lba = total_lbas - 1;
+        for ( ; (r == SCPE_OK) && (lba < total_lbas); lba += 128) {
             t_seccnt sectors = ((lba + 128) <= total_lbas) ? 128 : total_lbas - lba;
 
             r = sim_disk_wrsect (uptr, lba, secbuf, NULL, sectors);
@@ -3416,6 +3556,9 @@ free (uptr->filename);
 uptr->filename = NULL;
 uptr->fileref = NULL;
 free (ctx->footer);
+#if defined SIM_ASYNCH_IO
+free (ctx->iodone);
+#endif
 free (uptr->disk_ctx);
 uptr->disk_ctx = NULL;
 uptr->io_flush = NULL;
@@ -4647,8 +4790,9 @@ static int sim_vhd_disk_close (FILE *f)
 return -1;
 }
 
-static void sim_vhd_disk_flush (FILE *f)
+static t_stat sim_vhd_disk_flush (FILE *f)
 {
+return SCPE_NOFNC;
 }
 
 static t_offset sim_vhd_disk_size (FILE *f)
@@ -5301,11 +5445,19 @@ struct VHD_IOData {
     VHD_Footer Footer;
     VHD_DynamicDiskHeader Dynamic;
     uint32 *BAT;
+    uint32 BATDirtyLow;         /* BAT entries [Low, High) not yet written */
+    uint32 BATDirtyHigh;
+    uint8 *BlockOwner;          /* Differencing: parent layer holding each unallocated block */
     FILE *File;
     char ParentVHDPath[512];
     struct VHD_IOData *Parent;
     };
 
+/* BlockOwner values (otherwise the depth in the parent chain) */
+#define VHD_OWNER_UNKNOWN   0       /* not yet resolved */
+#define VHD_OWNER_RECURSE   0xFE    /* parent blocks don't line up, read through the chain */
+#define VHD_OWNER_NONE      0xFF    /* no layer has it, reads as zeros */
+
 static t_stat sim_vhd_disk_implemented (void)
 {
 return SCPE_OK;
@@ -5410,6 +5562,7 @@ static FILE *sim_vhd_disk_open (const char *szVHDPath, const char *DesiredAccess
             Status = errno;
             goto Cleanup_Return;
             }
+        hVHD->BlockOwner = (uint8 *)calloc (NtoHl (hVHD->Dynamic.MaxTableEntries), sizeof (*hVHD->BlockOwner));
         Status = GetVHDFooter (hVHD->ParentVHDPath,
                                &ParentFooter,
                                &ParentDynamic,
@@ -5586,30 +5739,42 @@ Cleanup_Return:
     return (FILE *)hVHD;
     }
 
+static t_stat WriteVirtualDiskBAT (VHDHANDLE hVHD);
+
 static int sim_vhd_disk_close (FILE *f)
 {
 VHDHANDLE hVHD = (VHDHANDLE)f;
+int stat = 0;
 
 if (NULL != hVHD) {
     if (hVHD->Parent)
         sim_vhd_disk_close ((FILE *)hVHD->Parent);
-    free (hVHD->BAT);
     if (hVHD->File) {
-        fflush (hVHD->File);
+        if (WriteVirtualDiskBAT (hVHD) != SCPE_OK)      /* pending block allocations lost? */
+            stat = EOF;
+        if (fflush (hVHD->File) == EOF)
+            stat = EOF;
         fclose (hVHD->File);
         }
+    free (hVHD->BAT);
+    free (hVHD->BlockOwner);
     free (hVHD);
-    return 0;
+    return stat;
     }
 return -1;
 }
 
-static void sim_vhd_disk_flush (FILE *f)
+static t_stat sim_vhd_disk_flush (FILE *f)
 {
 VHDHANDLE hVHD = (VHDHANDLE)f;
+t_stat r = SCPE_OK;
 
-if ((NULL != hVHD) && (hVHD->File))
-    fflush (hVHD->File);
+if ((NULL != hVHD) && (hVHD->File)) {
+    r = WriteVirtualDiskBAT (hVHD);
+    if (fflush (hVHD->File) == EOF)
+        r = SCPE_IOERR;
+    }
+return r;
 }
 
 static t_offset sim_vhd_disk_size (FILE *f)
@@ -6133,6 +6298,46 @@ static FILE *sim_vhd_disk_create_diff (const char *szVHDPath, const char *szPare
 return (FILE *)CreateDifferencingVirtualDisk (szVHDPath, szParentVHDPath);
 }
 
+/* Find the layer of a differencing disk's parent chain which holds a block
+   the disk itself doesn't, or NULL if none does and the block reads as zeros.
+   Parents are opened read only and a disk's own blocks only ever go from
+   free to allocated, so once found the answer holds while the disk is open. */
+
+static VHDHANDLE
+ParentBlockOwner(VHDHANDLE hVHD, uint32 BlockNumber)
+{
+VHDHANDLE Owner = hVHD->Parent;
+uint32 Level;
+
+if (hVHD->BlockOwner == NULL)
+    return hVHD->Parent;
+Level = hVHD->BlockOwner[BlockNumber];
+if (Level == VHD_OWNER_UNKNOWN) {
+    for (Level = 1; Owner != NULL; Owner = Owner->Parent, ++Level) {
+        if (NtoHl (Owner->Footer.DiskType) == VHD_DT_Fixed)
+            break;
+        if ((Level >= VHD_OWNER_RECURSE) ||
+            (Owner->Dynamic.BlockSize != hVHD->Dynamic.BlockSize) ||
+            (BlockNumber >= NtoHl (Owner->Dynamic.MaxTableEntries))) {
+            Level = VHD_OWNER_RECURSE;
+            break;
+            }
+        if (Owner->BAT[BlockNumber] != VHD_BAT_FREE_ENTRY)
+            break;
+        }
+    if (Owner == NULL)
+        Level = VHD_OWNER_NONE;
+    hVHD->BlockOwner[BlockNumber] = (uint8)Level;
+    }
+if (Level == VHD_OWNER_NONE)
+    return NULL;
+Owner = hVHD->Parent;
+if (Level != VHD_OWNER_RECURSE)
+    while (--Level > 0)
+        Owner = Owner->Parent;
+return Owner;
+}
+
 static t_stat
 ReadVirtualDisk(VHDHANDLE hVHD,
                 uint8 *buf,
@@ -6184,12 +6389,14 @@ while (BytesToRead && (r == SCPE_OK)) {
     if (BlockNumber != (Offset + BytesToRead) / DynamicBlockSize)
         BytesInRead = (uint32)(((BlockNumber + 1) * DynamicBlockSize) - Offset);
     if (hVHD->BAT[BlockNumber] == VHD_BAT_FREE_ENTRY) {
-        if (!hVHD->Parent) {
+        VHDHANDLE Owner = hVHD->Parent ? ParentBlockOwner (hVHD, BlockNumber) : NULL;
+
+        if (!Owner) {
             memset (buf, 0, BytesInRead);
             BytesThisRead = BytesInRead;
             }
         else {
-            if (ReadVirtualDisk(hVHD->Parent,
+            if (ReadVirtualDisk(Owner,
                                 buf,
                                 BytesInRead,
                                 &BytesThisRead,
@@ -6321,40 +6528,50 @@ while (BytesToWrite && (r == SCPE_OK)) {
         uint8 *BitMap = NULL;
         uint32 BitMapBufferSize = VHD_DATA_BLOCK_ALIGNMENT;
         uint8 *BitMapBuffer = NULL;
-        void *BlockData = NULL;
-        uint8 *BATUpdateBufferAddress;
-        uint32 BATUpdateBufferSize;
-        uint64 BATUpdateStorageAddress;
+        uint8 *BlockData;
+        uint8 *BlockWrite;
+        uint32 BlockWriteSize;
+        uint64 BlockStart = (uint64)BlockNumber * DynamicBlockSize;
         uint64 BlockOffset;
 
         if (!hVHD->Parent && BufferIsZeros(buf, BytesInWrite)) {
             BytesThisWrite = BytesInWrite;
             goto IO_Done;
             }
-        /* Need to allocate a new Data Block. */
+        /* Need to allocate a new Data Block.  The bitmap, the complete block
+           contents (from the parent, if any, merged with the data being written)
+           and the relocated footer all go out in a single write.  The BAT entry
+           is only updated in memory here and is written by WriteVirtualDiskBAT */
         BlockOffset = sim_fsize_ex (hVHD->File);
         if (((int64)BlockOffset) == -1)
             return SCPE_IOERR;
         if ((BitMapSectors * VHD_Internal_SectorSize) > BitMapBufferSize)
             BitMapBufferSize = BitMapSectors * VHD_Internal_SectorSize;
-        BitMapBuffer = (uint8 *)calloc(1, BitMapBufferSize + DynamicBlockSize);
-        if (BitMapBufferSize > BitMapSectors * VHD_Internal_SectorSize)
-            BitMap = BitMapBuffer + BitMapBufferSize - BitMapBytes;
-        else
-            BitMap = BitMapBuffer;
+        BitMapBuffer = (uint8 *)calloc(1, BitMapBufferSize + DynamicBlockSize + sizeof(hVHD->Footer));
+        if (BitMapBuffer == NULL)
+            return SCPE_MEM;
+        BitMap = BitMapBuffer + BitMapBufferSize - (BitMapSectors * VHD_Internal_SectorSize);
         memset(BitMap, 0xFF, BitMapBytes);
-        BlockOffset -= sizeof(hVHD->Footer);
-        if (0 == (BlockOffset & (VHD_DATA_BLOCK_ALIGNMENT-1)))
-            {  // Already aligned, so use padded BitMapBuffer
-            if (WriteFilePosition(hVHD->File,
-                                  BitMapBuffer,
-                                  BitMapBufferSize + DynamicBlockSize,
-                                  NULL,
-                                  BlockOffset)) {
+        BlockData = BitMapBuffer + BitMapBufferSize;
+        if (hVHD->Parent) {
+            /* Populate data block contents from the parent chain (the block is still free here) */
+            if (ReadVirtualDisk(hVHD,
+                                BlockData,
+                                DynamicBlockSize,
+                                NULL,
+                                BlockStart)) {
                 free (BitMapBuffer);
                 return SCPE_IOERR;
                 }
-            BlockOffset += BitMapBufferSize;
+            }
+        memcpy (BlockData + (size_t)(Offset - BlockStart), buf, BytesInWrite);
+        memcpy (BlockData + DynamicBlockSize, &hVHD->Footer, sizeof(hVHD->Footer));
+        BlockOffset -= sizeof(hVHD->Footer);
+        if (0 == (BlockOffset & (VHD_DATA_BLOCK_ALIGNMENT-1)))
+            {  // Already aligned, so use padded BitMapBuffer
+            BlockWrite = BitMapBuffer;
+            BlockWriteSize = BitMapBufferSize + DynamicBlockSize + sizeof(hVHD->Footer);
+            BlockOffset += BitMapBufferSize - (BitMapSectors * VHD_Internal_SectorSize);
             }
         else
             {
@@ -6365,76 +6582,31 @@ while (BytesToWrite && (r == SCPE_OK)) {
             BlockOffset += VHD_DATA_BLOCK_ALIGNMENT-1;
             BlockOffset &= ~(VHD_DATA_BLOCK_ALIGNMENT - 1);
             BlockOffset -= BitMapSectors * VHD_Internal_SectorSize;
-            if (WriteFilePosition(hVHD->File,
-                                  BitMap,
-                                  (BitMapSectors * VHD_Internal_SectorSize) + DynamicBlockSize,
-                                  NULL,
-                                  BlockOffset)) {
-                free (BitMapBuffer);
-                return SCPE_IOERR;
-                }
-            BlockOffset += BitMapSectors * VHD_Internal_SectorSize;
+            BlockWrite = BitMap;
+            BlockWriteSize = (BitMapSectors * VHD_Internal_SectorSize) + DynamicBlockSize + sizeof(hVHD->Footer);
+            }
+        if (WriteFilePosition(hVHD->File,
+                              BlockWrite,
+                              BlockWriteSize,
+                              NULL,
+                              BlockOffset - (BitMap - BlockWrite))) {
+            free (BitMapBuffer);
+            return SCPE_IOERR;
             }
         free(BitMapBuffer);
-        BitMapBuffer = BitMap = NULL;
         /* the BAT block address is the beginning of the block bitmap */
-        BlockOffset -= BitMapSectors * VHD_Internal_SectorSize;
         hVHD->BAT[BlockNumber] = NtoHl((uint32)(BlockOffset / VHD_Internal_SectorSize));
-        BlockOffset += (BitMapSectors * VHD_Internal_SectorSize) + DynamicBlockSize;
-        if (WriteFilePosition(hVHD->File,
-                              &hVHD->Footer,
-                              sizeof(hVHD->Footer),
-                              NULL,
-                              BlockOffset))
-            goto Fatal_IO_Error;
-        /* Since a large VHD can have a pretty large BAT, and we've only changed one longword bat entry
-           in the current BAT, we write just the aligned sector which contains the updated BAT entry */
-        BATUpdateBufferAddress = (uint8 *)hVHD->BAT - (size_t)NtoHll(hVHD->Dynamic.TableOffset) +
-            (size_t)((((size_t)&hVHD->BAT[BlockNumber]) - (size_t)hVHD->BAT + (size_t)NtoHll(hVHD->Dynamic.TableOffset)) & ~(VHD_DATA_BLOCK_ALIGNMENT-1));
-        /* If the starting of the BAT isn't on a VHD_DATA_BLOCK_ALIGNMENT boundary and we've just updated
-           a BAT entry early in the array, the buffer computed address might be before the start of the
-           BAT table.  If so, only write the BAT data needed */
-        if (BATUpdateBufferAddress < (uint8 *)hVHD->BAT) {
-            BATUpdateBufferAddress = (uint8 *)hVHD->BAT;
-            BATUpdateBufferSize = (uint32)((((size_t)&hVHD->BAT[BlockNumber]) - (size_t)hVHD->BAT) + 512) & ~511;
-            BATUpdateStorageAddress = NtoHll(hVHD->Dynamic.TableOffset);
+        if (hVHD->BATDirtyLow == hVHD->BATDirtyHigh) {
+            hVHD->BATDirtyLow = BlockNumber;
+            hVHD->BATDirtyHigh = BlockNumber + 1;
             }
         else {
-            BATUpdateBufferSize = VHD_DATA_BLOCK_ALIGNMENT;
-            BATUpdateStorageAddress = NtoHll(hVHD->Dynamic.TableOffset) + BATUpdateBufferAddress - ((uint8 *)hVHD->BAT);
+            if (BlockNumber < hVHD->BATDirtyLow)
+                hVHD->BATDirtyLow = BlockNumber;
+            if (BlockNumber >= hVHD->BATDirtyHigh)
+                hVHD->BATDirtyHigh = BlockNumber + 1;
             }
-        /* If the total BAT is smaller than one VHD_DATA_BLOCK_ALIGNMENT, then be sure to only write out the BAT data */
-        if ((size_t)(BATUpdateBufferAddress - (uint8 *)hVHD->BAT + BATUpdateBufferSize) > VHD_Internal_SectorSize * ((sizeof(*hVHD->BAT)*NtoHl(hVHD->Dynamic.MaxTableEntries) + VHD_Internal_SectorSize - 1)/VHD_Internal_SectorSize))
-            BATUpdateBufferSize = (uint32)(VHD_Internal_SectorSize * ((sizeof(*hVHD->BAT) * NtoHl(hVHD->Dynamic.MaxTableEntries) + VHD_Internal_SectorSize - 1)/VHD_Internal_SectorSize) - (BATUpdateBufferAddress - ((uint8 *)hVHD->BAT)));
-        if (WriteFilePosition(hVHD->File,
-                              BATUpdateBufferAddress,
-                              BATUpdateBufferSize,
-                              NULL,
-                              BATUpdateStorageAddress))
-            goto Fatal_IO_Error;
-        if (hVHD->Parent)
-            { /* Need to populate data block contents from parent VHD */
-            BlockData = malloc (NtoHl (hVHD->Dynamic.BlockSize));
-
-            if (ReadVirtualDisk(hVHD->Parent,
-                                (uint8*) BlockData,
-                                NtoHl (hVHD->Dynamic.BlockSize),
-                                NULL,
-                                (Offset / NtoHl (hVHD->Dynamic.BlockSize)) * NtoHl (hVHD->Dynamic.BlockSize)))
-                goto Fatal_IO_Error;
-            if (WriteVirtualDisk(hVHD,
-                                 (uint8*) BlockData,
-                                 NtoHl (hVHD->Dynamic.BlockSize),
-                                 NULL,
-                                 (Offset / NtoHl (hVHD->Dynamic.BlockSize)) * NtoHl (hVHD->Dynamic.BlockSize)))
-                goto Fatal_IO_Error;
-            free(BlockData);
-            }
-        continue;
-Fatal_IO_Error:
-        free (BitMap);
-        free (BlockData);
-        r = SCPE_IOERR;
+        BytesThisWrite = BytesInWrite;
         }
     else {
         uint64 BlockOffset = VHD_Internal_SectorSize * ((uint64)(NtoHl(hVHD->BAT[BlockNumber]) + BitMapSectors)) + (Offset % DynamicBlockSize);
@@ -6457,6 +6629,34 @@ if (BytesWritten)
 return r;
 }
 
+/* Write out the sectors of the BAT which hold entries changed by block
+   allocations since the last time the BAT was written */
+
+static t_stat
+WriteVirtualDiskBAT(VHDHANDLE hVHD)
+{
+uint32 EntriesPerSector = VHD_Internal_SectorSize / sizeof (*hVHD->BAT);
+uint32 TableSectors;
+uint32 FirstSector;
+uint32 LastSector;
+
+if (hVHD->BATDirtyLow == hVHD->BATDirtyHigh)
+    return SCPE_OK;
+TableSectors = (NtoHl (hVHD->Dynamic.MaxTableEntries) + EntriesPerSector - 1) / EntriesPerSector;
+FirstSector = hVHD->BATDirtyLow / EntriesPerSector;
+LastSector = (hVHD->BATDirtyHigh + EntriesPerSector - 1) / EntriesPerSector;
+if (LastSector > TableSectors)
+    LastSector = TableSectors;
+if (WriteFilePosition(hVHD->File,
+                      hVHD->BAT + FirstSector * EntriesPerSector,
+                      (LastSector - FirstSector) * VHD_Internal_SectorSize,
+                      NULL,
+                      NtoHll (hVHD->Dynamic.TableOffset) + (uint64)FirstSector * VHD_Internal_SectorSize))
+    return SCPE_IOERR;
+hVHD->BATDirtyLow = hVHD->BATDirtyHigh = 0;
+return SCPE_OK;
+}
+
 static t_stat
 WriteVirtualDiskSectors(VHDHANDLE hVHD,
                         uint8 *buf,
@@ -6873,6 +7073,379 @@ if (r == SCPE_OK) {
 return r;
 }
 
+#if defined (SIM_ASYNCH_IO)
+/* Fill the asynchronous request ring of a SIMH format container.  The
+   I/O thread is held off until the ring is full, so a further submission
+   has to wait for a free slot.  No callback may run inside a submission,
+   and a write queued by a callback must reach the container after every
+   request submitted before it. */
+
+#define AQ_TEST_REQUESTS    (3 * DISK_IOQ_DEPTH)
+
+static struct {
+    uint32  count;                          /* callbacks dispatched */
+    t_bool  in_submit;                      /* inside sim_disk_wrsect_a */
+    t_bool  reentered;                      /* callback ran inside a submission */
+    t_stat  status;                         /* first failure reported */
+    uint8   *extra;                         /* written by the first callback */
+    } disk_test_aq;
+
+static void sim_disk_test_aq_callback (UNIT *uptr, t_stat status)
+{
+if (disk_test_aq.in_submit)
+    disk_test_aq.reentered = TRUE;
+if ((status != SCPE_OK) && (disk_test_aq.status == SCPE_OK))
+    disk_test_aq.status = status;
+if (disk_test_aq.count++ == 0) {                        /* rewrite sector 0 last */
+    disk_test_aq.in_submit = TRUE;
+    sim_disk_wrsect_a (uptr, 0, disk_test_aq.extra, NULL, 1, sim_disk_test_aq_callback);
+    disk_test_aq.in_submit = FALSE;
+    }
+}
+
+static void *sim_disk_test_aq_release (void *arg)
+{
+struct disk_context *ctx = (struct disk_context *)((UNIT *)arg)->disk_ctx;
+
+sim_os_ms_sleep (200);                                  /* let the submitter find the ring full */
+pthread_mutex_lock (&ctx->io_lock);
+ctx->ioq_hold = FALSE;
+pthread_cond_signal (&ctx->io_cond);
+pthread_mutex_unlock (&ctx->io_lock);
+return NULL;
+}
+
+static t_stat sim_disk_test_async_queue (UNIT *uptr)
+{
+const char *filename = "Test-Async-Queue.dsk";
+uint8 *buf = (uint8 *)malloc ((AQ_TEST_REQUESTS + 1) * 512);
+uint8 *rbuf = (uint8 *)malloc (512);
+struct disk_context *ctx;
+pthread_t release;
+int32 saved_switches = sim_switches;
+t_seccnt sects_done;
+uint32 i, full, maxdepth;
+t_stat r;
+
+sim_printf ("\n*** Asynchronous request queue test\n");
+if (!sim_asynch_enabled) {
+    sim_printf ("Skipped, asynchronous I/O is disabled\n");
+    free (buf);
+    free (rbuf);
+    return SCPE_OK;
+    }
+(void)remove (filename);
+sim_switches &= ~SWMASK ('D');                          /* TESTLIB -D isn't an attach switch */
+sim_disk_set_fmt (uptr, 0, "SIMH", NULL);
+r = sim_disk_attach_ex (uptr, filename, 512, 1, TRUE, 0, NULL, 0, 0, NULL);
+sim_switches = saved_switches;
+if (r != SCPE_OK) {
+    free (buf);
+    free (rbuf);
+    return r;
+    }
+ctx = (struct disk_context *)uptr->disk_ctx;
+for (i = 0; i < (AQ_TEST_REQUESTS + 1) * 512; i++)
+    buf[i] = (uint8)((i / 512) + 1);
+memset (&disk_test_aq, 0, sizeof (disk_test_aq));
+disk_test_aq.extra = buf + AQ_TEST_REQUESTS * 512;
+pthread_mutex_lock (&ctx->io_lock);
+ctx->ioq_hold = TRUE;
+pthread_mutex_unlock (&ctx->io_lock);
+pthread_create (&release, NULL, sim_disk_test_aq_release, (void *)uptr);
+disk_test_aq.in_submit = TRUE;
+for (i = 0; i < AQ_TEST_REQUESTS; i++)
+    sim_disk_wrsect_a (uptr, i, buf + i * 512, NULL, 1, sim_disk_test_aq_callback);
+disk_test_aq.in_submit = FALSE;
+pthread_join (release, NULL);
+sim_cancel (uptr);                                      /* wait for the I/O, dispatch callbacks */
+sim_cancel (uptr);                                      /* and the one queued by a callback */
+pthread_mutex_lock (&ctx->io_lock);
+full = ctx->ioq_full;
+maxdepth = ctx->ioq_maxdepth;
+pthread_mutex_unlock (&ctx->io_lock);
+if ((full == 0) || (maxdepth != DISK_IOQ_DEPTH)) {
+    sim_printf ("The request ring never filled (deepest %u, waits %u)\n", maxdepth, full);
+    r = SCPE_IERR;
+    }
+if ((r == SCPE_OK) && (disk_test_aq.count != AQ_TEST_REQUESTS + 1)) {
+    sim_printf ("Dispatched %u callbacks instead of %u\n", disk_test_aq.count, AQ_TEST_REQUESTS + 1);
+    r = SCPE_IERR;
+    }
+if ((r == SCPE_OK) && disk_test_aq.reentered) {
+    sim_printf ("A callback ran inside a submission\n");
+    r = SCPE_IERR;
+    }
+if ((r == SCPE_OK) && (disk_test_aq.status != SCPE_OK)) {
+    sim_printf ("A queued write failed: %s\n", sim_error_text (disk_test_aq.status));
+    r = disk_test_aq.status;
+    }
+for (i = 0; (r == SCPE_OK) && (i < AQ_TEST_REQUESTS); i++) {
+    uint8 expected = (uint8)((i == 0) ? (AQ_TEST_REQUESTS + 1) : (i + 1));
+
+    r = sim_disk_rdsect (uptr, i, rbuf, &sects_done, 1);
+    if ((r == SCPE_OK) && ((rbuf[0] != expected) || (rbuf[511] != expected))) {
+        sim_printf ("Sector %u holds 0x%02X instead of 0x%02X\n", i, rbuf[0], expected);
+        r = SCPE_IERR;
+        }
+    }
+if (r == SCPE_OK)
+    sim_printf ("%u requests through a %u deep ring, %u submission(s) waited for a slot\n",
+                AQ_TEST_REQUESTS + 1, DISK_IOQ_DEPTH, full);
+sim_disk_detach (uptr);
+(void)remove (filename);
+free (buf);
+free (rbuf);
+return r;
+}
+#endif
+
+/* Build a three level VHD differencing chain, write random 4KB chunks at
+   each level and verify random reads and writes through the top of the
+   chain, then verify again after a detach and re-attach.  With TESTLIB -D
+   the I/O is timed, and the same random I/O is then timed on RAW and SIMH
+   format containers and on a single dynamic VHD for comparison. */
+
+#define DIFF_TEST_LEVELS        3
+#define DIFF_TEST_CHUNK_SECTORS 8           /* 4KB */
+#define DIFF_TEST_CHUNKS        2048        /* 8MB, 4 VHD blocks */
+#define DIFF_TEST_OPS           4000
+
+static t_stat sim_disk_test_random_io_timing (UNIT *uptr)
+{
+static const char *fmt[] = {"RAW", "SIMH", "VHD"};
+static const char *filename[] = {"Test-Raw.dsk", "Test-Simh.dsk", "Test-Dynamic.VHD"};
+static const char *desc[] = {"RAW container", "SIMH container", "Dynamic VHD"};
+uint32 *data = (uint32 *)calloc (DIFF_TEST_CHUNK_SECTORS * 512, 1);
+uint32 chunk, op, start_time, write_ms;
+int32 saved_switches = sim_switches;
+t_seccnt sectors_done;
+t_stat r = SCPE_OK;
+int f;
+
+if (data == NULL)
+    return SCPE_MEM;
+sim_switches &= ~SWMASK ('D');                          /* TESTLIB -D isn't an attach switch */
+for (f = 0; (f < 3) && (r == SCPE_OK); f++) {
+    (void)remove (filename[f]);
+    if (strcmp (fmt[f], "RAW") == 0) {
+        /* There is no innate creation of RAW containers, so create the empty container using SIMH format */
+        sim_disk_set_fmt (uptr, 0, "SIMH", NULL);
+        sim_disk_attach_ex (uptr, filename[f], 512, 1, TRUE, 0, NULL, 0, 0, NULL);
+        sim_disk_detach (uptr);
+        }
+    sim_disk_set_fmt (uptr, 0, fmt[f], NULL);
+    r = sim_disk_attach_ex (uptr, filename[f], 512, 1, TRUE, 0, NULL, 0, 0, NULL);
+    if (r != SCPE_OK)
+        break;
+    srand (DIFF_TEST_LEVELS);
+    start_time = sim_os_msec ();
+    for (op = 0; (op < DIFF_TEST_OPS) && (r == SCPE_OK); op++) {
+        chunk = rand () % DIFF_TEST_CHUNKS;
+        data[0] = chunk;
+        r = sim_disk_wrsect (uptr, chunk * DIFF_TEST_CHUNK_SECTORS, (uint8 *)data, &sectors_done, DIFF_TEST_CHUNK_SECTORS);
+        }
+    write_ms = sim_os_msec () - start_time;
+    start_time = sim_os_msec ();
+    for (op = 0; (op < DIFF_TEST_OPS) && (r == SCPE_OK); op++) {
+        chunk = rand () % DIFF_TEST_CHUNKS;
+        r = sim_disk_rdsect (uptr, chunk * DIFF_TEST_CHUNK_SECTORS, (uint8 *)data, &sectors_done, DIFF_TEST_CHUNK_SECTORS);
+        }
+    sim_printf ("%s: %u random 4KB writes in %u ms, %u random 4KB reads in %u ms\n",
+                desc[f], DIFF_TEST_OPS, write_ms, DIFF_TEST_OPS, sim_os_msec () - start_time);
+    sim_disk_detach (uptr);
+    (void)remove (filename[f]);
+    }
+sim_disk_set_fmt (uptr, 0, "VHD", NULL);
+sim_switches = saved_switches;
+free (data);
+return r;
+}
+
+static t_stat sim_disk_test_differencing (UNIT *uptr)
+{
+struct disk_context *ctx;
+char filename[DIFF_TEST_LEVELS][32];
+char attach_spec[80];
+uint8 *level = (uint8 *)calloc (DIFF_TEST_CHUNKS, sizeof (*level));
+uint32 *data = NULL;
+uint32 uint32s_per_chunk;
+uint32 chunk, i, op, start_time;
+int l, pass;
+int32 saved_switches = sim_switches & ~SWMASK ('D');   /* TESTLIB -D isn't an attach switch */
+t_seccnt sectors_done;
+t_stat r = SCPE_OK;
+
+sim_printf ("\n*** VHD Differencing chain random I/O test\n");
+for (l = 0; l < DIFF_TEST_LEVELS; l++) {
+    snprintf (filename[l], sizeof (filename[l]), "Test-Diff-%d.VHD", l);
+    (void)remove (filename[l]);
+    }
+sim_disk_set_fmt (uptr, 0, "VHD", NULL);
+for (l = 0; (l < DIFF_TEST_LEVELS) && (r == SCPE_OK); l++) {
+    sim_switches = saved_switches;
+    if (l == 0)
+        r = sim_disk_attach_ex (uptr, filename[l], 512, 1, TRUE, 0, NULL, 0, 0, NULL);
+    else {
+        sim_switches |= SWMASK ('D');
+        snprintf (attach_spec, sizeof (attach_spec), "%s %s", filename[l], filename[l - 1]);
+        r = sim_disk_attach_ex (uptr, attach_spec, 512, 1, TRUE, 0, NULL, 0, 0, NULL);
+        }
+    if (r != SCPE_OK)
+        break;
+    ctx = (struct disk_context *)uptr->disk_ctx;
+    if (data == NULL) {
+        uint32s_per_chunk = (DIFF_TEST_CHUNK_SECTORS * ctx->sector_size) / sizeof (*data);
+        data = (uint32 *)malloc (uint32s_per_chunk * sizeof (*data));
+        }
+    srand (l);
+    start_time = sim_os_msec ();
+    for (op = 0; (op < DIFF_TEST_CHUNKS / 2) && (r == SCPE_OK); op++) {
+        chunk = rand () % DIFF_TEST_CHUNKS;
+        level[chunk] = (uint8)(l + 1);
+        for (i = 0; i < uint32s_per_chunk; i++)
+            data[i] = (chunk << 8) | (l + 1);
+        r = sim_disk_wrsect (uptr, chunk * DIFF_TEST_CHUNK_SECTORS, (uint8 *)data, &sectors_done, DIFF_TEST_CHUNK_SECTORS);
+        }
+    if (sim_deb != NULL)
+        sim_printf ("Level %d: %u random 4KB writes in %u ms\n", l, DIFF_TEST_CHUNKS / 2, sim_os_msec () - start_time);
+    if (r == SCPE_OK)
+        r = sim_disk_detach (uptr);
+    }
+sim_switches = saved_switches;
+for (pass = 0; (pass < 2) && (r == SCPE_OK); pass++) {
+    r = sim_disk_attach_ex (uptr, filename[DIFF_TEST_LEVELS - 1], 512, 1, TRUE, 0, NULL, 0, 0, NULL);
+    if (r != SCPE_OK)
+        break;
+    srand (DIFF_TEST_LEVELS + pass);
+    start_time = sim_os_msec ();
+    for (op = 0; (op < DIFF_TEST_OPS) && (r == SCPE_OK); op++) {
+        chunk = rand () % DIFF_TEST_CHUNKS;
+        r = sim_disk_rdsect (uptr, chunk * DIFF_TEST_CHUNK_SECTORS, (uint8 *)data, &sectors_done, DIFF_TEST_CHUNK_SECTORS);
+        for (i = 0; (i < uint32s_per_chunk) && (r == SCPE_OK); i++)
+            if (data[i] != ((level[chunk] == 0) ? 0 : ((chunk << 8) | level[chunk]))) {
+                sim_printf ("Chunk %u has unexpected data at offset 0x%X: 0x%08X\n", chunk, i, data[i]);
+                r = SCPE_IERR;
+                }
+        }
+    if (sim_deb != NULL)
+        sim_printf ("Top of chain: %u random 4KB reads in %u ms\n", DIFF_TEST_OPS, sim_os_msec () - start_time);
+    if (pass == 0) {
+        start_time = sim_os_msec ();
+        for (op = 0; (op < DIFF_TEST_OPS) && (r == SCPE_OK); op++) {
+            chunk = rand () % DIFF_TEST_CHUNKS;
+            level[chunk] = DIFF_TEST_LEVELS + 1;
+            for (i = 0; i < uint32s_per_chunk; i++)
+                data[i] = (chunk << 8) | (DIFF_TEST_LEVELS + 1);
+            r = sim_disk_wrsect (uptr, chunk * DIFF_TEST_CHUNK_SECTORS, (uint8 *)data, &sectors_done, DIFF_TEST_CHUNK_SECTORS);
+            }
+        if (sim_deb != NULL)
+            sim_printf ("Top of chain: %u random 4KB writes in %u ms\n", DIFF_TEST_OPS, sim_os_msec () - start_time);
+        }
+    if (r == SCPE_OK)
+        r = sim_disk_detach (uptr);
+    }
+if (uptr->flags & UNIT_ATT)
+    sim_disk_detach (uptr);
+free (data);
+free (level);
+if (r == SCPE_OK)
+    for (l = 0; l < DIFF_TEST_LEVELS; l++)
+        (void)remove (filename[l]);
+if ((r == SCPE_OK) && (sim_deb != NULL))
+    r = sim_disk_test_random_io_timing (uptr);
+return r;
+}
+
+/* Write a SIMH format container which is mostly zeros and check that the
+   zeros end up as holes in both the container and a copy of it.  The
+   writes and the copy are timed with TESTLIB -D. */
+
+#define SPARSE_TEST_SECTORS     (128*1024)  /* 64MB */
+#define SPARSE_TEST_XFER        2048        /* 1MB */
+
+static t_stat sim_disk_test_sparse (UNIT *uptr)
+{
+const char *filename = "Test-Sparse.dsk";
+const char *copyname = "Test-Sparse-Copy.dsk";
+uint8 *buf = (uint8 *)malloc (SPARSE_TEST_XFER * 512);
+t_lba lba;
+t_seccnt sects_done;
+uint32 i, start_time;
+int32 saved_switches = sim_switches;
+t_bool holes = FALSE;
+t_stat r;
+
+sim_printf ("\n*** SIMH format sparse container test\n");
+(void)remove (filename);
+(void)remove (copyname);
+sim_switches &= ~SWMASK ('D');                          /* TESTLIB -D isn't an attach switch */
+sim_disk_set_fmt (uptr, 0, "SIMH", NULL);
+r = sim_disk_attach_ex (uptr, filename, 512, 1, TRUE, 0, NULL, 0, 0, NULL);
+if (r != SCPE_OK) {
+    sim_switches = saved_switches;
+    free (buf);
+    return r;
+    }
+for (i = 0; i < SPARSE_TEST_XFER * 512; i++)
+    buf[i] = (uint8)(i | 1);
+r = sim_disk_wrsect (uptr, 0, buf, &sects_done, SPARSE_TEST_XFER);
+memset (buf, 0, SPARSE_TEST_XFER * 512);
+start_time = sim_os_msec ();
+for (lba = SPARSE_TEST_XFER; (lba < SPARSE_TEST_SECTORS) && (r == SCPE_OK); lba += SPARSE_TEST_XFER)
+    r = sim_disk_wrsect (uptr, lba, buf, &sects_done, SPARSE_TEST_XFER);
+if (r == SCPE_OK)                           /* zero the data written first */
+    r = sim_disk_wrsect (uptr, 0, buf, &sects_done, SPARSE_TEST_XFER);
+if (sim_deb != NULL)
+    sim_printf ("Wrote %u zero sectors in %u ms\n", SPARSE_TEST_SECTORS, sim_os_msec () - start_time);
+holes = !((struct disk_context *)uptr->disk_ctx)->no_holes;
+sim_disk_detach (uptr);
+if (r == SCPE_OK) {
+    start_time = sim_os_msec ();
+    r = sim_copyfile (filename, copyname, TRUE);
+    if (sim_deb != NULL)
+        sim_printf ("Copied container in %u ms\n", sim_os_msec () - start_time);
+    }
+if ((r == SCPE_OK) && (sim_fsize_name_ex (filename) != sim_fsize_name_ex (copyname))) {
+    sim_printf ("Copy is %u bytes instead of %u bytes\n", (uint32)sim_fsize_name_ex (copyname), (uint32)sim_fsize_name_ex (filename));
+    r = SCPE_IERR;
+    }
+#if !defined (_WIN32)
+if ((r == SCPE_OK) && holes) {
+    struct stat statb;
+    int f;
+
+    for (f = 0; (f < 2) && (r == SCPE_OK); f++) {
+        const char *name = (f == 0) ? filename : copyname;
+
+        if ((0 == sim_stat (name, &statb)) &&
+            (((t_offset)statb.st_blocks) * 512 >= (t_offset)SPARSE_TEST_XFER * 512)) {
+            sim_printf ("%s occupies %u bytes of storage\n", name, (uint32)(statb.st_blocks * 512));
+            r = SCPE_IERR;
+            }
+        }
+    }
+#endif
+if (r == SCPE_OK)
+    r = sim_disk_attach_ex (uptr, copyname, 512, 1, TRUE, 0, NULL, 0, 0, NULL);
+for (lba = 0; (lba < SPARSE_TEST_SECTORS) && (r == SCPE_OK); lba += SPARSE_TEST_XFER) {
+    r = sim_disk_rdsect (uptr, lba, buf, &sects_done, SPARSE_TEST_XFER);
+    if ((r == SCPE_OK) && !_sim_disk_is_zeros (buf, SPARSE_TEST_XFER * 512)) {
+        sim_printf ("Sectors starting at %u aren't zero\n", lba);
+        r = SCPE_IERR;
+        }
+    }
+if (uptr->flags & UNIT_ATT)
+    sim_disk_detach (uptr);
+sim_switches = saved_switches;
+free (buf);
+if (r == SCPE_OK) {
+    (void)remove (filename);
+    (void)remove (copyname);
+    }
+return r;
+}
+
 static t_stat _sim_disk_test_create (const char *container, size_t size)
 {
 FILE *f = fopen (container, "w");
@@ -7144,5 +7717,11 @@ for (x = 0; xfr_size[x] != 0; x++) {
             }
         }
     }
+sim_switches = saved_switches;
+SIM_TEST (sim_disk_test_differencing (uptr));
+SIM_TEST (sim_disk_test_sparse (uptr));
+#if defined (SIM_ASYNCH_IO)
+SIM_TEST (sim_disk_test_async_queue (uptr));
+#endif
 return SCPE_OK;
 }
@@ -381,6 +381,18 @@
 
 #define MAX(a,b) (((a) > (b)) ? (a) : (b))
 
+/* The reader thread's receive slab holds one frame, or a whole batch of
+   them where the UDP transport can take a batch with one recvmmsg() */
+#if defined (__linux__) && defined (_GNU_SOURCE) && defined (MSG_WAITFORONE)
+#define ETH_HAVE_RECVMMSG 1
+#define ETH_RX_SLAB_SIZE(api) ((((api) == ETH_API_UDP) ? ETH_RX_BATCH : 1) * ETH_MAX_JUMBO_FRAME)
+#else
+#define ETH_RX_SLAB_SIZE(api) ETH_MAX_JUMBO_FRAME
+#endif
+#if defined (ETH_HAVE_RECVMMSG)
+#define ETH_HAVE_SENDMMSG 1                             /* writer bursts go out with one sendmmsg() */
+#endif
+
 // Declare earlier than other implementations
 #ifdef HAVE_VMNET_NETWORK
 #include <vmnet/vmnet.h>
@@ -707,26 +719,28 @@ void ethq_clear(ETH_QUE* que)
 {
   int i;
 
-  /* free up any extended packets */
+  /* free up any extended packet buffers */
   for (i=0; i<que->max; ++i)
-    if (que->item[i].packet.oversize) {
-      free (que->item[i].packet.oversize);
-      que->item[i].packet.oversize = NULL;
-      }
+    free (que->item[i].spare);
   /* clear packet array */
   memset(que->item, 0, sizeof(struct eth_item) * que->max);
   /* clear rest of structure */
   que->count = que->head = que->tail = 0;
 }
 
+/* Queue slots are a preallocated slab: removing a packet only resets its
+   header fields (insert rewrites the data), and an oversize buffer stays
+   with its slot as the slot's spare for the next jumbo frame. */
+
 void ethq_remove(ETH_QUE* que)
 {
   struct eth_item* item = &que->item[que->head];
 
   if (que->count) {
-    if (item->packet.oversize)
-      free (item->packet.oversize);
-    memset(item, 0, sizeof(struct eth_item));
+    item->type = 0;
+    item->packet.oversize = NULL;
+    item->packet.len = item->packet.used = item->packet.crc_len = 0;
+    item->packet.status = 0;
     if (++que->head == que->max)
       que->head = 0;
     que->count--;
@@ -736,6 +750,7 @@ void ethq_remove(ETH_QUE* que)
 void ethq_insert_data(ETH_QUE* que, int32 type, const uint8 *data, int used, size_t len, size_t crc_len, const uint8 *crc_data, int32 status)
 {
   struct eth_item* item;
+  size_t size = MAX (len, crc_len);
 
   /* if queue empty, set pointers to beginning */
   if (!que->count) {
@@ -762,20 +777,48 @@ void ethq_insert_data(ETH_QUE* que, int32 type, const uint8 *data, int used, siz
   item->packet.len = len;
   item->packet.used = used;
   item->packet.crc_len = crc_len;
-  if (MAX (len, crc_len) <= sizeof (item->packet.msg)) {
-    memcpy(item->packet.msg, data, ((len > crc_len) ? len : crc_len));
+  if (size <= sizeof (item->packet.msg)) {
+    item->packet.oversize = NULL;
+    memcpy(item->packet.msg, data, size);
     if (crc_data && (crc_len > len))
       memcpy(&item->packet.msg[len], crc_data, ETH_CRC_SIZE);
+    if (size < ETH_MIN_PACKET)                      /* runts read as zero padded */
+      memset(&item->packet.msg[size], 0, ETH_MIN_PACKET - size);
     }
   else {
-    item->packet.oversize = (uint8 *)realloc (item->packet.oversize, ((len > crc_len) ? len : crc_len));
-    memcpy(item->packet.oversize, data, ((len > crc_len) ? len : crc_len));
+    if (item->spare_size < size) {
+      free (item->spare);
+      item->spare = (uint8 *)malloc (size);
+      item->spare_size = item->spare ? size : 0;
+      }
+    item->packet.oversize = item->spare;
+    memcpy(item->packet.oversize, data, size);
     if (crc_data && (crc_len > len))
       memcpy(&item->packet.oversize[len], crc_data, ETH_CRC_SIZE);
     }
   item->packet.status = status;
 }
 
+#if defined (USE_READER_THREAD)
+/* Hand every packet the reader thread has queued to the eth_read side in
+   one step.  read_batch is only touched by the simulator thread, so once
+   the two slabs are exchanged (under dev->lock) the packets are consumed
+   without locking, and the reader refills the empty one meanwhile.  Loss
+   and high water statistics stay with read_queue. */
+static void _eth_read_handoff (ETH_DEV* dev)
+{
+  struct eth_item* item = dev->read_batch.item;
+
+  dev->read_batch.item = dev->read_queue.item;
+  dev->read_batch.count = dev->read_queue.count;
+  dev->read_batch.head = dev->read_queue.head;
+  dev->read_batch.tail = dev->read_queue.tail;
+  dev->read_queue.item = item;
+  dev->read_queue.count = dev->read_queue.head = dev->read_queue.tail = 0;
+  ++dev->rx_handoffs;
+}
+#endif
+
 void ethq_insert(ETH_QUE* que, int32 type, ETH_PACK* pack, int32 status)
 {
 ethq_insert_data(que, type, pack->oversize ? pack->oversize : pack->msg, pack->used, pack->len, pack->crc_len, NULL, status);
@@ -963,6 +1006,12 @@ t_stat eth_check_address_conflict (ETH_DEV* dev, const ETH_MAC mac)
   {return SCPE_NOFNC;}
 t_stat eth_set_throttle (ETH_DEV* dev, uint32 time, uint32 burst, uint32 delay)
   {return SCPE_NOFNC;}
+t_stat eth_set_coalesce (ETH_DEV* dev, uint32 frames)
+  {return SCPE_NOFNC;}
+void eth_write_hold (ETH_DEV* dev)
+  {}
+void eth_write_release (ETH_DEV* dev)
+  {}
 t_stat eth_set_async (ETH_DEV *dev, int latency)
   {return SCPE_NOFNC;}
 t_stat eth_clr_async (ETH_DEV *dev)
@@ -1975,6 +2024,12 @@ _eth_callback(u_char* info, const struct pcap_pkthdr* header, const u_char* data
 
 static t_stat
 _eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine);
+static t_stat
+_eth_close_port(int eth_api, pcap_t *pcap, SOCKET pcap_fd);
+#if defined (USE_READER_THREAD)
+static void
+_eth_write_burst(ETH_DEV* dev, ETH_WRITE_REQUEST* requests, int count);
+#endif
 
 static void
 _eth_error(ETH_DEV* dev, const char* where);
@@ -2065,6 +2120,12 @@ pthread_mutex_unlock(&dev->startup_mtx);
 /* dispatch read request queue available packets */
 while (dev->reader_status == ETH_THREAD_RUNNING) {
   status = queue_func(dev);
+  if ((status > 0) && (dev->eth_api != ETH_API_NAT)) {  /* count packets taken per wakeup */
+    ++dev->rx_batches;
+    dev->rx_batch_packets += status;
+    if ((uint32)status > dev->rx_batch_max)
+      dev->rx_batch_max = status;
+    }
   if (status > 0 && dev->asynch_io) {
     int wakeup_needed;
 
@@ -2138,23 +2199,32 @@ return -1;
 #endif
 }
 
-static int queue_reader_packet(const ETH_DEV *dev, sim_packet_reader_fn reader)
+/* Once select() reports the descriptor readable, keep reading from it
+   (the TAP and UDP descriptors are non-blocking, their readers return 0
+   when nothing is pending) until it is drained or up to batch packets
+   have been taken.  A burst then costs one select() and one simulator
+   wakeup instead of one of each per packet.  Returns the number of packets
+   read, 0 on timeout or -1 on error. */
+static int queue_reader_packet(const ETH_DEV *dev, sim_packet_reader_fn reader, int batch)
 {
 int retval = do_select_fd(dev->fd_handle);
 
 if (retval > 0) {
   struct pcap_pkthdr header;
   int len;
-  u_char buf[ETH_MAX_JUMBO_FRAME];
-
-  memset(&header, 0, sizeof(header));
-  len = reader(dev, buf, sizeof(buf));
-  if (len > 0) {
+  u_char *buf = dev->rx_slab;
+
+  for (retval = 0; retval < batch; ++retval) {
+    memset(&header, 0, sizeof(header));
+    len = reader(dev, buf, ETH_MAX_JUMBO_FRAME);
+    if (len <= 0) {
+      if ((len < 0) && (retval == 0))
+        retval = -1;
+      break;
+      }
     header.caplen = header.len = len;
     _eth_callback((u_char *)dev, &header, buf);
     }
-  else if (len < 0)
-    retval = -1;
   }
 else {
   /* select()/poll() error path. */
@@ -2168,14 +2238,18 @@ return retval;
 #if HAVE_TAP_NETWORK
 static int tap_packet_reader(const ETH_DEV *dev, u_char *buf, size_t bufsiz)
 {
-  return read(dev->fd_handle, buf, bufsiz);
+int len = read(dev->fd_handle, buf, bufsiz);
+
+if ((len < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+  len = 0;                                          /* drained */
+return len;
 }
 #endif
 
 static int queue_tap_packet(const ETH_DEV *dev)
 {
 #if HAVE_TAP_NETWORK
-return queue_reader_packet(dev, tap_packet_reader);
+return queue_reader_packet(dev, tap_packet_reader, ETH_RX_BATCH);
 #else
 return -1;
 #endif
@@ -2191,21 +2265,54 @@ return vde_recv((VDECONN *) dev->handle, buf, bufsiz, 0);
 static int queue_vde_packet(const ETH_DEV *dev)
 {
 #if HAVE_VDE_NETWORK
-return queue_reader_packet(dev, vde_packet_reader);
+return queue_reader_packet(dev, vde_packet_reader, 1);
 #else
 return -1;
 #endif
 }
 
+#if defined (ETH_HAVE_RECVMMSG)
+/* Take the whole batch with a single recvmmsg() into the receive slab */
+static int queue_udp_packet(const ETH_DEV *dev)
+{
+struct mmsghdr msgs[ETH_RX_BATCH];
+struct iovec iovs[ETH_RX_BATCH];
+struct pcap_pkthdr header;
+int i, count;
+int retval = do_select_fd(dev->fd_handle);
+
+if (retval <= 0)
+  return ((retval < 0) && (errno == EINTR)) ? 0 : retval;
+memset(msgs, 0, sizeof(msgs));
+for (i = 0; i < ETH_RX_BATCH; i++) {
+  iovs[i].iov_base = dev->rx_slab + (i * ETH_MAX_JUMBO_FRAME);
+  iovs[i].iov_len = ETH_MAX_JUMBO_FRAME;
+  msgs[i].msg_hdr.msg_iov = &iovs[i];
+  msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+count = recvmmsg(dev->fd_handle, msgs, ETH_RX_BATCH, MSG_DONTWAIT, NULL);
+if (count < 0)                                      /* refused: an earlier send found no peer listening yet */
+  return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR) || (errno == ECONNREFUSED)) ? 0 : -1;
+for (i = 0; i < count; i++) {
+  if (msgs[i].msg_len == 0)                         /* same as a disconnect */
+    return -1;
+  memset(&header, 0, sizeof(header));
+  header.caplen = header.len = msgs[i].msg_len;
+  _eth_callback((u_char *)dev, &header, (u_char *)iovs[i].iov_base);
+  }
+return count;
+}
+#else
 static int udp_packet_reader(const ETH_DEV *dev, u_char *buf, size_t bufsiz)
 {
-return (int) sim_read_sock(dev->fd_handle, (char *) buf, (int32) sizeof(buf));
+return (int) sim_read_sock(dev->fd_handle, (char *) buf, (int32) bufsiz);
 }
 
 static int queue_udp_packet(const ETH_DEV *dev)
 {
-return queue_reader_packet(dev, udp_packet_reader);
+return queue_reader_packet(dev, udp_packet_reader, ETH_RX_BATCH);
 }
+#endif
 
 static int queue_slirp_packet(const ETH_DEV *dev)
 {
@@ -2261,8 +2368,17 @@ while (dev->writer_status == ETH_THREAD_IDLE) {
 
   dev->writer_status = ETH_THREAD_RUNNING;
   while (dev->writer_status == ETH_THREAD_RUNNING && NULL != (request = dev->write_requests)) {
-    /* Pull buffer off request list */
-    dev->write_requests = request->next;
+    ETH_WRITE_REQUEST *last = request;
+    int count = 1;
+    int limit = (dev->throttle_delay != ETH_THROT_DISABLED_DELAY) ? 1 : ETH_TX_BATCH;
+
+    /* Pull a burst of buffers off request list */
+    while ((count < limit) && (last->next != NULL)) {
+      last = last->next;
+      ++count;
+      }
+    dev->write_requests = last->next;
+    last->next = NULL;
     pthread_mutex_unlock (&dev->writer_lock);
 
     if (dev->throttle_delay != ETH_THROT_DISABLED_DELAY) {
@@ -2275,11 +2391,11 @@ while (dev->writer_status == ETH_THREAD_IDLE) {
         }
       dev->throttle_packet_time = sim_os_msec();
       }
-    dev->write_status = _eth_write(dev, &request->packet, NULL);
+    _eth_write_burst(dev, request, count);
 
     pthread_mutex_lock (&dev->writer_lock);
-    /* Put buffer on free buffer list */
-    request->next = dev->write_buffers;
+    /* Put buffers on free buffer list */
+    last->next = dev->write_buffers;
     dev->write_buffers = request;
     request = NULL;
     }
@@ -2317,7 +2433,7 @@ int wakeup_needed;
 dev->asynch_io = sim_asynch_enabled;
 dev->asynch_io_latency = latency;
 pthread_mutex_lock (&dev->lock);
-wakeup_needed = (dev->read_queue.count != 0);
+wakeup_needed = (dev->read_queue.count != 0) || (dev->read_batch.count != 0);
 pthread_mutex_unlock (&dev->lock);
 if (wakeup_needed) {
   sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
@@ -2355,6 +2471,51 @@ dev->throttle_mask = (1 << dev->throttle_burst) - 1;
 return SCPE_OK;
 }
 
+t_stat eth_set_coalesce (ETH_DEV* dev, uint32 frames)
+{
+if (!dev)
+  return SCPE_IERR;
+if (frames > ETH_COALESCE_MAX)
+  return SCPE_ARG;
+#if defined (USE_READER_THREAD)
+dev->tx_coalesce = frames;
+#endif
+return SCPE_OK;
+}
+
+/* Device transmit bursts
+
+   A device which sends the frames its guest queued up in one service
+   routine call brackets that work with eth_write_hold and
+   eth_write_release.  In between, eth_write queues frames without waking
+   the writer thread until tx_coalesce of them are waiting, so the writer
+   takes them as one burst rather than being woken (and usually making a
+   system call) for each one.  eth_write_release wakes the writer for
+   whatever is left.  Outside of a burst, or with tx_coalesce zero, every
+   frame is handed to the writer as soon as it is queued.
+*/
+
+void eth_write_hold (ETH_DEV* dev)
+{
+#if defined (USE_READER_THREAD)
+if ((dev) && (dev->tx_coalesce > 1))
+  dev->write_hold = TRUE;
+#endif
+}
+
+void eth_write_release (ETH_DEV* dev)
+{
+#if defined (USE_READER_THREAD)
+if ((!dev) || (!dev->write_hold))
+  return;
+pthread_mutex_lock (&dev->writer_lock);
+dev->write_hold = FALSE;
+if ((dev->write_requests != NULL) && (dev->writer_status == ETH_THREAD_IDLE))
+  pthread_cond_signal (&dev->writer_cond);
+pthread_mutex_unlock (&dev->writer_lock);
+#endif
+}
+
 static t_stat _eth_open_port(char *savname, eth_api_t *eth_api, void **handle, SOCKET *fd_handle, char errbuf[PCAP_ERRBUF_SIZE], char *bpf_filter, void *opaque, DEVICE *dptr, uint32 dbit)
 {
 int bufsz = (BUFSIZ < ETH_MAX_PACKET) ? ETH_MAX_PACKET : BUFSIZ;
@@ -2800,7 +2961,15 @@ if (1) {
   eth_thread_info_t thr_info;
   const size_t n_thr_name = sizeof(((eth_thread_info_t *) 0)->thr_name) / sizeof(char);
 
+  dev->rx_slab = (uint8 *)malloc (ETH_RX_SLAB_SIZE (dev->eth_api));
+  if (dev->rx_slab == NULL) {
+    _eth_close_port (dev->eth_api, (pcap_t *)dev->handle, dev->fd_handle);
+    free (dev->name);
+    dev->name = NULL;
+    return sim_messagef (SCPE_MEM, "Eth: can't allocate receive buffer for %s\n", savname);
+    }
   ethq_init (&dev->read_queue, 200);         /* initialize FIFO queue */
+  ethq_init (&dev->read_batch, 200);         /* and its handoff twin */
   dev->reader_status = dev->writer_status = ETH_THREAD_INIT;
 
   pthread_mutex_init (&dev->lock, NULL);
@@ -2930,6 +3099,9 @@ if (1) {
     }
   }
 ethq_destroy (&dev->read_queue);         /* release FIFO queue */
+ethq_destroy (&dev->read_batch);
+free (dev->rx_slab);
+dev->rx_slab = NULL;
 #endif
 
 /* close the device */
@@ -3285,6 +3457,59 @@ pthread_mutex_unlock (&dev->lock);
 #endif
 }
 
+/* Bookkeeping done before a packet is sent, returns whether it is a
+   loopback frame addressed to ourselves */
+static int
+_eth_write_start(ETH_DEV* dev, ETH_PACK* packet)
+{
+int loopback_self_frame = LOOPBACK_SELF_FRAME(packet->msg, packet->msg);
+int loopback_physical_response = LOOPBACK_PHYSICAL_RESPONSE(dev, packet->msg);
+
+eth_packet_trace (dev, packet->msg, packet->len, "writing");
+
+/* record sending of loopback packet (done before actual send to avoid race conditions with receiver) */
+if (loopback_self_frame || loopback_physical_response) {
+  /* Direct loopback responses to the host physical address since our physical address
+     may not have been learned yet. */
+  if (loopback_self_frame && dev->have_host_nic_phy_addr) {
+    eth_copy_mac(&packet->msg[6],  dev->host_nic_phy_hw_addr);
+    eth_copy_mac(&packet->msg[18], dev->host_nic_phy_hw_addr);
+    eth_packet_trace (dev, packet->msg, packet->len, "writing-fixed");
+  }
+#ifdef USE_READER_THREAD
+  pthread_mutex_lock (&dev->self_lock);
+#endif
+  dev->loopback_self_sent += dev->reflections;
+  dev->loopback_self_sent_total++;
+#ifdef USE_READER_THREAD
+  pthread_mutex_unlock (&dev->self_lock);
+#endif
+}
+return loopback_self_frame;
+}
+
+/* Bookkeeping done once the send status of a packet is known */
+static void
+_eth_write_done(ETH_DEV* dev, int loopback_self_frame, int status)
+{
+++dev->packets_sent;              /* basic bookkeeping */
+/* On error, correct loopback bookkeeping */
+if ((status != 0) && loopback_self_frame) {
+#ifdef USE_READER_THREAD
+  pthread_mutex_lock (&dev->self_lock);
+#endif
+  dev->loopback_self_sent -= dev->reflections;
+  dev->loopback_self_sent_total--;
+#ifdef USE_READER_THREAD
+  pthread_mutex_unlock (&dev->self_lock);
+#endif
+  }
+if (status != 0) {
+  ++dev->transmit_packet_errors;
+  _eth_error (dev, "_eth_write");
+  }
+}
+
 static
 t_stat _eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
 {
@@ -3298,29 +3523,7 @@ if (!packet) return SCPE_ARG;
 
 /* make sure packet is acceptable length */
 if ((packet->len >= ETH_MIN_PACKET) && (packet->len <= ETH_MAX_PACKET)) {
-  int loopback_self_frame = LOOPBACK_SELF_FRAME(packet->msg, packet->msg);
-  int loopback_physical_response = LOOPBACK_PHYSICAL_RESPONSE(dev, packet->msg);
-
-  eth_packet_trace (dev, packet->msg, packet->len, "writing");
-
-  /* record sending of loopback packet (done before actual send to avoid race conditions with receiver) */
-  if (loopback_self_frame || loopback_physical_response) {
-    /* Direct loopback responses to the host physical address since our physical address
-       may not have been learned yet. */
-    if (loopback_self_frame && dev->have_host_nic_phy_addr) {
-      eth_copy_mac(&packet->msg[6],  dev->host_nic_phy_hw_addr);
-      eth_copy_mac(&packet->msg[18], dev->host_nic_phy_hw_addr);
-      eth_packet_trace (dev, packet->msg, packet->len, "writing-fixed");
-    }
-#ifdef USE_READER_THREAD
-    pthread_mutex_lock (&dev->self_lock);
-#endif
-    dev->loopback_self_sent += dev->reflections;
-    dev->loopback_self_sent_total++;
-#ifdef USE_READER_THREAD
-    pthread_mutex_unlock (&dev->self_lock);
-#endif
-  }
+  int loopback_self_frame = _eth_write_start(dev, packet);
 
     /* dispatch write request (synchronous; no need to save write info to dev) */
   switch (dev->eth_api) {
@@ -3391,22 +3594,7 @@ if ((packet->len >= ETH_MIN_PACKET) && (packet->len <= ETH_MAX_PACKET)) {
       status = (((int32)packet->len == sim_write_sock (dev->fd_handle, (char *)packet->msg, (int32)packet->len)) ? 0 : -1);
       break;
     }
-  ++dev->packets_sent;              /* basic bookkeeping */
-  /* On error, correct loopback bookkeeping */
-  if ((status != 0) && loopback_self_frame) {
-#ifdef USE_READER_THREAD
-    pthread_mutex_lock (&dev->self_lock);
-#endif
-    dev->loopback_self_sent -= dev->reflections;
-    dev->loopback_self_sent_total--;
-#ifdef USE_READER_THREAD
-    pthread_mutex_unlock (&dev->self_lock);
-#endif
-    }
-  if (status != 0) {
-    ++dev->transmit_packet_errors;
-    _eth_error (dev, "_eth_write");
-    }
+  _eth_write_done(dev, loopback_self_frame, status);
 
   } /* if packet->len */
 
@@ -3417,10 +3605,73 @@ if (routine)
 return ((status == 0) ? SCPE_OK : SCPE_IOERR);
 }
 
+#if defined (USE_READER_THREAD)
+/* Send a burst of queued write requests from the writer thread */
+static void
+_eth_write_burst(ETH_DEV* dev, ETH_WRITE_REQUEST* requests, int count)
+{
+ETH_WRITE_REQUEST *request;
+t_stat status = SCPE_OK;
+
+++dev->tx_bursts;
+dev->tx_burst_packets += count;
+if ((uint32)count > dev->tx_burst_max)
+  dev->tx_burst_max = count;
+#if defined (ETH_HAVE_SENDMMSG)
+if ((dev->eth_api == ETH_API_UDP) && (count > 1)) {
+  struct mmsghdr msgs[ETH_TX_BATCH];
+  struct iovec iovs[ETH_TX_BATCH];
+  int loopback_self_frame[ETH_TX_BATCH];
+  int i, sent, msg_count = 0;
+
+  memset(msgs, 0, sizeof(msgs));
+  for (request = requests; request != NULL; request = request->next) {
+    ETH_PACK *packet = &request->packet;
+
+    if ((packet->len < ETH_MIN_PACKET) || (packet->len > ETH_MAX_PACKET)) {
+      status = SCPE_IOERR;                          /* as _eth_write, not sent */
+      continue;
+      }
+    loopback_self_frame[msg_count] = _eth_write_start(dev, packet);
+    iovs[msg_count].iov_base = packet->msg;
+    iovs[msg_count].iov_len = packet->len;
+    msgs[msg_count].msg_hdr.msg_iov = &iovs[msg_count];
+    msgs[msg_count].msg_hdr.msg_iovlen = 1;
+    ++msg_count;
+    }
+  for (i = 0; i < msg_count; i += sent) {
+    ++dev->tx_calls;
+    sent = sendmmsg(dev->fd_handle, &msgs[i], msg_count - i, 0);
+    if (sent <= 0) {                                /* this one failed, go on with the rest */
+      _eth_write_done(dev, loopback_self_frame[i], 1);
+      status = SCPE_IOERR;
+      sent = 1;
+      continue;
+      }
+    for (sent += i; i < sent; i++)
+      _eth_write_done(dev, loopback_self_frame[i], (msgs[i].msg_len == iovs[i].iov_len) ? 0 : 1);
+    sent = 0;
+    }
+  dev->write_status = status;
+  return;
+  }
+#endif
+for (request = requests; request != NULL; request = request->next) {
+  t_stat r = _eth_write(dev, &request->packet, NULL);
+
+  ++dev->tx_calls;
+  if (r != SCPE_OK)
+    status = r;
+  }
+dev->write_status = status;
+}
+#endif
+
 t_stat eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
 {
 #ifdef USE_READER_THREAD
 ETH_WRITE_REQUEST *request;
+int write_queue_size = 0;
 
 /* make sure device exists */
 if ((!dev) || (dev->eth_api == ETH_API_NONE)) return SCPE_UNATT;
@@ -3447,7 +3698,6 @@ memcpy(request->packet.msg, packet->msg, packet->len);
 /* Insert buffer at the end of the write list (to make sure that */
 /* packets make it to the wire in the order they were presented here) */
 {
-  int write_queue_size = 0;
   ETH_WRITE_REQUEST **last_request = &dev->write_requests;
 
   while (*last_request != NULL) {
@@ -3460,7 +3710,8 @@ memcpy(request->packet.msg, packet->msg, packet->len);
     dev->write_queue_peak = write_queue_size;
 }
 
-if (dev->writer_status == ETH_THREAD_IDLE) {
+if ((dev->writer_status == ETH_THREAD_IDLE) &&
+    ((!dev->write_hold) || (write_queue_size >= (int)dev->tx_coalesce))) {
   /* Awaken writer thread to perform actual write. writer_lock must remain
    * acquired during the writer_cond signal. */
   pthread_cond_signal (&dev->writer_cond);
@@ -3485,6 +3736,92 @@ key ^= 0x3f;
 return (hash[key>>3] & (1 << (key&0x7)));
 }
 
+/* Compiled receive filter
+
+   eth_filter_hash_ex compiles filter_address[] into a perfect hash table
+   of 48 bit address keys: it picks a multiplier for which the top bits of
+   key * multiplier give every distinct address its own slot, so checking
+   a frame's destination (or source) is one multiply and one compare no
+   matter how many addresses are set.  If no such multiplier turns up the
+   table isn't used and filter_address[] is scanned as before.
+
+   The AUTODIN II multicast hash needs a CRC of the destination address,
+   so the result for each multicast destination seen is cached, tagged
+   with the filter generation which every filter change bumps.
+*/
+
+#define ETH_FILTER_SHIFT  58                            /* 64 - log2(ETH_FILTER_SLOTS) */
+#define ETH_MCAST_SHIFT   56                            /* 64 - log2(ETH_MCAST_CACHE) */
+#define ETH_KEY_EMPTY     (~(t_uint64)0)
+#define ETH_MC_VALID      (((t_uint64)1) << 63)
+#define ETH_MC_HIT        (((t_uint64)1) << 62)
+#define ETH_MC_GEN(g)     (((t_uint64)((g) & 0x3FFF)) << 48)
+#define ETH_MAC_MULT      0x9E3779B97F4A7C15ull         /* 2^64 / golden ratio */
+
+static SIM_INLINE t_uint64
+_eth_mac_key(const u_char* mac)
+{
+return ((t_uint64)mac[0] << 40) | ((t_uint64)mac[1] << 32) | ((t_uint64)mac[2] << 24) |
+       ((t_uint64)mac[3] << 16) | ((t_uint64)mac[4] << 8) | (t_uint64)mac[5];
+}
+
+static void
+_eth_filter_compile(ETH_DEV* dev)
+{
+t_uint64 table[ETH_FILTER_SLOTS];
+t_uint64 mult = ETH_MAC_MULT;
+int i, j, tries;
+
+for (tries = 0; tries < 1000; tries++) {
+  for (j = 0; j < ETH_FILTER_SLOTS; j++)
+    table[j] = ETH_KEY_EMPTY;
+  for (i = 0; i < dev->addr_count; i++) {
+    t_uint64 key = _eth_mac_key(dev->filter_address[i]);
+    int slot = (int)((key * mult) >> ETH_FILTER_SHIFT);
+
+    if (table[slot] == ETH_KEY_EMPTY)
+      table[slot] = key;
+    else if (table[slot] != key)                    /* collision (duplicates are fine) */
+      break;
+    }
+  if (i == dev->addr_count)
+    break;
+  mult = (mult * 6364136223846793005ull + 1442695040888963407ull) | 1;
+  }
+memcpy(dev->filter_table, table, sizeof(table));
+dev->filter_mult = (tries < 1000) ? mult : 0;
+if ((++dev->filter_gen & 0x3FFF) == 0)              /* generation tag wrapped? */
+  memset(dev->mcast_cache, 0, sizeof(dev->mcast_cache));
+}
+
+static SIM_INLINE int
+_eth_filter_match(const ETH_DEV* dev, const u_char* mac)
+{
+int i;
+
+if (dev->filter_mult) {
+  t_uint64 key = _eth_mac_key(mac);
+
+  return (dev->filter_table[(key * dev->filter_mult) >> ETH_FILTER_SHIFT] == key);
+  }
+for (i = 0; i < dev->addr_count; i++)
+  if (eth_mac_cmp(mac, dev->filter_address[i]) == 0)
+    return 1;
+return 0;
+}
+
+static int
+_eth_hash_match(ETH_DEV* dev, const u_char* data)
+{
+t_uint64 key = _eth_mac_key(data);
+t_uint64 tag = key | ETH_MC_GEN(dev->filter_gen) | ETH_MC_VALID;
+t_uint64 *entry = &dev->mcast_cache[(key * ETH_MAC_MULT) >> ETH_MCAST_SHIFT];
+
+if ((*entry & ~ETH_MC_HIT) != tag)                  /* not cached? */
+  *entry = tag | (_eth_hash_lookup(dev->hash, data) ? ETH_MC_HIT : 0);
+return ((*entry & ETH_MC_HIT) != 0);
+}
+
 #if 0
 static int
 _eth_hash_validate(ETH_MAC *MultiCastList[], int count, ETH_MULTIHASH hash)
@@ -4003,7 +4340,7 @@ switch (dev->eth_api) {
     to_me = 1;
     /* AUTODIN II hash mode? */
     if ((dev->hash_filter) && (data[0] & 0x01) && (!dev->promiscuous) && (!dev->all_multicast))
-      to_me = _eth_hash_lookup(dev->hash, data);
+      to_me = _eth_hash_match(dev, data);
     break;
 #endif /* USE_BPF */
   case ETH_API_TAP:
@@ -4015,10 +4352,8 @@ switch (dev->eth_api) {
     to_me = 0;
     eth_packet_trace (dev, data, header->len, "received");
 
-    for (i = 0; i < dev->addr_count; i++) {
-      if (eth_mac_cmp(data, dev->filter_address[i]) == 0) to_me = 1;
-      if (eth_mac_cmp(&data[6], dev->filter_address[i]) == 0) from_me = 1;
-    }
+    to_me = _eth_filter_match(dev, data);
+    from_me = _eth_filter_match(dev, &data[6]);
 
     /* all multicast mode? */
     if (dev->all_multicast && (data[0] & 0x01)) to_me = 1;
@@ -4028,7 +4363,7 @@ switch (dev->eth_api) {
 
     /* AUTODIN II hash mode? */
     if ((dev->hash_filter) && (!to_me) && (data[0] & 0x01))
-      to_me = _eth_hash_lookup(dev->hash, data);
+      to_me = _eth_hash_match(dev, data);
     break;
   default:
     bpf_used = to_me = 0;                           /* Should NEVER happen */
@@ -4287,16 +4622,20 @@ if (status < 0) {
 #else /* USE_READER_THREAD */
 
   status = 0;
-  pthread_mutex_lock (&dev->lock);
-  if (dev->read_queue.count > 0) {
-    ETH_ITEM* item = &dev->read_queue.item[dev->read_queue.head];
+  if (dev->read_batch.count == 0) {             /* current batch consumed? */
+    pthread_mutex_lock (&dev->lock);
+    if (dev->read_queue.count > 0)
+      _eth_read_handoff (dev);                  /* take everything queued */
+    pthread_mutex_unlock (&dev->lock);
+    }
+  if (dev->read_batch.count > 0) {
+    ETH_ITEM* item = &dev->read_batch.item[dev->read_batch.head];
     packet->len = item->packet.len;
     packet->crc_len = item->packet.crc_len;
     memcpy(packet->msg, item->packet.msg, ((packet->len > packet->crc_len) ? packet->len : packet->crc_len));
     status = 1;
-    ethq_remove(&dev->read_queue);
+    ethq_remove(&dev->read_batch);
   }
-  pthread_mutex_unlock (&dev->lock);
   if ((status) && (routine))
     routine(0);
 #endif
@@ -4457,6 +4796,7 @@ if (hash) {
                                   dev->hash[0], dev->hash[1], dev->hash[2], dev->hash[3],
                                   dev->hash[4], dev->hash[5], dev->hash[6], dev->hash[7]);
   }
+_eth_filter_compile(dev);                           /* also retires cached hash results */
 
 /* print out filter information if debugging */
 if (dev->dptr->dctrl & dev->dbit) {
@@ -4559,6 +4899,7 @@ if (dev->eth_api == ETH_API_PCAP) {
 #ifdef USE_READER_THREAD
   pthread_mutex_lock (&dev->lock);
   ethq_clear (&dev->read_queue); /* Empty FIFO Queue when filter list changes */
+  ethq_clear (&dev->read_batch);
   pthread_mutex_unlock (&dev->lock);
 #endif
   }
@@ -4611,7 +4952,21 @@ if (dev->throttle_count)
 fprintf(st, "  Read Queue: Count:       %d\n", dev->read_queue.count);
 fprintf(st, "  Read Queue: High:        %d\n", dev->read_queue.high);
 fprintf(st, "  Read Queue: Loss:        %d\n", dev->read_queue.loss);
+if (dev->rx_batches) {
+  fprintf(st, "  Receive Batches:         %u\n", dev->rx_batches);
+  fprintf(st, "  Receive Batch: Average:  %.1f packets\n", (double)dev->rx_batch_packets / dev->rx_batches);
+  fprintf(st, "  Receive Batch: Max:      %u packets\n", dev->rx_batch_max);
+  fprintf(st, "  Read Queue Handoffs:     %u\n", dev->rx_handoffs);
+  }
 fprintf(st, "  Peak Write Queue Size:   %d\n", dev->write_queue_peak);
+if (dev->tx_coalesce)
+  fprintf(st, "  Transmit Coalescing:     %d frames\n", (int)dev->tx_coalesce);
+if (dev->tx_bursts) {
+  fprintf(st, "  Transmit Bursts:         %d\n", (int)dev->tx_bursts);
+  fprintf(st, "  Transmit Burst Average:  %.1f\n", (double)dev->tx_burst_packets / dev->tx_bursts);
+  fprintf(st, "  Transmit Burst Max:      %d\n", (int)dev->tx_burst_max);
+  fprintf(st, "  Transmit System Calls:   %d\n", (int)dev->tx_calls);
+  }
 #endif
 if (dev->error_needs_reset)
   fprintf(st, "  In Error Needs Reset:    True\n");
@@ -4691,6 +5046,254 @@ for (val=0; val <= 0xFF; val++) {
 return (errors == 0) ? SCPE_OK : SCPE_IERR;
 }
 
+static
+t_stat eth_test_queue (DEVICE *dptr)
+{
+int errors = 0;
+int i;
+ETH_QUE que;
+ETH_ITEM *item;
+uint8 *spare;
+static uint8 frame[ETH_FRAME_SIZE + 100];
+
+for (i = 0; i < (int)sizeof (frame); i++)
+  frame[i] = (uint8)(i + 1);
+memset (&que, 0, sizeof (que));
+if (ethq_init (&que, 4) != SCPE_OK)
+  return SCPE_MEM;
+ethq_insert_data (&que, ETH_ITM_NORMAL, frame, 0, 20, 0, NULL, 0);
+item = &que.item[que.head];
+if ((item->packet.len != 20) || (item->packet.oversize != NULL) ||
+    (memcmp (item->packet.msg, frame, 20) != 0) ||
+    (item->packet.msg[20] != 0) || (item->packet.msg[ETH_MIN_PACKET - 1] != 0)) {
+  printf ("Runt packet not queued zero padded\n");
+  ++errors;
+  }
+ethq_remove (&que);
+ethq_insert_data (&que, ETH_ITM_NORMAL, frame, 0, sizeof (frame), 0, NULL, 0);
+item = &que.item[que.head];
+spare = item->packet.oversize;
+if ((spare == NULL) || (memcmp (spare, frame, sizeof (frame)) != 0)) {
+  printf ("Oversize packet not queued\n");
+  ++errors;
+  }
+ethq_remove (&que);
+if (item->packet.oversize != NULL) {
+  printf ("Oversize buffer still referenced by removed packet\n");
+  ++errors;
+  }
+for (i = 0; i < 3; i++)                             /* come around to the same slot */
+  ethq_insert_data (&que, ETH_ITM_NORMAL, frame, 0, 100, 0, NULL, 0);
+while (que.count)
+  ethq_remove (&que);
+ethq_insert_data (&que, ETH_ITM_NORMAL, frame, 0, sizeof (frame) - 10, 0, NULL, 0);
+if (que.item[que.head].packet.oversize != spare) {
+  printf ("Oversize buffer not reused\n");
+  ++errors;
+  }
+for (i = 0; i < 6; i++)                             /* overflow, oldest lost */
+  ethq_insert_data (&que, ETH_ITM_NORMAL, frame + i, 0, 100, 0, NULL, 0);
+if ((que.count != 4) || (que.loss != 3) ||
+    (que.item[que.head].packet.oversize != NULL) ||
+    (que.item[que.head].packet.msg[0] != frame[2])) {
+  printf ("Queue overflow mishandled\n");
+  ++errors;
+  }
+ethq_destroy (&que);
+#if defined (USE_READER_THREAD)
+if (1) {                                            /* reader to eth_read handoff */
+  ETH_DEV dev;
+  ETH_PACK pack;
+
+  eth_zero (&dev);
+  dev.eth_api = ETH_API_UDP;
+  pthread_mutex_init (&dev.lock, NULL);
+  ethq_init (&dev.read_queue, 8);
+  ethq_init (&dev.read_batch, 8);
+  for (i = 0; i < 5; i++)
+    ethq_insert_data (&dev.read_queue, ETH_ITM_NORMAL, frame + i, 0, 64, 0, NULL, 0);
+  for (i = 0; eth_read (&dev, &pack, NULL); i++) {
+    if ((i == 2) && (dev.read_queue.count == 0))    /* reader queues more meanwhile */
+      ethq_insert_data (&dev.read_queue, ETH_ITM_NORMAL, frame + 5, 0, 64, 0, NULL, 0);
+    if ((pack.len != 64) || (pack.msg[0] != frame[i])) {
+      printf ("Packet %d out of order after handoff\n", i);
+      ++errors;
+      }
+    }
+  if ((i != 6) || (dev.rx_handoffs != 2)) {
+    printf ("Handoff delivered %d packets in %u handoffs\n", i, dev.rx_handoffs);
+    ++errors;
+    }
+  ethq_destroy (&dev.read_queue);
+  ethq_destroy (&dev.read_batch);
+  pthread_mutex_destroy (&dev.lock);
+  }
+#endif
+return (errors == 0) ? SCPE_OK : SCPE_IERR;
+}
+
+static
+t_stat eth_test_filter (DEVICE *dptr)
+{
+int errors = 0;
+int i, j, pass, hits[2] = {0, 0};
+int frame_count = (sim_deb != NULL) ? 200000 : 64;  /* timed only when debugging */
+uint32 msec[2];
+ETH_DEV dev;
+ETH_MAC frames[64];
+ETH_MULTIHASH hash = {0x01, 0x40, 0x00, 0x00, 0x48, 0x88, 0x40, 0x00};
+
+eth_zero (&dev);
+for (i = 0; i < ETH_FILTER_MAX - 1; i++) {         /* DECnet style unicast and multicast */
+  ETH_MAC mac = {0xAA, 0x00, 0x04, 0x00, 0x00, 0x00};
+
+  mac[0] = (i & 1) ? 0xAB : 0xAA;
+  mac[4] = (uint8)(i * 7);
+  mac[5] = (uint8)(i * 3 + 0x10);
+  eth_copy_mac (dev.filter_address[i], mac);
+  }
+memset (dev.filter_address[i++], 0xFF, sizeof (ETH_MAC));
+dev.addr_count = i;
+dev.hash_filter = TRUE;
+memcpy (dev.hash, hash, sizeof (hash));
+_eth_filter_compile (&dev);
+if (dev.filter_mult == 0)
+  printf ("No perfect hash for the address filter, scanning instead\n");
+for (i = 0; i < 64; i++) {                          /* half of them in the filter */
+  if ((i & 1) && (i < 2 * dev.addr_count))
+    eth_copy_mac (frames[i], dev.filter_address[i / 2]);
+  else {
+    frames[i][0] = (uint8)((i & 2) ? 0x01 : 0x02);
+    frames[i][1] = (uint8)(i * 37);
+    frames[i][2] = 0x5E;
+    frames[i][3] = (uint8)(i * 11);
+    frames[i][4] = (uint8)(i >> 3);
+    frames[i][5] = (uint8)i;
+    }
+  }
+for (i = 0; i < 64; i++) {
+  int old_to_me = 0;
+
+  for (j = 0; j < dev.addr_count; j++)
+    if (eth_mac_cmp (frames[i], dev.filter_address[j]) == 0)
+      old_to_me = 1;
+  if ((!old_to_me) && (frames[i][0] & 0x01))
+    old_to_me = (_eth_hash_lookup (dev.hash, frames[i]) != 0);
+  for (pass = 0; pass < 2; pass++) {                /* uncached and cached */
+    int to_me = _eth_filter_match (&dev, frames[i]);
+
+    if ((!to_me) && (frames[i][0] & 0x01))
+      to_me = _eth_hash_match (&dev, frames[i]);
+    if (to_me != old_to_me) {
+      printf ("Filter mismatch for frame %d pass %d: %d vs %d\n", i, pass, to_me, old_to_me);
+      ++errors;
+      }
+    }
+  }
+memset (dev.hash, 0, sizeof (dev.hash));            /* filter change retires the cache */
+_eth_filter_compile (&dev);
+for (i = 0; i < 64; i++)
+  if (_eth_hash_match (&dev, frames[i])) {
+    printf ("Stale multicast hash result for frame %d\n", i);
+    ++errors;
+    }
+memcpy (dev.hash, hash, sizeof (hash));
+_eth_filter_compile (&dev);
+for (pass = 0; pass < 2; pass++) {                  /* scan and hash vs compiled filter */
+  msec[pass] = sim_os_msec ();
+  for (i = 0; i < frame_count; i++) {
+    const uint8 *mac = frames[i & 63];
+    int to_me = 0;
+
+    if (pass == 0) {
+      for (j = 0; j < dev.addr_count; j++)
+        if (eth_mac_cmp (mac, dev.filter_address[j]) == 0)
+          to_me = 1;
+      if ((!to_me) && (mac[0] & 0x01))
+        to_me = (_eth_hash_lookup (dev.hash, mac) != 0);
+      }
+    else {
+      to_me = _eth_filter_match (&dev, mac);
+      if ((!to_me) && (mac[0] & 0x01))
+        to_me = _eth_hash_match (&dev, mac);
+      }
+    hits[pass] += to_me;
+    }
+  msec[pass] = sim_os_msec () - msec[pass];
+  }
+if (hits[0] != hits[1]) {
+  printf ("Filter benchmark matched %d vs %d frames\n", hits[1], hits[0]);
+  ++errors;
+  }
+if (sim_deb != NULL)
+  sim_printf ("%s: Receive filter for %d addresses: %u ms scanning, %u ms compiled\n",
+              dptr->name, dev.addr_count, msec[0], msec[1]);
+return (errors == 0) ? SCPE_OK : SCPE_IERR;
+}
+
+static
+t_stat eth_test_coalesce (DEVICE *dptr)
+{
+int errors = 0;
+#if defined (USE_READER_THREAD)
+ETH_DEV tx, rx;
+ETH_PACK pack;
+int i, received = 0;
+uint32 start, sent, bursts, calls;
+
+if (eth_open (&rx, "udp:36012:127.0.0.1:36011", dptr, 0) != SCPE_OK) {  /* receiver listening first */
+  sim_printf ("%s: Can't open UDP loopback port, skipping transmit burst test\n", dptr->name);
+  return SCPE_OK;
+  }
+if (eth_open (&tx, "udp:36011:127.0.0.1:36012", dptr, 0) != SCPE_OK) {
+  sim_printf ("%s: Can't open UDP loopback port, skipping transmit burst test\n", dptr->name);
+  eth_close (&rx);
+  return SCPE_OK;
+  }
+eth_filter (&rx, 0, NULL, FALSE, TRUE);
+eth_set_coalesce (&tx, 8);
+sim_os_ms_sleep (100);                              /* let anything eth_open sent go out */
+sent = tx.packets_sent;
+bursts = tx.tx_bursts;
+calls = tx.tx_calls;
+eth_write_hold (&tx);
+memset (&pack, 0, sizeof (pack));
+pack.len = 100;
+for (i = 0; i < 20; i++) {
+  memset (pack.msg, 0xFF, 6);                       /* broadcast */
+  pack.msg[6] = 0xAA;
+  pack.msg[14] = (uint8)i;
+  eth_write (&tx, &pack, NULL);
+  }
+eth_write_release (&tx);
+for (start = sim_os_msec (); (received < 20) && (sim_os_msec () - start < 2000); ) {
+  if (!eth_read (&rx, &pack, NULL)) {
+    sim_os_ms_sleep (1);
+    continue;
+    }
+  if (pack.msg[14] != (uint8)received) {
+    printf ("Burst frame %d arrived as frame %d\n", pack.msg[14], received);
+    ++errors;
+    }
+  ++received;
+  }
+sent = tx.packets_sent - sent;
+bursts = tx.tx_bursts - bursts;
+calls = tx.tx_calls - calls;
+if ((received != 20) || (sent != 20) || (bursts >= 20)) {
+  printf ("Transmit burst: %d of 20 frames received, %u sent in %u bursts\n",
+          received, sent, bursts);
+  ++errors;
+  }
+else if (sim_deb != NULL)
+  sim_printf ("%s: Transmit burst: 20 frames sent in %u bursts with %u system calls\n",
+              dptr->name, bursts, calls);
+eth_close (&rx);
+eth_close (&tx);
+#endif
+return (errors == 0) ? SCPE_OK : SCPE_IERR;
+}
+
 static
 t_stat eth_test_bpf (DEVICE *dptr)
 {
@@ -4844,6 +5447,9 @@ SIM_TEST_INIT;
 sim_printf ("Testing %s device sim_ether APIs\n", dptr->name);
 
 SIM_TEST(eth_test_crc32 (dptr));
+SIM_TEST(eth_test_queue (dptr));
+SIM_TEST(eth_test_filter (dptr));
+SIM_TEST(eth_test_coalesce (dptr));
 SIM_TEST(eth_test_bpf (dptr));
 return stat;
 }
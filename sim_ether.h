@@ -167,6 +167,12 @@ extern "C" {
 #define ETH_CRC_SIZE           4                        /* ethernet CRC size */
 #define ETH_FRAME_SIZE (ETH_MAX_PACKET+ETH_CRC_SIZE)    /* ethernet maximum frame size */
 #define ETH_MIN_JUMBO_FRAME ETH_MAX_PACKET              /* Threshold size for Jumbo Frame Processing */
+#define ETH_RX_BATCH          16                        /* maximum packets taken per reader wakeup */
+#define ETH_TX_BATCH          16                        /* maximum packets sent per writer burst */
+#define ETH_COALESCE_DEFAULT   8                        /* frames held per device transmit burst */
+#define ETH_COALESCE_MAX     256                        /* largest transmit coalescing threshold */
+#define ETH_FILTER_SLOTS      64                        /* compiled address filter table size */
+#define ETH_MCAST_CACHE      256                        /* cached multicast hash results */
 
 #define LOOPBACK_SELF_FRAME(phy_mac, msg)                                                     \
     (((msg)[12] == 0x90) && ((msg)[13] == 0x00) &&              /* Ethernet Loopback */       \
@@ -220,6 +226,8 @@ struct eth_item {
 #define ETH_ITM_LOOPBACK 1
 #define ETH_ITM_NORMAL   2
   struct eth_packet   packet;
+  uint8               *spare;                           /* oversize buffer kept for reuse by this slot */
+  size_t              spare_size;                       /* allocated size of spare */
 };
 
 struct eth_queue {
@@ -300,6 +308,10 @@ struct eth_device {
   ETH_BOOL      all_multicast;                          /* receive all multicast messages */
   ETH_BOOL      hash_filter;                            /* filter using AUTODIN II multicast hash */
   ETH_MULTIHASH hash;                                   /* AUTODIN II multicast hash */
+  t_uint64      filter_table[ETH_FILTER_SLOTS];         /* filter_address[] as a perfect hash table */
+  t_uint64      filter_mult;                            /* its multiplier (0 = scan filter_address[]) */
+  uint32        filter_gen;                             /* filter generation, tags mcast_cache */
+  t_uint64      mcast_cache[ETH_MCAST_CACHE];           /* AUTODIN II hash results by destination */
   int32         loopback_self_sent;                     /* loopback packets sent but not seen */
   int32         loopback_self_sent_total;               /* total loopback packets sent */
   int32         loopback_self_rcvd_total;               /* total loopback packets seen */
@@ -339,7 +351,13 @@ struct eth_device {
 #if defined (USE_READER_THREAD)
   t_bool           asynch_io;                           /* Asynchronous Interrupt scheduling enabled */
   int           asynch_io_latency;                      /* instructions to delay pending interrupt */
-  ETH_QUE       read_queue;
+  ETH_QUE       read_queue;                             /* packets queued by the reader thread */
+  ETH_QUE       read_batch;                             /* packets handed to eth_read callers */
+  uint8         *rx_slab;                               /* reader thread receive buffers */
+  uint32        rx_batches;                             /* reader wakeups which queued packets */
+  uint32        rx_batch_packets;                       /* packets taken in those wakeups */
+  uint32        rx_batch_max;                           /* most packets taken in one wakeup */
+  uint32        rx_handoffs;                            /* read_queue to read_batch handoffs */
   pthread_mutex_t     lock;
   pthread_t     reader_thread;                          /* Reader Thread Id */
   eth_thr_status_t reader_status;                       /* Reader thread status */
@@ -352,6 +370,12 @@ struct eth_device {
   int write_queue_peak;
   ETH_WRITE_REQUEST *write_buffers;
   t_stat write_status;
+  uint32        tx_coalesce;                            /* frames held during a burst before waking the writer */
+  t_bool        write_hold;                             /* device transmit burst in progress */
+  uint32        tx_bursts;                              /* writer wakeups which sent packets */
+  uint32        tx_burst_packets;                       /* packets sent in those wakeups */
+  uint32        tx_burst_max;                           /* most packets sent in one wakeup */
+  uint32        tx_calls;                               /* system calls made sending them */
 
   /* Thread startup state. */
   pthread_mutex_t startup_mtx;
@@ -393,6 +417,9 @@ void eth_setcrc   (ETH_DEV* dev, int need_crc);         /* enable/disable CRC mo
 t_stat eth_set_async (ETH_DEV* dev, int latency);       /* set read behavior to be async */
 t_stat eth_clr_async (ETH_DEV* dev);                    /* set read behavior to be not async */
 t_stat eth_set_throttle (ETH_DEV* dev, uint32 time, uint32 burst, uint32 delay); /* set transmit throttle parameters */
+t_stat eth_set_coalesce (ETH_DEV* dev, uint32 frames);  /* set transmit coalescing threshold */
+void eth_write_hold (ETH_DEV* dev);                     /* start a transmit burst */
+void eth_write_release (ETH_DEV* dev);                  /* end a transmit burst, flushing it */
 uint32 eth_crc32(uint32 crc, const void* vbuf, size_t len); /* Compute Ethernet Autodin II CRC for buffer */
 
 void eth_packet_trace (ETH_DEV* dev, const uint8 *msg, int len, const char* txt); /* trace ethernet packet header+crc */
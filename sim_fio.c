@@ -49,11 +49,17 @@
    sim_fsize_name    -       get file size of named file
    sim_fsize_ex      -       get file size as a t_offset
    sim_fsize_name_ex -       get file size as a t_offset of named file
+   sim_punch_hole    -       deallocate the storage behind a range of a file
    sim_buf_copy_swapped -    copy data swapping elements along the way
    sim_buf_swap_data -       swap data elements inplace in buffer if needed
    sim_byte_swap_data -      swap data elements inplace in buffer
+   sim_buf_pack_36   -       pack pairs of 36 bit words into 9 bytes
+   sim_buf_unpack_36 -       unpack pairs of 36 bit words from 9 bytes
    sim_shmem_open            create or attach to a shared memory region
    sim_shmem_close           close a shared memory region
+   sim_fmap_open             map an open file into memory
+   sim_fmap_sync             flush a file mapping to its file
+   sim_fmap_close            unmap a file mapping
    sim_chdir                 change working directory
    sim_mkdir                 create a directory
    sim_rmdir                 remove a directory
@@ -171,45 +177,54 @@ void sim_byte_swap_data (void *bptr, size_t size, size_t count)
      * 142 |         *sptr++ = *(dptr + k);
      */
 
-    for (j = 0; j < count; j++) {                           /* loop on items */
 #if defined(USE_BSWAP_INTRINSIC)
-        switch (size) {
-        case sizeof(uint16):
-            *((uint16 *) sptr) = sim_bswap16 (*((uint16 *) sptr));
-            break;
-
-        case sizeof(uint32):
-            *((uint32 *) sptr) = sim_bswap32 (*((uint32 *) sptr));
-            break;
+    /* Well known sizes get a loop of their own so the compiler can
+       turn it into vector byte shuffles */
+    switch (size) {
+    case sizeof(uint16): {
+        uint16 *wptr = (uint16 *) bptr;
+
+        for (j = 0; j < count; j++)
+            wptr[j] = sim_bswap16 (wptr[j]);
+        return;
+        }
 
-        case sizeof(t_uint64):
-            *((t_uint64 *) sptr) = sim_bswap64 (*((t_uint64 *) sptr));
-            break;
+    case sizeof(uint32): {
+        uint32 *lptr = (uint32 *) bptr;
 
-        default:
-#endif
+        for (j = 0; j < count; j++)
+            lptr[j] = sim_bswap32 (lptr[j]);
+        return;
+        }
 
-            {
-                /* Either there aren't any intrinsics that do byte swapping or
-                 * it's not a well known size. */
-                uint8 *dptr;
-                size_t k;
-                const size_t midpoint = (size + 1) / 2;
-
-                dptr = sptr + size - 1;
-                for (k = size - 1; k >= midpoint; k--) {
-                    uint8 by = *sptr;                       /* swap end-for-end */
-                    *sptr++ = *dptr;
-                    *dptr-- = by;
-                }
-            }
+    case sizeof(t_uint64): {
+        t_uint64 *qptr = (t_uint64 *) bptr;
 
-#if defined(USE_BSWAP_INTRINSIC)
-            break;
+        for (j = 0; j < count; j++)
+            qptr[j] = sim_bswap64 (qptr[j]);
+        return;
         }
+
+    default:
+        break;
+    }
 #endif
 
-        sptr += size;                                       /* next item */
+    for (j = 0; j < count; j++) {                           /* loop on items */
+        /* Either there aren't any intrinsics that do byte swapping or
+         * it's not a well known size. */
+        uint8 *dptr;
+        size_t k;
+        const size_t midpoint = (size + 1) / 2;
+
+        dptr = sptr + size - 1;
+        for (k = size - 1; k >= midpoint; k--) {
+            uint8 by = *sptr;                               /* swap end-for-end */
+            *sptr++ = *dptr;
+            *dptr-- = by;
+        }
+
+        sptr += midpoint;                                   /* next item */
     }
 }
 
@@ -236,6 +251,24 @@ if (sim_end || (size == sizeof (char))) {
     memcpy (dptr, sptr, size * count);
     return;
     }
+#if defined(USE_BSWAP_INTRINSIC)
+switch (size) {
+    case sizeof(uint16):
+        for (j = 0; j < count; j++)
+            ((uint16 *)dptr)[j] = sim_bswap16 (((const uint16 *)sptr)[j]);
+        return;
+    case sizeof(uint32):
+        for (j = 0; j < count; j++)
+            ((uint32 *)dptr)[j] = sim_bswap32 (((const uint32 *)sptr)[j]);
+        return;
+    case sizeof(t_uint64):
+        for (j = 0; j < count; j++)
+            ((t_uint64 *)dptr)[j] = sim_bswap64 (((const t_uint64 *)sptr)[j]);
+        return;
+    default:
+        break;
+    }
+#endif
 for (j = 0; j < count; j++) {                           /* loop on items */
     /* Unsigned countdown loop. Predecrement k before it's used inside the
        loop so that k == 0 in the loop body to process the last item, then
@@ -247,6 +280,83 @@ for (j = 0; j < count; j++) {                           /* loop on items */
     }
 }
 
+/* 36 bit words packed two to a 9 byte group (the KLH10 disk formats)
+
+   In the big endian form the 72 bits of a word pair are stored high order
+   byte first, word 0 bit 0 first.  In the little endian form they're stored
+   low order byte first, word 0 bit 35 first.  Each group is handled as a
+   64 bit load or store plus one byte, which compilers reduce to a single
+   (byte swapping where needed) memory access.  The count is the number of
+   words and is rounded down to a whole number of pairs. */
+
+#define W36_MASK    ((((t_uint64)1) << 36) - 1)
+#define W28_MASK    ((((t_uint64)1) << 28) - 1)
+
+static SIM_INLINE t_uint64 _sim_get_be64 (const uint8 *p)
+{
+return (((t_uint64)p[0]) << 56) | (((t_uint64)p[1]) << 48) | (((t_uint64)p[2]) << 40) | (((t_uint64)p[3]) << 32) |
+       (((t_uint64)p[4]) << 24) | (((t_uint64)p[5]) << 16) | (((t_uint64)p[6]) << 8)  | ((t_uint64)p[7]);
+}
+
+static SIM_INLINE t_uint64 _sim_get_le64 (const uint8 *p)
+{
+return (((t_uint64)p[7]) << 56) | (((t_uint64)p[6]) << 48) | (((t_uint64)p[5]) << 40) | (((t_uint64)p[4]) << 32) |
+       (((t_uint64)p[3]) << 24) | (((t_uint64)p[2]) << 16) | (((t_uint64)p[1]) << 8)  | ((t_uint64)p[0]);
+}
+
+static SIM_INLINE void _sim_put_be64 (uint8 *p, t_uint64 v)
+{
+p[0] = (uint8)(v >> 56); p[1] = (uint8)(v >> 48); p[2] = (uint8)(v >> 40); p[3] = (uint8)(v >> 32);
+p[4] = (uint8)(v >> 24); p[5] = (uint8)(v >> 16); p[6] = (uint8)(v >> 8);  p[7] = (uint8)v;
+}
+
+static SIM_INLINE void _sim_put_le64 (uint8 *p, t_uint64 v)
+{
+p[7] = (uint8)(v >> 56); p[6] = (uint8)(v >> 48); p[5] = (uint8)(v >> 40); p[4] = (uint8)(v >> 32);
+p[3] = (uint8)(v >> 24); p[2] = (uint8)(v >> 16); p[1] = (uint8)(v >> 8);  p[0] = (uint8)v;
+}
+
+void sim_buf_unpack_36 (t_uint64 *dbuf, const uint8 *sbuf, size_t count, t_bool big_endian)
+{
+size_t j;
+t_uint64 v;
+
+count &= ~((size_t)1);
+if (big_endian) {
+    for (j = 0; j < count; j += 2, sbuf += 9) {
+        v = _sim_get_be64 (sbuf);
+        dbuf[j] = v >> 28;
+        dbuf[j + 1] = ((v & W28_MASK) << 8) | sbuf[8];
+        }
+    }
+else {
+    for (j = 0; j < count; j += 2, sbuf += 9) {
+        v = _sim_get_le64 (sbuf);
+        dbuf[j] = v & W36_MASK;
+        dbuf[j + 1] = (v >> 36) | (((t_uint64)sbuf[8]) << 28);
+        }
+    }
+}
+
+void sim_buf_pack_36 (uint8 *dbuf, const t_uint64 *sbuf, size_t count, t_bool big_endian)
+{
+size_t j;
+
+count &= ~((size_t)1);
+if (big_endian) {
+    for (j = 0; j < count; j += 2, dbuf += 9) {
+        _sim_put_be64 (dbuf, ((sbuf[j] & W36_MASK) << 28) | ((sbuf[j + 1] >> 8) & W28_MASK));
+        dbuf[8] = (uint8)sbuf[j + 1];
+        }
+    }
+else {
+    for (j = 0; j < count; j += 2, dbuf += 9) {
+        _sim_put_le64 (dbuf, (sbuf[j] & W36_MASK) | (sbuf[j + 1] << 36));
+        dbuf[8] = (uint8)(sbuf[j + 1] >> 28);
+        }
+    }
+}
+
 size_t sim_fwrite (const void *bptr, size_t size, size_t count, FILE *fptr)
 {
 size_t c, nelem, nbuf, lcnt, total;
@@ -271,7 +381,7 @@ sptr = (const unsigned char *) bptr;                    /* init input ptr */
 for (i = (int32)nbuf; i > 0; i--) {                     /* loop on buffers */
     c = (i == 1)? lcnt: nelem;
     sim_buf_copy_swapped (sim_flip, sptr, size, c);
-    sptr = sptr + size * count;
+    sptr = sptr + size * c;
     c = fwrite (sim_flip, size, c, fptr);
     if (c == 0) {
         free(sim_flip);
@@ -680,6 +790,12 @@ int sim_set_fsize (FILE *fptr, t_addr size)
 return _chsize(_fileno(fptr), (long)size);
 }
 
+int sim_punch_hole (FILE *fptr, t_offset offset, t_offset size)
+{
+errno = ENOSYS;
+return -1;
+}
+
 int sim_set_fifo_nonblock (FILE *fptr)
 {
 return -1;
@@ -767,6 +883,66 @@ t_bool sim_shmem_atomic_cas (int32 *ptr, int32 oldv, int32 newv)
 return (InterlockedCompareExchange ((LONG volatile *) ptr, newv, oldv) == oldv);
 }
 
+struct FILEMAP {
+    HANDLE hMapping;
+    size_t map_size;
+    void *map_base;
+    t_bool rdonly;
+    };
+
+t_stat sim_fmap_open (FILE *fptr, size_t size, t_bool rdonly, FILEMAP **fmap, void **addr)
+{
+HANDLE hFile = (HANDLE)_get_osfhandle (_fileno (fptr));
+
+*addr = NULL;
+*fmap = (FILEMAP *)calloc (1, sizeof(**fmap));
+if (*fmap == NULL)
+    return SCPE_MEM;
+(*fmap)->map_size = size;
+(*fmap)->rdonly = rdonly;
+fflush (fptr);
+(*fmap)->hMapping = CreateFileMappingA (hFile, NULL, rdonly ? PAGE_WRITECOPY : PAGE_READWRITE, 0, 0, NULL);
+if ((*fmap)->hMapping == NULL) {
+    DWORD LastError = GetLastError();
+
+    sim_fmap_close (*fmap);
+    *fmap = NULL;
+    return sim_messagef (SCPE_OPENERR, "Can't CreateFileMapping of a %u byte file - LastError=0x%X\n", (unsigned int)size, (unsigned int)LastError);
+    }
+(*fmap)->map_base = MapViewOfFile ((*fmap)->hMapping, rdonly ? FILE_MAP_COPY : FILE_MAP_WRITE, 0, 0, size);
+if ((*fmap)->map_base == NULL) {
+    DWORD LastError = GetLastError();
+
+    sim_fmap_close (*fmap);
+    *fmap = NULL;
+    return sim_messagef (SCPE_OPENERR, "Can't MapViewOfFile() of a %u byte file - LastError=0x%X\n", (unsigned int)size, (unsigned int)LastError);
+    }
+*addr = (*fmap)->map_base;
+return SCPE_OK;
+}
+
+t_stat sim_fmap_sync (FILEMAP *fmap)
+{
+if ((fmap == NULL) || fmap->rdonly)
+    return SCPE_OK;
+if (!FlushViewOfFile (fmap->map_base, fmap->map_size))
+    return SCPE_IOERR;
+return SCPE_OK;
+}
+
+void sim_fmap_close (FILEMAP *fmap)
+{
+if (fmap == NULL)
+    return;
+if (fmap->map_base != NULL) {
+    sim_fmap_sync (fmap);
+    UnmapViewOfFile (fmap->map_base);
+    }
+if (fmap->hMapping != NULL)
+    CloseHandle (fmap->hMapping);
+free (fmap);
+}
+
 #else /* !defined(_WIN32) */
 #include <unistd.h>
 int sim_set_fsize (FILE *fptr, t_addr size)
@@ -780,6 +956,82 @@ return ftruncate(fileno(fptr), (off_t)size);
 #include <utime.h>
 #endif
 
+/* Release the storage behind a range of a file so that it reads back as
+   zeros without occupying space.  The file size doesn't change.  Returns
+   -1 if the platform or file system can't do this and the caller should
+   write the zeros itself. */
+
+int sim_punch_hole (FILE *fptr, t_offset offset, t_offset size)
+{
+#if defined (FALLOC_FL_PUNCH_HOLE) && defined (FALLOC_FL_KEEP_SIZE)
+if (fflush (fptr))
+    return -1;
+return fallocate (fileno (fptr), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, (off_t)offset, (off_t)size);
+#else
+errno = ENOSYS;
+return -1;
+#endif
+}
+
+/* Copy the contents of fIn to fOut leaving holes in the output wherever
+   the input has holes or blocks of zeros.  Where SEEK_DATA/SEEK_HOLE are
+   available, holes in the input are skipped without being read. */
+
+#define SIM_COPY_BUFSIZE    (1024*1024)
+
+static t_stat _sim_copy_sparse (FILE *fIn, FILE *fOut)
+{
+t_offset size = sim_fsize_ex (fIn);
+t_offset pos = 0;
+t_offset data_end;
+char *buf = (char *)malloc (SIM_COPY_BUFSIZE);
+t_stat st = SCPE_OK;
+#if defined (SEEK_DATA) && defined (SEEK_HOLE)
+off_t data, hole;
+#endif
+
+if (buf == NULL)
+    return SCPE_MEM;
+while ((pos < size) && (st == SCPE_OK)) {
+    data_end = size;
+#if defined (SEEK_DATA) && defined (SEEK_HOLE)
+    data = lseek (fileno (fIn), (off_t)pos, SEEK_DATA);
+    if (data == (off_t)-1) {
+        if (errno == ENXIO)
+            break;                          /* nothing but a hole to the end */
+        }
+    else {
+        pos = (t_offset)data;
+        hole = lseek (fileno (fIn), data, SEEK_HOLE);
+        if (hole != (off_t)-1)
+            data_end = (t_offset)hole;
+        }
+#endif
+    if (sim_fseeko (fIn, pos, SEEK_SET))
+        st = SCPE_IOERR;
+    while ((pos < data_end) && (st == SCPE_OK)) {
+        size_t chunk = (size_t)(((data_end - pos) > SIM_COPY_BUFSIZE) ? SIM_COPY_BUFSIZE : (data_end - pos));
+        size_t bytes = fread (buf, 1, chunk, fIn);
+
+        if (bytes == 0) {
+            data_end = size = pos;          /* input is shorter than it claimed */
+            break;
+            }
+        if ((buf[0] != 0) || memcmp (buf, buf + 1, bytes - 1)) {
+            if (sim_fseeko (fOut, pos, SEEK_SET) ||
+                (fwrite (buf, 1, bytes, fOut) != bytes))
+                st = SCPE_IOERR;
+            }
+        pos += bytes;
+        }
+    }
+free (buf);
+if ((st == SCPE_OK) &&
+    (fflush (fOut) || ftruncate (fileno (fOut), (off_t)size)))
+    st = SCPE_IOERR;
+return st;
+}
+
 const char *
 sim_get_os_error_text (int Error)
 {
@@ -803,6 +1055,10 @@ if (!fOut) {
     st = sim_messagef (SCPE_ARG, "Can't open '%s' for output: %s\n", dest_file, strerror (errno));
     goto Cleanup_Return;
     }
+if (sim_can_seek (fIn) && sim_can_seek (fOut)) {
+    st = _sim_copy_sparse (fIn, fOut);
+    goto Cleanup_Return;
+    }
 buf = (char *)malloc (BUFSIZ);
 while ((bytes = fread (buf, 1, BUFSIZ, fIn)))
     fwrite (buf, 1, bytes, fOut);
@@ -864,9 +1120,7 @@ return -1;
 
 #if defined (__linux__) || defined (__APPLE__) || defined (__CYGWIN__) || defined (__FreeBSD__) || defined(__NetBSD__) || defined (__OpenBSD__)
 
-#if defined (HAVE_SHM_OPEN)
 #include <sys/mman.h>
-#endif
 
 struct SHMEM {
     int shm_fd;
@@ -978,6 +1232,55 @@ else
 #endif
 }
 
+struct FILEMAP {
+    size_t map_size;
+    void *map_base;
+    t_bool rdonly;
+    };
+
+t_stat sim_fmap_open (FILE *fptr, size_t size, t_bool rdonly, FILEMAP **fmap, void **addr)
+{
+*addr = NULL;
+*fmap = (FILEMAP *)calloc (1, sizeof(**fmap));
+if (*fmap == NULL)
+    return SCPE_MEM;
+(*fmap)->map_size = size;
+(*fmap)->rdonly = rdonly;
+fflush (fptr);
+/* A read only image is mapped private: pages come from the shared page
+   cache until (and unless) the simulator deposits into them. */
+(*fmap)->map_base = mmap (NULL, size, PROT_READ | PROT_WRITE, rdonly ? MAP_PRIVATE : MAP_SHARED, fileno (fptr), 0);
+if ((*fmap)->map_base == MAP_FAILED) {
+    int last_errno = errno;
+
+    sim_fmap_close (*fmap);
+    *fmap = NULL;
+    return sim_messagef (SCPE_OPENERR, "Can't mmap() a %d byte file - errno=%d - %s\n", (int)size, last_errno, strerror (last_errno));
+    }
+*addr = (*fmap)->map_base;
+return SCPE_OK;
+}
+
+t_stat sim_fmap_sync (FILEMAP *fmap)
+{
+if ((fmap == NULL) || fmap->rdonly)
+    return SCPE_OK;
+if (msync (fmap->map_base, fmap->map_size, MS_SYNC))
+    return SCPE_IOERR;
+return SCPE_OK;
+}
+
+void sim_fmap_close (FILEMAP *fmap)
+{
+if (fmap == NULL)
+    return;
+if (fmap->map_base != MAP_FAILED) {
+    sim_fmap_sync (fmap);
+    munmap (fmap->map_base, fmap->map_size);
+    }
+free (fmap);
+}
+
 #else /* !(defined (__linux__) || defined (__APPLE__)) */
 
 t_stat sim_shmem_open (const char *name, size_t size, SHMEM **shmem, void **addr)
@@ -999,6 +1302,22 @@ t_bool sim_shmem_atomic_cas (int32 *ptr, int32 oldv, int32 newv)
 return FALSE;
 }
 
+t_stat sim_fmap_open (FILE *fptr, size_t size, t_bool rdonly, FILEMAP **fmap, void **addr)
+{
+*fmap = NULL;
+*addr = NULL;
+return SCPE_NOFNC;
+}
+
+t_stat sim_fmap_sync (FILEMAP *fmap)
+{
+return SCPE_OK;
+}
+
+void sim_fmap_close (FILEMAP *fmap)
+{
+}
+
 #endif /* defined (__linux__) || defined (__APPLE__) */
 #endif /* defined (_WIN32) */
 
@@ -64,6 +64,7 @@ int sim_fseek (FILE *st, t_addr offset, int whence);
 int sim_fseeko (FILE *st, t_offset offset, int whence);
 t_bool sim_can_seek (FILE *st);
 int sim_set_fsize (FILE *fptr, t_addr size);
+int sim_punch_hole (FILE *fptr, t_offset offset, t_offset size);
 t_stat sim_set_file_times (const char *file_name, time_t access_time, time_t write_time);
 int sim_set_fifo_nonblock (FILE *fptr);
 size_t sim_fread (void *bptr, size_t size, size_t count, FILE *fptr);
@@ -94,12 +95,18 @@ void sim_print_filelist (char **filelist);
 void sim_buf_swap_data (void *bptr, size_t size, size_t count);
 void sim_byte_swap_data (void *bptr, size_t size, size_t count);
 void sim_buf_copy_swapped (void *dptr, const void *bptr, size_t size, size_t count);
+void sim_buf_pack_36 (uint8 *dbuf, const t_uint64 *sbuf, size_t count, t_bool big_endian);
+void sim_buf_unpack_36 (t_uint64 *dbuf, const uint8 *sbuf, size_t count, t_bool big_endian);
 const char *sim_get_os_error_text (int error);
 typedef struct SHMEM SHMEM;
 t_stat sim_shmem_open (const char *name, size_t size, SHMEM **shmem, void **addr);
 void sim_shmem_close (SHMEM *shmem);
 int32 sim_shmem_atomic_add (int32 *ptr, int32 val);
 t_bool sim_shmem_atomic_cas (int32 *ptr, int32 oldv, int32 newv);
+typedef struct FILEMAP FILEMAP;
+t_stat sim_fmap_open (FILE *fptr, size_t size, t_bool rdonly, FILEMAP **fmap, void **addr);
+t_stat sim_fmap_sync (FILEMAP *fmap);
+void sim_fmap_close (FILEMAP *fmap);
 
 extern t_bool sim_taddr_64;         /* t_addr is > 32b and Large File Support available */
 extern t_bool sim_toffset_64;       /* Large File (>2GB) file I/O support */
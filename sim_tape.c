@@ -139,11 +139,34 @@ static t_addr sim_tape_tpc_fnd (UNIT *uptr, t_addr *map);
 static void sim_tape_data_trace (UNIT *uptr, const uint8 *data, size_t len, const char* txt, int detail, uint32 reason);
 static t_stat tape_erase_fwd (UNIT *uptr, t_mtrlnt gap_size);
 static t_stat tape_erase_rev (UNIT *uptr, t_mtrlnt gap_size);
+static void sim_tape_io_buffer (UNIT *uptr, size_t size);
+
+typedef struct {
+    t_addr              pos;                /* position of the object */
+    uint32              size;               /* its length on tape, TAPE_IDX_TMK if a tape mark */
+    t_mtrlnt            bc;                 /* record length as read forward */
+    } TAPE_INDEX;
+
+#define TAPE_IDX_TMK    0x80000000u         /* object is a tape mark */
+#define TAPE_IDX_MAX    (1u << 22)          /* most objects indexed (64MB of index) */
+
+#define TAPE_IO_BUFSIZE (256 * 1024)        /* read-ahead/write-behind window */
+#define TAPE_IO_READ    1                   /* stream used for reading since last seek */
+#define TAPE_IO_WRITE   2                   /* stream used for writing since last seek */
 
 struct tape_context {
     DEVICE              *dptr;              /* Device for unit (access to debug flags) */
     uint32              dbit;               /* debugging bit for trace */
     uint32              auto_format;        /* Format determined dynamically */
+    TAPE_INDEX          *idx;               /* record index, in position order */
+    uint32              idx_count;          /* entries in use */
+    uint32              idx_size;           /* entries allocated */
+    uint32              idx_hint;           /* entry most recently used */
+    t_bool              idx_bypass;         /* read the image even where indexed */
+    uint32              idx_hits;           /* motions satisfied from the index */
+    uint8               *io_buf;            /* stream buffer */
+    size_t              io_bufsize;         /* its size, 0 if C library default sized */
+    uint32              io_mode;            /* TAPE_IO_READ or TAPE_IO_WRITE, 0 if unknown */
 #if defined SIM_ASYNCH_IO
     t_bool              asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
@@ -928,6 +951,7 @@ uptr->tape_ctx = ctx = (struct tape_context *)calloc(1, sizeof(struct tape_conte
 ctx->dptr = dptr;                                       /* save DEVICE pointer */
 ctx->dbit = dbit;                                       /* save debug bit */
 ctx->auto_format = auto_format;                         /* save that we auto selected format */
+sim_tape_io_buffer (uptr, TAPE_IO_BUFSIZE);             /* read ahead and write behind */
 
 switch (MT_GET_FMT (uptr)) {                            /* case on format */
 
@@ -1027,6 +1051,10 @@ uptr->tape_eom = 0;
 uptr->pos = 0;
 MT_CLR_PNU (uptr);
 MT_CLR_INMRK (uptr);                                    /* Not within a TAR tapemark */
+if (ctx) {
+    free (ctx->idx);
+    free (ctx->io_buf);                                 /* stream is closed now */
+    }
 free (uptr->tape_ctx);
 uptr->tape_ctx = NULL;
 uptr->io_flush = NULL;
@@ -1115,13 +1143,71 @@ if (sim_deb && ((uptr->dctrl | ctx->dptr->dctrl) & reason))
     sim_data_trace(ctx->dptr, uptr, (detail ? data : NULL), "", len, txt, reason);
 }
 
-static int sim_tape_seek (UNIT *uptr, t_addr pos)
+/* Tape image stream buffering (internal routines).
+
+   Each unit attached to an image file has its own stream buffer, large
+   enough that sequential reads are satisfied from data read ahead and
+   sequential writes are collected and written out in large pieces.  Every
+   access positions the file first, and a real seek would discard the read
+   ahead data or force out the pending writes, so positioning to where the
+   stream already is, in the same direction it is being used, is skipped.
+   Changing between reading and writing always seeks, as C requires.
+*/
+
+static int sim_tape_stream_seek (UNIT *uptr, t_addr pos, uint32 mode)
 {
-if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
-    return sim_fseek (uptr->fileref, pos, SEEK_SET);
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (MT_GET_FMT (uptr) >= MTUF_F_ANSI)
+    return 0;
+if ((ctx != NULL) && (ctx->io_bufsize != 0) && (ctx->io_mode == mode) &&
+    !feof (uptr->fileref) && !ferror (uptr->fileref) &&
+    (sim_ftell (uptr->fileref) == (t_offset)pos))
+    return 0;                                           /* already there */
+if (ctx != NULL)
+    ctx->io_mode = 0;
+if (sim_fseek (uptr->fileref, pos, SEEK_SET))
+    return -1;
+if (ctx != NULL)
+    ctx->io_mode = mode;
 return 0;
 }
 
+/* Position for reading */
+
+static int sim_tape_seek (UNIT *uptr, t_addr pos)
+{
+return sim_tape_stream_seek (uptr, pos, TAPE_IO_READ);
+}
+
+/* Position for writing */
+
+static int sim_tape_wrseek (UNIT *uptr, t_addr pos)
+{
+return sim_tape_stream_seek (uptr, pos, TAPE_IO_WRITE);
+}
+
+/* Give the unit's stream a buffer of the given size, or one of the C
+   library's default size, seeking for every access, if size is 0 */
+
+static void sim_tape_io_buffer (UNIT *uptr, size_t size)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint8 *buf;
+
+if ((ctx == NULL) || (MT_GET_FMT (uptr) >= MTUF_F_ANSI))
+    return;
+buf = (uint8 *)malloc (size ? size : BUFSIZ);
+if (buf == NULL)                                        /* keep what it has */
+    return;
+fflush (uptr->fileref);
+setvbuf (uptr->fileref, (char *)buf, _IOFBF, size ? size : BUFSIZ);
+free (ctx->io_buf);                                     /* the stream no longer uses this */
+ctx->io_buf = buf;
+ctx->io_bufsize = size;
+ctx->io_mode = 0;                                       /* next access seeks */
+}
+
 static t_offset sim_tape_size (UNIT *uptr)
 {
 if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
@@ -1129,6 +1215,217 @@ if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
 return uptr->tape_eom;                   /* Virtual tape images: record/TM count */
 }
 
+/* Tape record index (internal routines).
+
+   Each object (data record or tape mark) that a forward read finds on an
+   on-disk tape image is remembered with its position and length, so that
+   spacing forward over it again, or reading or spacing backward over it,
+   positions the tape without reading the image's metadata.  Since attaching
+   a tape reads it through while validating it, file and record spacing on
+   an attached tape are normally index lookups from the start.
+
+   Only objects whose extent is exactly their own metadata and data are
+   recorded; a forward read that skipped an erase gap isn't, so the index
+   never needs to reproduce gap handling.  Writing anywhere on the tape drops
+   the entries from that point on.  Virtual tape formats don't need an index
+   and TAR tapes are positioned arithmetically, so neither is indexed.
+*/
+
+static int32 sim_tape_idx_hdrlen (uint32 f)
+{
+switch (f) {
+    case MTUF_F_STD:
+    case MTUF_F_E11:
+        return sizeof (t_mtrlnt);
+    case MTUF_F_TPC:
+        return sizeof (t_tpclnt);
+    case MTUF_F_AWS:
+        return sizeof (t_awshdr);
+    case MTUF_F_P7B:
+        return 0;
+    default:
+        return -1;                                  /* not indexed */
+    }
+}
+
+#define IDX_END(e) ((e)->pos + ((e)->size & ~TAPE_IDX_TMK))
+
+/* Return the first entry ending beyond pos (entries never overlap, so their
+   ends are in order too) */
+
+static uint32 sim_tape_idx_search (struct tape_context *ctx, t_addr pos)
+{
+uint32 lo = 0, hi = ctx->idx_count;
+
+while (lo < hi) {
+    uint32 mid = lo + (hi - lo) / 2;
+
+    if (IDX_END (&ctx->idx[mid]) > pos)
+        hi = mid;
+    else
+        lo = mid + 1;
+    }
+return lo;
+}
+
+/* Find the entry starting at pos (reverse FALSE) or ending at pos (reverse TRUE) */
+
+static TAPE_INDEX *sim_tape_idx_find (struct tape_context *ctx, t_addr pos, t_bool reverse)
+{
+uint32 i = ctx->idx_hint;
+
+if (reverse) {
+    if ((i < ctx->idx_count) && (IDX_END (&ctx->idx[i]) != pos))
+        --i;                                        /* try the one before the last one used */
+    if ((i >= ctx->idx_count) || (IDX_END (&ctx->idx[i]) != pos)) {
+        if (pos == 0)
+            return NULL;
+        i = sim_tape_idx_search (ctx, pos - 1);
+        if ((i >= ctx->idx_count) || (IDX_END (&ctx->idx[i]) != pos))
+            return NULL;
+        }
+    }
+else {
+    if ((i < ctx->idx_count) && (ctx->idx[i].pos != pos))
+        ++i;                                        /* try the one after the last one used */
+    if ((i >= ctx->idx_count) || (ctx->idx[i].pos != pos)) {
+        i = sim_tape_idx_search (ctx, pos);
+        if ((i >= ctx->idx_count) || (ctx->idx[i].pos != pos))
+            return NULL;
+        }
+    }
+ctx->idx_hint = i;
+return &ctx->idx[i];
+}
+
+/* Record the object a forward read starting at pos just moved over */
+
+static void sim_tape_idx_add (UNIT *uptr, t_addr pos, t_mtrlnt bc, t_stat status)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 f = MT_GET_FMT (uptr);
+int32 hdr = sim_tape_idx_hdrlen (f);
+t_addr size = uptr->pos - pos;
+t_addr expect;
+uint32 lo, hi;
+TAPE_INDEX *e;
+
+if ((hdr < 0) || (uptr->pos <= pos) ||
+    ((status != MTSE_OK) && (status != MTSE_TMK)))
+    return;
+if ((f == MTUF_F_AWS) &&                            /* AWS objects reading differently in reverse? */
+    ((status == MTSE_TMK) ? (bc != 0) : (bc == 0)))
+    return;
+if (f == MTUF_F_P7B)                                /* no gaps, size not in the metadata */
+    expect = size;
+else if (status == MTSE_TMK)
+    expect = hdr;
+else if (f == MTUF_F_STD)
+    expect = 2 * hdr + ((MTR_L (bc) + 1) & ~1);
+else if (f == MTUF_F_E11)
+    expect = 2 * hdr + MTR_L (bc);
+else if (f == MTUF_F_TPC)
+    expect = hdr + ((bc + 1) & ~1);
+else
+    expect = hdr + bc;
+if (size != expect)                                 /* erase gaps skipped? */
+    return;
+if ((ctx->idx_count == 0) || (IDX_END (&ctx->idx[ctx->idx_count - 1]) <= pos))
+    lo = hi = ctx->idx_count;                       /* usual case, reading on past the indexed part */
+else {
+    lo = sim_tape_idx_search (ctx, pos);            /* entries overlapping this one are replaced */
+    for (hi = lo; (hi < ctx->idx_count) && (ctx->idx[hi].pos < uptr->pos); hi++)
+        ;
+    if ((hi == lo + 1) && (ctx->idx[lo].pos == pos) &&
+        ((ctx->idx[lo].size & ~TAPE_IDX_TMK) == size)) {
+        ctx->idx_hint = lo;                         /* already indexed */
+        return;
+        }
+    }
+if (hi == lo) {                                     /* growing? */
+    if (ctx->idx_count >= TAPE_IDX_MAX)
+        return;
+    if (ctx->idx_count == ctx->idx_size) {
+        uint32 new_size = ctx->idx_size ? 2 * ctx->idx_size : 1024;
+        TAPE_INDEX *idx = (TAPE_INDEX *)realloc (ctx->idx, new_size * sizeof (*idx));
+
+        if (idx == NULL)
+            return;
+        ctx->idx = idx;
+        ctx->idx_size = new_size;
+        }
+    }
+memmove (&ctx->idx[lo + 1], &ctx->idx[hi], (ctx->idx_count - hi) * sizeof (*ctx->idx));
+ctx->idx_count = ctx->idx_count - (hi - lo) + 1;
+e = &ctx->idx[lo];
+e->pos = pos;
+e->size = (uint32)size | ((status == MTSE_TMK) ? TAPE_IDX_TMK : 0);
+e->bc = bc;
+ctx->idx_hint = lo;
+}
+
+/* Drop the entries for anything beyond pos (about to be written) */
+
+static void sim_tape_idx_trunc (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if ((ctx == NULL) || (ctx->idx_count == 0))
+    return;
+ctx->idx_count = sim_tape_idx_search (ctx, pos);
+ctx->idx_hint = 0;
+}
+
+/* Position forward over an indexed object, as sim_tape_rdlntf would */
+
+static t_bool sim_tape_idx_fwd (UNIT *uptr, t_mtrlnt *bc, t_stat *status)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+TAPE_INDEX *e;
+
+if ((ctx->idx_count == 0) || ctx->idx_bypass ||
+    ((uptr->flags & UNIT_ATT) == 0) ||
+    ((uptr->tape_eom > 0) && (uptr->pos >= uptr->tape_eom)))
+    return FALSE;
+e = sim_tape_idx_find (ctx, uptr->pos, FALSE);
+if ((e == NULL) ||
+    (sim_tape_seek (uptr, e->pos + sim_tape_idx_hdrlen (MT_GET_FMT (uptr)))))
+    return FALSE;
+MT_CLR_PNU (uptr);
+*bc = e->bc;
+*status = (e->size & TAPE_IDX_TMK) ? MTSE_TMK : MTSE_OK;
+uptr->pos = IDX_END (e);
+++ctx->idx_hits;
+return TRUE;
+}
+
+/* Position backward over an indexed object, as sim_tape_rdlntr would */
+
+static t_bool sim_tape_idx_rev (UNIT *uptr, t_mtrlnt *bc, t_stat *status)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 f = MT_GET_FMT (uptr);
+TAPE_INDEX *e;
+
+if ((ctx->idx_count == 0) || ctx->idx_bypass ||
+    ((uptr->flags & UNIT_ATT) == 0) || sim_tape_bot (uptr) ||
+    ((f == MTUF_F_AWS) && (uptr->tape_eom > 0) && (uptr->pos >= uptr->tape_eom)))
+    return FALSE;
+e = sim_tape_idx_find (ctx, uptr->pos, TRUE);
+if ((e == NULL) ||
+    (sim_tape_seek (uptr, e->pos + sim_tape_idx_hdrlen (f))))
+    return FALSE;
+MT_CLR_PNU (uptr);
+*status = (e->size & TAPE_IDX_TMK) ? MTSE_TMK : MTSE_OK;
+if ((f == MTUF_F_P7B) && (*status == MTSE_TMK))    /* reverse P7B reads report the mark's length */
+    *bc = e->size & ~TAPE_IDX_TMK;
+else
+    *bc = e->bc;
+uptr->pos = e->pos;
+++ctx->idx_hits;
+return TRUE;
+}
+
 /* Read record length forward (internal routine).
 
    Inputs:
@@ -1545,14 +1842,20 @@ static t_stat sim_tape_rdrlfwd (UNIT *uptr, t_mtrlnt *bc)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 t_stat status;
+t_addr start = uptr->pos;
+t_bool indexed;
 
 *bc = 0;
 if (ctx == NULL)                                        /* if not properly attached? */
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 
-status = sim_tape_rdlntf (uptr, bc);                    /* read the record length */
+indexed = sim_tape_idx_fwd (uptr, bc, &status);         /* known object? */
+if (!indexed) {
+    status = sim_tape_rdlntf (uptr, bc);                /* read the record length */
+    sim_tape_idx_add (uptr, start, *bc, status);        /*   and remember it */
+    }
 
-sim_debug_unit (MTSE_DBG_STR, uptr, "rd_lntf: st: %d, lnt: %d, pos: %" T_ADDR_FMT "u\n", status, *bc, uptr->pos);
+sim_debug_unit (MTSE_DBG_STR, uptr, "rd_lntf: st: %d, lnt: %d, pos: %" T_ADDR_FMT "u%s\n", status, *bc, uptr->pos, indexed ? " (indexed)" : "");
 
 return status;
 }
@@ -1879,14 +2182,17 @@ static t_stat sim_tape_rdrlrev (UNIT *uptr, t_mtrlnt *bc)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 t_stat status;
+t_bool indexed;
 
 *bc = 0;
 if (ctx == NULL)                                        /* if not properly attached? */
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 
-status = sim_tape_rdlntr (uptr, bc);                    /* read the record length */
+indexed = sim_tape_idx_rev (uptr, bc, &status);         /* known object? */
+if (!indexed)
+    status = sim_tape_rdlntr (uptr, bc);                /* read the record length */
 
-sim_debug_unit (MTSE_DBG_STR, uptr, "rd_lntr: st: %d, lnt: %d, pos: %" T_ADDR_FMT "u\n", status, *bc, uptr->pos);
+sim_debug_unit (MTSE_DBG_STR, uptr, "rd_lntr: st: %d, lnt: %d, pos: %" T_ADDR_FMT "u%s\n", status, *bc, uptr->pos, indexed ? " (indexed)" : "");
 
 return status;
 }
@@ -2076,8 +2382,9 @@ if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
 if (sbc == 0)                                           /* nothing to do? */
     return MTSE_OK;
-if (sim_tape_seek (uptr, uptr->pos))                    /* set pos */
+if (sim_tape_wrseek (uptr, uptr->pos))                  /* set pos */
     return MTSE_IOERR;
+sim_tape_idx_trunc (uptr, uptr->pos);                   /* index is stale from here on */
 switch (f) {                                            /* case on format */
 
     case MTUF_F_STD:                                    /* standard */
@@ -2147,9 +2454,10 @@ if ((!sim_tape_bot (uptr)) &&
     MT_SET_PNU (uptr);                      /* pos not upd */
     return MTSE_INVRL;
     }
-if (sim_tape_seek (uptr, uptr->pos))        /* set pos */
+if (sim_tape_wrseek (uptr, uptr->pos))      /* set pos */
     return MTSE_IOERR;
 replacing_record = (awshdr.nxtlen == (t_awslnt)bc) && (awshdr.rectyp == (bc ? AWS_REC : AWS_TMK));
+sim_tape_idx_trunc (uptr, uptr->pos);                   /* index is stale from here on */
 awshdr.nxtlen = (t_awslnt)bc;
 awshdr.rectyp = (bc) ? AWS_REC : AWS_TMK;
 (void)sim_fwrite (&awshdr, sizeof (t_awslnt), 3, uptr->fileref);
@@ -2182,7 +2490,8 @@ if (ctx == NULL)                                        /* if not properly attac
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
-(void)sim_tape_seek (uptr, uptr->pos);                  /* set pos */
+(void)sim_tape_wrseek (uptr, uptr->pos);                /* set pos */
+sim_tape_idx_trunc (uptr, uptr->pos);                   /* index is stale from here on */
 (void)sim_fwrite (&dat, sizeof (uint32), 1, uptr->fileref);
 if (ferror (uptr->fileref)) {                           /* error? */
     MT_SET_PNU (uptr);
@@ -2237,6 +2546,7 @@ if (sim_tape_wrp (uptr))                                /* write prot? */
 if (MT_GET_FMT (uptr) == MTUF_F_P7B)                    /* cant do P7B */
     return MTSE_FMT;
 if (MT_GET_FMT (uptr) == MTUF_F_AWS) {
+    sim_tape_idx_trunc (uptr, uptr->pos);               /* index is stale from here on */
     sim_set_fsize (uptr->fileref, uptr->pos);
     result = MTSE_OK;
     }
@@ -2433,6 +2743,8 @@ else if (gap_size == 0 || format != MTUF_F_STD)         /* otherwise if zero len
 
 file_size = sim_fsize (uptr->fileref);                  /* get the file size */
 
+sim_tape_idx_trunc (uptr, gap_pos);                     /* index is stale from here on */
+
 if (sim_tape_seek (uptr, uptr->pos)) {                  /* position the tape; if it fails */
     MT_SET_PNU (uptr);                                  /*   then set position not updated */
     return sim_tape_ioerr (uptr);                       /*     and quit with I/O error status */
@@ -2633,6 +2945,8 @@ else if ((gap_size == 0) || (format != MTUF_F_STD))     /* otherwise if the gap
 
 gap_pos = uptr->pos;                                    /* save the starting position */
 
+sim_tape_idx_trunc (uptr, 0);                           /* gap may extend back over anything */
+
 if (gap_size == meta_size) {                            /* if the request is for a single metadatum */
     if (sim_tape_bot (uptr))                            /*   then if the unit is positioned at the BOT */
         return MTSE_BOT;                                /*     then erasing backward is not possible */
@@ -2648,7 +2962,7 @@ if (gap_size == meta_size) {                            /* if the request is for
         return sim_tape_ioerr (uptr);                       /*   then report the error and quit */
 
     else if (metadatum == MTR_TMK)                          /* otherwise if a tape mark is present */
-        if (sim_tape_seek (uptr, uptr->pos))                /*   then reposition the tape; if it fails */
+        if (sim_tape_wrseek (uptr, uptr->pos))              /*   then reposition the tape; if it fails */
             return sim_tape_ioerr (uptr);                   /*     then quit with I/O error status */
 
         else {                                              /*   otherwise */
@@ -3507,6 +3821,7 @@ return msgbuf;
 
 static t_stat sim_tape_validate_tape (UNIT *uptr)
 {
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 t_addr saved_pos = uptr->pos;
 size_t data_total = 0;
 uint32 tapemark_total = 0;
@@ -3549,6 +3864,7 @@ if (rec_sizes == NULL) {
     return SCPE_MEM;
     }
 
+ctx->idx_bypass = TRUE;                                 /* check the image itself, indexing it */
 r = sim_tape_rewind (uptr);
 while (r == SCPE_OK) {
     if (stop_cpu) { /* SIGINT? */
@@ -3668,6 +3984,7 @@ if (!stop_cpu) {            /* if SIGINT didn't interrupt the scan */
         }
     }
 
+ctx->idx_bypass = FALSE;
 free (buf_f);
 free (buf_r);
 free (rec_sizes);
@@ -4171,6 +4488,157 @@ sim_switches = 0;
 return SCPE_OK;
 }
 
+/* Position through a tape image with and without its record index and
+   check that the index reproduces what reading the image reports */
+
+#define IDX_TEST_MAX 256
+
+static t_stat sim_tape_test_index (UNIT *uptr, const char *filename, const char *format)
+{
+struct tape_context *ctx;
+char args[256];
+uint8 *buf = NULL;
+t_stat stat;
+t_stat st[2][IDX_TEST_MAX];
+t_mtrlnt lnt[2][IDX_TEST_MAX];
+t_addr where[2][IDX_TEST_MAX];
+uint32 sum[2][IDX_TEST_MAX];
+t_addr file_pos[2];
+uint32 count[2];
+uint32 hits[2];
+uint32 pass, i, skipped;
+t_mtrlnt bc;
+
+sprintf (args, "%s %s.%s", format, filename, format);
+sim_tape_detach (uptr);
+sim_switches = SWMASK ('F');
+stat = sim_tape_attach_ex (uptr, args, 0, 0);
+sim_switches = 0;
+if (stat != SCPE_OK)
+    return stat;
+ctx = (struct tape_context *)uptr->tape_ctx;
+stat = SCPE_IERR;
+buf = (uint8 *)malloc (MTR_MAXLEN);
+if ((buf == NULL) || (ctx->idx_count == 0)) {
+    sim_printf ("%s: no record index built at attach\n", args);
+    goto Done;
+    }
+for (pass = 0; pass < 2; pass++) {
+    ctx->idx_bypass = (pass == 0);
+    hits[pass] = ctx->idx_hits;
+    sim_tape_rewind (uptr);
+    sim_tape_spfilef (uptr, 1, &skipped);
+    file_pos[pass] = uptr->pos;
+    do                                              /* run to the end of the tape */
+        stat = sim_tape_sprecf (uptr, &bc);
+    while ((stat == MTSE_OK) || (stat == MTSE_TMK));
+    for (count[pass] = 0; count[pass] < IDX_TEST_MAX; count[pass]++) {
+        i = count[pass];
+        stat = sim_tape_rdrecr (uptr, buf, &bc, MTR_MAXLEN);
+        if ((stat != MTSE_OK) && (stat != MTSE_TMK))
+            break;
+        st[pass][i] = stat;
+        lnt[pass][i] = bc;
+        where[pass][i] = uptr->pos;
+        for (sum[pass][i] = 0; bc > 0; bc--)
+            sum[pass][i] = (sum[pass][i] << 1) + (sum[pass][i] >> 31) + buf[bc - 1];
+        }
+    hits[pass] = ctx->idx_hits - hits[pass];
+    }
+stat = SCPE_IERR;
+if ((hits[0] != 0) || (hits[1] == 0)) {
+    sim_printf ("%s: %u index lookups bypassing it and %u using it\n", args, hits[0], hits[1]);
+    goto Done;
+    }
+if ((file_pos[0] != file_pos[1]) || (count[0] != count[1])) {
+    sim_printf ("%s: file skip to %" T_ADDR_FMT "u vs %" T_ADDR_FMT "u, %u vs %u records reading backward\n",
+                args, file_pos[0], file_pos[1], count[0], count[1]);
+    goto Done;
+    }
+for (i = 0; i < count[0]; i++) {
+    if ((st[0][i] != st[1][i]) || (lnt[0][i] != lnt[1][i]) ||
+        (where[0][i] != where[1][i]) || (sum[0][i] != sum[1][i])) {
+        sim_printf ("%s: reverse read %u differs using the index\n", args, i);
+        goto Done;
+        }
+    }
+sim_tape_rewind (uptr);                             /* writing drops what follows */
+sim_tape_sprecf (uptr, &bc);
+if (sim_tape_wrtmk (uptr) != MTSE_OK)              /* format written read only? */
+    ctx->idx_count = 0;
+for (i = 0; i < ctx->idx_count; i++) {
+    if (IDX_END (&ctx->idx[i]) > uptr->pos) {
+        sim_printf ("%s: index not truncated by a write\n", args);
+        goto Done;
+        }
+    }
+sim_printf ("%s: %u records and tape marks located through the index\n", args, hits[1]);
+stat = SCPE_OK;
+Done:
+free (buf);
+sim_tape_detach (uptr);
+return stat;
+}
+
+/* Stream records onto a tape and back, with default stdio buffering and with the unit's
+   read-ahead/write-behind buffer, and with TESTLIB -D report the throughput of each */
+
+#define THRU_TEST_RECORDS   20000
+#define THRU_TEST_RECSIZE   512
+
+static t_stat sim_tape_test_throughput (UNIT *uptr, const char *filename)
+{
+char args[256];
+uint8 buf[THRU_TEST_RECSIZE];
+t_stat stat = SCPE_OK;
+t_mtrlnt bc;
+uint32 pass, i, j;
+uint32 start, write_ms[2], read_ms[2];
+
+sprintf (args, "simh %s.thru.simh", filename);
+for (pass = 0; (pass < 2) && (stat == SCPE_OK); pass++) {
+    sim_tape_detach (uptr);
+    sim_switches = SWMASK ('F') | SWMASK ('N') | SWMASK ('Q');
+    stat = sim_tape_attach_ex (uptr, args, 0, 0);
+    sim_switches = 0;
+    if (stat != SCPE_OK)
+        break;
+    sim_tape_io_buffer (uptr, pass ? TAPE_IO_BUFSIZE : 0);
+    start = sim_os_msec ();
+    for (i = 0; (i < THRU_TEST_RECORDS) && (stat == SCPE_OK); i++) {
+        for (j = 0; j < sizeof (buf); j++)
+            buf[j] = (uint8)(i + j);
+        if (sim_tape_wrrecf (uptr, buf, sizeof (buf)) != MTSE_OK)
+            stat = SCPE_IOERR;
+        }
+    sim_tape_wrtmk (uptr);
+    fflush (uptr->fileref);
+    write_ms[pass] = sim_os_msec () - start;
+    sim_tape_rewind (uptr);
+    start = sim_os_msec ();
+    for (i = 0; (i < THRU_TEST_RECORDS) && (stat == SCPE_OK); i++) {
+        if ((sim_tape_rdrecf (uptr, buf, &bc, sizeof (buf)) != MTSE_OK) ||
+            (bc != sizeof (buf)) || (buf[0] != (uint8)i) || (buf[bc - 1] != (uint8)(i + bc - 1))) {
+            sim_printf ("%s: record %u read back incorrectly\n", args, i);
+            stat = SCPE_IERR;
+            }
+        }
+    if ((stat == SCPE_OK) && (sim_tape_rdrecf (uptr, buf, &bc, sizeof (buf)) != MTSE_TMK)) {
+        sim_printf ("%s: tape mark missing after %u records\n", args, i);
+        stat = SCPE_IERR;
+        }
+    read_ms[pass] = sim_os_msec () - start;
+    sim_tape_detach (uptr);
+    (void)remove (args + 5);
+    }
+if ((stat != SCPE_OK) || (sim_deb == NULL))         /* timings only when debugging */
+    return stat;
+sim_printf ("Streaming %u %u-byte records:\n", THRU_TEST_RECORDS, THRU_TEST_RECSIZE);
+sim_printf ("  default stdio buffer: written in %u ms, read in %u ms\n", write_ms[0], read_ms[0]);
+sim_printf ("  %uKB unit buffer:    written in %u ms, read in %u ms\n", TAPE_IO_BUFSIZE / 1024, write_ms[1], read_ms[1]);
+return SCPE_OK;
+}
+
 static t_stat sim_tape_test_remove_tape_files (UNIT *uptr, const char *filename)
 {
 char name[256];
@@ -4402,6 +4870,18 @@ SIM_TEST(sim_tape_test_process_tape_file (dptr->units, "TapeTestFile1", "e11", 0
 sim_switches = saved_switches;
 SIM_TEST(sim_tape_test_process_tape_file (dptr->units, "TapeTestFile1", "simh", 0));
 
+SIM_TEST(sim_tape_test_index (dptr->units, "TapeTestFile1", "simh"));
+
+SIM_TEST(sim_tape_test_index (dptr->units, "TapeTestFile1", "e11"));
+
+SIM_TEST(sim_tape_test_index (dptr->units, "TapeTestFile1", "tpc"));
+
+SIM_TEST(sim_tape_test_index (dptr->units, "TapeTestFile1", "p7b"));
+
+SIM_TEST(sim_tape_test_index (dptr->units, "TapeTestFile1", "aws"));
+
+SIM_TEST(sim_tape_test_throughput (dptr->units, "TapeTestFile1"));
+
 sim_switches = saved_switches;
 if ((sim_switches & SWMASK ('D')) == 0)
     SIM_TEST(sim_tape_test_remove_tape_files (dptr->units, "TapeTestFile1"));
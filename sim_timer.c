@@ -75,6 +75,9 @@
    sim_idle_ms_sleep -      sleep specified number of milliseconds
                             or until awakened by an asynchronous
                             event
+   sim_idle_us_sleep -      sleep specified number of microseconds
+                            or until awakened by an asynchronous
+                            event
    sim_timespec_diff        subtract two timespec values
    sim_timer_activate_after schedule unit for specific time
    sim_timer_activate_time  determine activation time
@@ -108,6 +111,10 @@
 
 uint32 sim_idle_ms_sleep (unsigned int msec);
 
+#if !defined(VMS) && !defined(_WIN32) && !defined(__APPLE__) && defined(TIMER_ABSTIME) && defined(CLOCK_MONOTONIC)
+#define HAVE_ABSTIME_NANOSLEEP 1
+#endif
+
 /* Useful constants:
  *
  * Note: These have specific types so that it is clear from usage context what
@@ -126,10 +133,8 @@ uint32 sim_idle_ms_sleep (unsigned int msec);
 static const t_uint64 NSEC_PER_SEC_u64 = 1000000000ull;
 #endif
 
-#if defined(NEED_CLOCK_GETTIME)
-#  if !defined(_POSIX_SOURCE)
+#if (defined(NEED_CLOCK_GETTIME) && !defined(_POSIX_SOURCE)) || defined(SIM_ASYNCH_IO) || defined(HAVE_ABSTIME_NANOSLEEP)
 static const long     NSEC_PER_USEC_l  = NSEC_PER_SEC_l_VALUE / 1000000l;               /* (ns/s) / (us/s). */
-#  endif
 #endif
 
 static const t_int64  NSEC_PER_SEC_ll  = NSEC_PER_SEC_ll_VALUE;
@@ -137,6 +142,8 @@ static const long     NSEC_PER_SEC_l   = NSEC_PER_SEC_l_VALUE;
 static const double   NSEC_PER_SEC_d   = 1000000000.0;
 
 static const double   USEC_PER_SEC_d   = 1000000.0;
+static const uint32   USEC_PER_SEC_u32 = 1000000u;
+static const uint32   USEC_PER_MSEC_u32 = 1000u;
 
 #if !defined(VMS) && !defined(_WIN32)
 static const long     USEC_PER_MSEC_l  = 1000000l / 1000l;
@@ -215,6 +222,7 @@ static uint32 sim_stop_time = 0;                    /* time when sim_stop_timer_
 double sim_time_at_sim_prompt =  0;                 /* time spent processing commands from sim> prompt */
 
 static uint32 sim_idle_rate_ms = 0;                 /* Minimum Sleep time */
+static uint32 sim_idle_rate_us = 0;                 /* Minimum Idle Sleep time (usecs) */
 static uint32 sim_os_sleep_min_ms = 0;
 static uint32 sim_os_sleep_inc_ms = 0;
 static uint32 sim_os_clock_resoluton_ms = 0;
@@ -805,6 +813,149 @@ while (diff->tv_nsec >= NSEC_PER_SEC_l) {
     }
 }
 
+/* sim_idle_us_sleep - idle for the specified number of microseconds
+
+   The wait is to an absolute deadline, so the time spent setting it up
+   doesn't lengthen it, and the time actually slept is returned in
+   microseconds.  As with sim_idle_ms_sleep, an asynchronous I/O completion
+   ends the wait early.  Hosts without a sub-millisecond sleep round up to
+   whole milliseconds.
+*/
+
+#if !(defined(MS_MIN_GRANULARITY) && (MS_MIN_GRANULARITY != 1)) && \
+    (defined(SIM_ASYNCH_IO) || defined(HAVE_ABSTIME_NANOSLEEP))
+static void _timespec_add_usec (struct timespec *time, uint32 usec)
+{
+time->tv_sec += usec / USEC_PER_SEC_u32;
+time->tv_nsec += (usec % USEC_PER_SEC_u32) * NSEC_PER_USEC_l;
+if (time->tv_nsec >= NSEC_PER_SEC_l) {
+    time->tv_sec += time->tv_nsec / NSEC_PER_SEC_l;
+    time->tv_nsec = time->tv_nsec % NSEC_PER_SEC_l;
+    }
+}
+
+static uint32 _timespec_to_usec (const struct timespec *time)
+{
+return (uint32) ((time->tv_sec * USEC_PER_SEC_u32) + (time->tv_nsec / NSEC_PER_USEC_l));
+}
+#endif
+
+#if defined(MS_MIN_GRANULARITY) && (MS_MIN_GRANULARITY != 1)
+uint32 sim_idle_us_sleep (uint32 usec)
+{
+return USEC_PER_MSEC_u32 * sim_idle_ms_sleep ((usec + USEC_PER_MSEC_u32 - 1) / USEC_PER_MSEC_u32);
+}
+#elif defined(SIM_ASYNCH_IO)
+uint32 sim_idle_us_sleep (uint32 usec)
+{
+struct timespec start_time, end_time, done_time, delta_time;
+t_bool timedout = FALSE;
+
+clock_gettime (CLOCK_REALTIME, &start_time);
+end_time = start_time;
+_timespec_add_usec (&end_time, usec);
+pthread_mutex_lock (&sim_asynch_lock);
+sim_idle_wait = TRUE;
+if (pthread_cond_timedwait (&sim_asynch_wake, &sim_asynch_lock, &end_time))
+    timedout = TRUE;
+sim_idle_wait = FALSE;
+pthread_mutex_unlock (&sim_asynch_lock);
+clock_gettime (CLOCK_REALTIME, &done_time);
+if (!timedout) {
+    AIO_UPDATE_QUEUE;
+    }
+sim_timespec_diff (&delta_time, &done_time, &start_time);
+return _timespec_to_usec (&delta_time);
+}
+#elif defined(HAVE_ABSTIME_NANOSLEEP)
+uint32 sim_idle_us_sleep (uint32 usec)
+{
+struct timespec start_time, end_time, done_time, delta_time;
+
+clock_gettime (CLOCK_MONOTONIC, &start_time);
+end_time = start_time;
+_timespec_add_usec (&end_time, usec);
+while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &end_time, NULL) == EINTR)
+    ;
+clock_gettime (CLOCK_MONOTONIC, &done_time);
+sim_timespec_diff (&delta_time, &done_time, &start_time);
+return _timespec_to_usec (&delta_time);
+}
+#else
+uint32 sim_idle_us_sleep (uint32 usec)
+{
+return USEC_PER_MSEC_u32 * sim_idle_ms_sleep ((usec + USEC_PER_MSEC_u32 - 1) / USEC_PER_MSEC_u32);
+}
+#endif
+
+#define sleepUsSamples      100
+
+static uint32 _compute_minimum_us_sleep (void)
+{
+uint32 i, tot;
+
+sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+sim_idle_us_sleep (1);              /* Settle after the millisecond sampling */
+for (i = 0, tot = 0; i < sleepUsSamples; i++)
+    tot += sim_idle_us_sleep (1);
+sim_os_set_thread_priority (PRIORITY_NORMAL);
+return MAX (tot / sleepUsSamples, 1);
+}
+
+/* Idle sleep histogram - requested vs. achieved sleep times by requested size */
+
+#define IDLE_HIST_BUCKETS   10
+
+static const uint32 sim_idle_hist_limit[IDLE_HIST_BUCKETS] = {
+    50, 100, 250, 500, 1000, 2000, 5000, 10000, 50000, 0xFFFFFFFF};
+
+static struct {
+    uint32 sleeps;                  /* sleeps requested in this range */
+    double requested;               /* total usecs requested */
+    double achieved;                /* total usecs slept */
+    uint32 max_late;                /* longest overrun (usecs) */
+    } sim_idle_hist[IDLE_HIST_BUCKETS];
+
+static void _sim_idle_hist_record (uint32 req_us, uint32 act_us)
+{
+int i;
+
+for (i = 0; req_us >= sim_idle_hist_limit[i]; i++)
+    ;
+++sim_idle_hist[i].sleeps;
+sim_idle_hist[i].requested += req_us;
+sim_idle_hist[i].achieved += act_us;
+if ((act_us > req_us) && (act_us - req_us > sim_idle_hist[i].max_late))
+    sim_idle_hist[i].max_late = act_us - req_us;
+}
+
+static void _sim_idle_hist_show (FILE *st)
+{
+int i;
+uint32 lower = 0;
+
+for (i = 0; i < IDLE_HIST_BUCKETS; i++)
+    if (sim_idle_hist[i].sleeps)
+        break;
+if (i == IDLE_HIST_BUCKETS)
+    return;
+fprintf (st, "Idle Sleeps:\n");
+fprintf (st, "  Requested (usecs)     Sleeps    Avg Requested   Avg Achieved   Max Late\n");
+for (i = 0; i < IDLE_HIST_BUCKETS; lower = sim_idle_hist_limit[i++]) {
+    char range[32];
+
+    if (sim_idle_hist[i].sleeps == 0)
+        continue;
+    if (sim_idle_hist_limit[i] == 0xFFFFFFFF)
+        sprintf (range, "%u+", lower);
+    else
+        sprintf (range, "%u-%u", lower, sim_idle_hist_limit[i] - 1);
+    fprintf (st, "  %-18s %9u %16.0f %14.0f %10u\n", range, sim_idle_hist[i].sleeps,
+                 sim_idle_hist[i].requested / sim_idle_hist[i].sleeps,
+                 sim_idle_hist[i].achieved / sim_idle_hist[i].sleeps, sim_idle_hist[i].max_late);
+    }
+}
+
 /* Forward declarations */
 
 static double _timespec_to_double (struct timespec *time);
@@ -1116,8 +1267,8 @@ if (tmr != SIM_NTIMERS) {
 new_gtime = sim_gtime();
 if ((last_idle_pct == 0) && (delta_rtime != 0)) {
     sim_idle_cyc_ms = (uint32)((new_gtime - rtc->gtime) / delta_rtime);
-    if ((sim_idle_rate_ms != 0) && (delta_rtime > 1))
-        sim_idle_cyc_sleep = (uint32)((new_gtime - rtc->gtime) / (delta_rtime / sim_idle_rate_ms));
+    if ((sim_idle_rate_us != 0) && (delta_rtime > 1))
+        sim_idle_cyc_sleep = (uint32)(((new_gtime - rtc->gtime) * sim_idle_rate_us) / ((double)delta_rtime * USEC_PER_MSEC_u32));
     }
 if (sim_asynch_timer || (catchup_ticks_curr > 0)) {
     /* An asynchronous clock or when catchup ticks have  */
@@ -1217,6 +1368,8 @@ sim_throttle_unit.action = &sim_throt_svc;
 sim_register_clock_unit_tmr (&SIM_INTERNAL_UNIT, SIM_INTERNAL_CLK);
 sim_idle_enab = FALSE;                                  /* init idle off */
 sim_idle_rate_ms = sim_os_ms_sleep_init ();             /* get OS timer rate */
+if (sim_idle_rate_ms != 0)                              /* and the finest idle sleep */
+    sim_idle_rate_us = MIN (_compute_minimum_us_sleep (), sim_idle_rate_ms * USEC_PER_MSEC_u32);
 sim_set_rom_delay_factor (sim_get_rom_delay_factor ()); /* initialize ROM delay factor */
 
 sim_stop_time = clock_last = clock_start = sim_os_msec ();
@@ -1265,11 +1418,13 @@ t_stat sim_show_timers(FILE *st, DEVICE *dptr, UNIT *uptr, int32 val, CONST char
     fprintf(st, "Minimum Host Sleep Time:        %d ms (%dHz)\n", sim_os_sleep_min_ms, sim_os_tick_hz);
     if (sim_os_sleep_min_ms != sim_os_sleep_inc_ms)
         fprintf(st, "Minimum Host Sleep Incr Time:   %d ms\n", sim_os_sleep_inc_ms);
+    fprintf(st, "Minimum Idle Sleep Time:        %u usecs\n", sim_idle_rate_us);
     fprintf(st, "Host Clock Resolution:          %d ms\n", sim_os_clock_resoluton_ms);
     fprintf(st, "Execution Rate:                 %s %s/sec\n", sim_fmt_numeric(inst_per_sec), sim_vm_interval_units);
     if (sim_idle_enab) {
         fprintf(st, "Idling:                         Enabled\n");
         fprintf(st, "Time before Idling starts:      %d seconds\n", sim_idle_stable);
+        _sim_idle_hist_show(st);
     }
     if (sim_throt_type != SIM_THROT_NONE) {
         sim_show_throt(st, NULL, uptr, val, desc);
@@ -1698,9 +1853,10 @@ return SCPE_OK;
 
 t_bool sim_idle (size_t tmr, int sin_cyc)
 {
-uint32 w_ms, w_idle, act_ms;
+uint32 w_ms, w_us, w_idle, act_us;
 int32 act_cyc;
 static t_bool in_nowait = FALSE;
+static uint32 us_idled = 0;                             /* idle time not yet a whole ms */
 double cyc_since_idle;
 RTC *rtc = &rtcs[tmr];
 
@@ -1757,15 +1913,16 @@ if ((!sim_idle_enab)                             ||     /* idling disabled */
 sim_debug (DBG_TRC, &sim_timer_dev, "sim_idle(tmr=%" SIZE_T_FMT "u, sin_cyc=%d)\n", tmr, sin_cyc);
 if (sim_idle_cyc_ms == 0) {
     sim_idle_cyc_ms = (rtc->currd * rtc->hz) / MSEC_PER_SEC_u32;/* cycles per msec */
-    if (sim_idle_rate_ms != 0)
-        sim_idle_cyc_sleep = (rtc->currd * rtc->hz) / (MSEC_PER_SEC_u32 / sim_idle_rate_ms);/* cycles per minimum sleep */
+    if (sim_idle_rate_us != 0)
+        sim_idle_cyc_sleep = (uint32)(((double)rtc->currd * rtc->hz * sim_idle_rate_us) / USEC_PER_SEC_u32);/* cycles per minimum sleep */
     }
-if ((sim_idle_rate_ms == 0) || (sim_idle_cyc_ms == 0)) {/* not possible? */
+if ((sim_idle_rate_us == 0) || (sim_idle_cyc_ms == 0)) {/* not possible? */
     sim_interval -= sin_cyc;
     sim_debug (DBG_IDL, &sim_timer_dev, "not possible idle_rate_ms=%d - cyc/ms=%d\n", sim_idle_rate_ms, sim_idle_cyc_ms);
     return FALSE;
     }
 w_ms = (uint32) sim_interval / sim_idle_cyc_ms;         /* ms to wait */
+w_us = (uint32) MIN (((t_uint64)(uint32) sim_interval * USEC_PER_MSEC_u32) / sim_idle_cyc_ms, 0xFFFFFFFFu);
 /* When the host system has a clock tick which is less frequent than the    */
 /* simulated system's clock, idling will cause delays which will miss       */
 /* simulated clock ticks.  To accomodate this, and still allow idling, if   */
@@ -1774,8 +1931,8 @@ w_ms = (uint32) sim_interval / sim_idle_cyc_ms;         /* ms to wait */
 if (rtc->clock_catchup_eligible)
     w_idle = (sim_interval * 1000) / rtc->currd;        /* 1000 * pending fraction of tick */
 else
-    w_idle = (w_ms * 1000) / sim_idle_rate_ms;          /* 1000 * intervals to wait */
-if ((w_idle < 500) || (w_ms == 0)) {                    /* shorter than 1/2 the interval or */
+    w_idle = (uint32) MIN (((t_uint64)w_us * 1000) / sim_idle_rate_us, 0xFFFFFFFFu);/* 1000 * intervals to wait */
+if ((w_idle < 500) || (w_us == 0)) {                    /* shorter than 1/2 the interval or */
     sim_interval -= sin_cyc;                            /* minimal sleep time? */
     if (!in_nowait)
         sim_debug (DBG_IDL, &sim_timer_dev, "no wait, too short: %d usecs\n", w_idle);
@@ -1786,13 +1943,16 @@ if (w_ms > 1000)                                        /* too long a wait (runa
     sim_debug (DBG_TIK, &sim_timer_dev, "waiting too long: w_ms=%d usecs, w_idle=%d usecs, sim_interval=%d, rtc->currd=%d\n", w_ms, w_idle, sim_interval, rtc->currd);
 in_nowait = FALSE;
 if (sim_clock_queue == QUEUE_LIST_END)
-    sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %d ms - pending event in %d %s\n", w_ms, sim_interval, sim_vm_interval_units);
+    sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %u usecs - pending event in %d %s\n", w_us, sim_interval, sim_vm_interval_units);
 else
-    sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %d ms - pending event on %s in %d %s\n", w_ms, sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
+    sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %u usecs - pending event on %s in %d %s\n", w_us, sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
 cyc_since_idle = sim_gtime() - sim_idle_end_time;       /* time since prior idle */
-act_ms = sim_idle_ms_sleep (w_ms);                      /* wait */
-rtc->clock_time_idled += act_ms;
-act_cyc = act_ms * sim_idle_cyc_ms;
+act_us = sim_idle_us_sleep (w_us);                      /* wait */
+_sim_idle_hist_record (w_us, act_us);
+us_idled += act_us;
+rtc->clock_time_idled += us_idled / USEC_PER_MSEC_u32;
+us_idled %= USEC_PER_MSEC_u32;
+act_cyc = (int32)(((t_uint64)act_us * sim_idle_cyc_ms) / USEC_PER_MSEC_u32);
 if (cyc_since_idle > sim_idle_cyc_sleep)
     act_cyc -= sim_idle_cyc_sleep / 2;                  /* account for half an interval's worth of cycles */
 else
@@ -1800,9 +1960,9 @@ else
 sim_interval = sim_interval - act_cyc;                  /* count down sim_interval to reflect idle period */
 sim_idle_end_time = sim_gtime();                        /* save idle completed time */
 if (sim_clock_queue == QUEUE_LIST_END)
-    sim_debug (DBG_IDL, &sim_timer_dev, "slept for %d ms - pending event in %d %s\n", act_ms, sim_interval, sim_vm_interval_units);
+    sim_debug (DBG_IDL, &sim_timer_dev, "slept for %u usecs - pending event in %d %s\n", act_us, sim_interval, sim_vm_interval_units);
 else
-    sim_debug (DBG_IDL, &sim_timer_dev, "slept for %d ms - pending event on %s in %d %s\n", act_ms, sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
+    sim_debug (DBG_IDL, &sim_timer_dev, "slept for %u usecs - pending event on %s in %d %s\n", act_us, sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
 return TRUE;
 }
 
@@ -343,6 +343,13 @@
 
 #include <ctype.h>
 #include <math.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define TMXR_HAVE_EPOLL 1
+#endif
+#if !defined(_WIN32) && !defined(VMS)
+#include <poll.h>
+#endif
 
 /* Telnet protocol constants - negatives are for init'ing signed char data */
 
@@ -1418,6 +1425,8 @@ return ringing;                                         /* no new connections ma
    to signal the attached serial device.
 */
 
+static void _tmxr_rx_ready_drop (TMLN *lp);
+
 static t_stat tmxr_reset_ln_ex (TMLN *lp, t_bool closeserial)
 {
 char msg[512];
@@ -1453,6 +1462,7 @@ if (lp->serport) {
     }
 else                                                    /* Telnet connection */
     if (lp->sock) {
+        _tmxr_rx_ready_drop (lp);                       /* leave readiness set first */
         sim_close_sock (lp->sock);                      /* close socket */
         free (lp->telnet_sent_opts);
         lp->telnet_sent_opts = NULL;
@@ -2166,6 +2176,124 @@ if (lp->conn)
 return SCPE_LOST;
 }
 
+/* Receive readiness
+
+   When the host provides epoll, each multiplexer keeps an epoll descriptor
+   with the sockets of its connected lines registered, and a receive poll
+   asks the kernel once which of those sockets have data rather than
+   issuing a read on every connected line.  Sockets are registered lazily
+   when a line's socket changes.  Lines which aren't socket based (serial,
+   loopback and framer lines) and lines whose socket couldn't be registered
+   are read on every poll, as are all lines when epoll isn't available.
+   The set is identified by the line array and count it was built for and
+   is rebuilt when either changes (SET LINES=n), and events carry line
+   numbers rather than TMLN pointers so a stale event can't reference a
+   line that no longer exists.
+
+   A line's socket is removed from the set explicitly before the socket is
+   closed.  Closing it only drops the registration when no other descriptor
+   (a dup, or one inherited by a child process) refers to the same socket,
+   and a registration left behind under a socket number which is then
+   reused for another line would be removed by that line's next change.
+*/
+
+static void _tmxr_rx_ready_close (TMXR *mp);
+
+static void _tmxr_rx_ready_scan (TMXR *mp)
+{
+#if defined(TMXR_HAVE_EPOLL)
+struct epoll_event *events;
+int32 i, ready;
+
+if ((mp->poll_ldsc != mp->ldsc) ||                      /* first use or lines changed? */
+    (mp->poll_lines != mp->lines)) {
+    _tmxr_rx_ready_close (mp);
+    if ((mp->ldsc == NULL) || (mp->lines <= 0))
+        return;
+    mp->poll_ldsc = mp->ldsc;
+    mp->poll_lines = mp->lines;
+    mp->poll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    mp->poll_events = calloc (mp->lines, sizeof (*events));
+    if ((mp->poll_fd < 0) || (mp->poll_events == NULL)) {
+        if (mp->poll_fd >= 0)
+            close (mp->poll_fd);
+        mp->poll_fd = -1;                               /* don't try again for these lines */
+        free (mp->poll_events);
+        mp->poll_events = NULL;
+        }
+    }
+if (mp->poll_fd < 0)
+    return;
+for (i = 0; i < mp->lines; i++) {                       /* register changed sockets */
+    TMLN *lp = mp->ldsc + i;
+    SOCKET sock = (lp->serport || lp->loopback || lp->framer) ? 0 : lp->sock;
+
+    if (lp->poll_sock == sock)
+        continue;
+    if (lp->poll_sock)
+        epoll_ctl (mp->poll_fd, EPOLL_CTL_DEL, lp->poll_sock, NULL);
+    lp->poll_sock = 0;
+    lp->rx_ready = FALSE;
+    if (sock) {
+        struct epoll_event ev;
+
+        memset (&ev, 0, sizeof (ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32)i;
+        if ((epoll_ctl (mp->poll_fd, EPOLL_CTL_ADD, sock, &ev) == 0) ||
+            ((errno == EEXIST) && (epoll_ctl (mp->poll_fd, EPOLL_CTL_MOD, sock, &ev) == 0)))
+            lp->poll_sock = sock;
+        }
+    }
+events = (struct epoll_event *)mp->poll_events;
+ready = epoll_wait (mp->poll_fd, events, mp->poll_lines, 0);
+for (i = 0; i < ready; i++)
+    if (events[i].data.u32 < (uint32)mp->lines)
+        mp->ldsc[events[i].data.u32].rx_ready = TRUE;
+#endif
+}
+
+static void _tmxr_rx_ready_drop (TMLN *lp)
+{
+#if defined(TMXR_HAVE_EPOLL)
+TMXR *mp = lp->mp;
+
+if ((lp->poll_sock != 0) && (mp != NULL) &&             /* registered in a live set? */
+    (mp->poll_ldsc == mp->ldsc) && (mp->poll_fd >= 0))
+    epoll_ctl (mp->poll_fd, EPOLL_CTL_DEL, lp->poll_sock, NULL);
+#endif
+lp->poll_sock = 0;
+lp->rx_ready = FALSE;
+}
+
+static t_bool _tmxr_rx_ready (TMLN *lp)
+{
+if ((lp->poll_sock == 0) ||                             /* not in readiness set? */
+    (lp->poll_sock != lp->sock) ||
+    lp->serport || lp->loopback || lp->framer)
+    return TRUE;                                        /* always read */
+return lp->rx_ready;
+}
+
+static void _tmxr_rx_ready_close (TMXR *mp)
+{
+int32 i;
+
+#if defined(TMXR_HAVE_EPOLL)
+if ((mp->poll_ldsc != NULL) && (mp->poll_fd >= 0))     /* set created? */
+    close (mp->poll_fd);
+#endif
+mp->poll_fd = -1;
+mp->poll_ldsc = NULL;
+mp->poll_lines = 0;
+free (mp->poll_events);
+mp->poll_events = NULL;
+for (i = 0; i < mp->lines; i++) {
+    mp->ldsc[i].poll_sock = 0;
+    mp->ldsc[i].rx_ready = FALSE;
+    }
+}
+
 /* Poll for input
 
    Inputs:
@@ -2179,11 +2307,19 @@ int32 i, nbytes, j;
 TMLN *lp;
 
 tmxr_debug_trace (mp, "tmxr_poll_rx()");
+++mp->rx_polls;
+_tmxr_rx_ready_scan (mp);                               /* find lines with data */
 for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
     lp = mp->ldsc + i;                                  /* get line desc */
     if (!(lp->sock || lp->serport || lp->loopback || lp->framer) ||
         !(lp->rcve))                                    /* skip if not connected */
         continue;
+    if (!_tmxr_rx_ready (lp)) {                         /* skip if nothing pending */
+        ++mp->rx_idle_lines;
+        continue;
+        }
+    lp->rx_ready = FALSE;
+    ++mp->rx_read_lines;
 
     nbytes = 0;
     if (lp->rxbpi == 0)                                 /* need input? */
@@ -3355,6 +3491,7 @@ while (*tptr) {
                         tmxr_set_line_speed (lp, speed);
                     }
                 tmxr_init_line (lp);                        /* initialize line state */
+                _tmxr_rx_ready_drop (lp);
                 lp->sock = 0;                               /* clear the socket */
                 }
             }
@@ -3731,15 +3868,121 @@ pthread_cond_t      sim_tmxr_startup_cond;
 int32               sim_tmxr_poll_count = 0;
 t_bool              sim_tmxr_poll_running = FALSE;
 
+/* Socket set for the asynchronous polling thread.  The set grows as
+   needed, so the number of sockets isn't limited by FD_SETSIZE on hosts
+   which provide poll().  Hosts without poll() use select(). */
+
+#if defined(_WIN32) || defined(VMS)
+#define TMXR_POLL_SELECT 1
+#endif
+
+typedef struct {
+    int                 count;                          /* sockets in set */
+    int                 size;                           /* sockets allocated */
+    UNIT                **units;                        /* unit to activate for each socket */
+    UNIT                **activated;                    /* units activated by the last wait */
+    SOCKET              *sockets;
+#if defined(TMXR_POLL_SELECT)
+    fd_set              readfds;
+    fd_set              errorfds;
+    SOCKET              max_socket_fd;
+#else
+    struct pollfd       *pfds;
+#endif
+    } TMXR_POLLSET;
+
+static void _tmxr_pollset_reset (TMXR_POLLSET *ps)
+{
+ps->count = 0;
+#if defined(TMXR_POLL_SELECT)
+FD_ZERO (&ps->readfds);
+FD_ZERO (&ps->errorfds);
+ps->max_socket_fd = 0;
+#endif
+}
+
+static void _tmxr_pollset_add (TMXR_POLLSET *ps, SOCKET sock, UNIT *uptr)
+{
+if (ps->count == ps->size) {
+#if defined(TMXR_POLL_SELECT)
+    if (ps->size == FD_SETSIZE)
+        return;                                         /* can't select on any more */
+#endif
+    ps->size = (ps->size == 0) ? 64 : 2 * ps->size;
+#if defined(TMXR_POLL_SELECT)
+    if (ps->size > FD_SETSIZE)
+        ps->size = FD_SETSIZE;
+#else
+    ps->pfds = (struct pollfd *)realloc (ps->pfds, ps->size * sizeof (*ps->pfds));
+#endif
+    ps->units = (UNIT **)realloc (ps->units, ps->size * sizeof (*ps->units));
+    ps->activated = (UNIT **)realloc (ps->activated, ps->size * sizeof (*ps->activated));
+    ps->sockets = (SOCKET *)realloc (ps->sockets, ps->size * sizeof (*ps->sockets));
+    if ((ps->units == NULL) || (ps->activated == NULL) || (ps->sockets == NULL)
+#if !defined(TMXR_POLL_SELECT)
+        || (ps->pfds == NULL)
+#endif
+        ) {
+        sim_printf ("_tmxr_poll() - socket set allocation failed\r\n");
+        abort();
+        }
+    }
+ps->units[ps->count] = uptr;
+ps->sockets[ps->count] = sock;
+#if defined(TMXR_POLL_SELECT)
+FD_SET (sock, &ps->readfds);
+FD_SET (sock, &ps->errorfds);
+if (sock > ps->max_socket_fd)
+    ps->max_socket_fd = sock;
+#else
+ps->pfds[ps->count].fd = (int)sock;
+ps->pfds[ps->count].events = POLLIN;
+ps->pfds[ps->count].revents = 0;
+#endif
+++ps->count;
+}
+
+static int _tmxr_pollset_wait (TMXR_POLLSET *ps, int timeout_usec)
+{
+#if defined(TMXR_POLL_SELECT)
+struct timeval timeout;
+
+timeout.tv_sec = timeout_usec/1000000;
+timeout.tv_usec = timeout_usec%1000000;
+return select (1+(int)ps->max_socket_fd, &ps->readfds, NULL, &ps->errorfds, &timeout);
+#else
+return poll (ps->pfds, ps->count, timeout_usec/1000);
+#endif
+}
+
+static t_bool _tmxr_pollset_ready (TMXR_POLLSET *ps, int i)
+{
+#if defined(TMXR_POLL_SELECT)
+return (FD_ISSET(ps->sockets[i], &ps->readfds) ||
+        FD_ISSET(ps->sockets[i], &ps->errorfds));
+#else
+return ((ps->pfds[i].revents & (POLLIN|POLLPRI|POLLERR|POLLHUP|POLLNVAL)) != 0);
+#endif
+}
+
+static void _tmxr_pollset_free (TMXR_POLLSET *ps)
+{
+free (ps->units);
+free (ps->activated);
+free (ps->sockets);
+#if !defined(TMXR_POLL_SELECT)
+free (ps->pfds);
+#endif
+memset (ps, 0, sizeof (*ps));
+}
+
 static void *
 _tmxr_poll(void *arg)
 {
-struct timeval timeout;
 int timeout_usec;
 DEVICE *dptr = tmxr_open_devices[0]->dptr;
-UNIT **units = NULL;
-UNIT **activated = NULL;
-SOCKET *sockets = NULL;
+TMXR_POLLSET ps;
+UNIT **activated;
 int wait_count = 0;
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution
@@ -3749,21 +3992,18 @@ sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
 
 sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - starting\n");
 
-units = (UNIT **)calloc(FD_SETSIZE, sizeof(*units));
-activated = (UNIT **)calloc(FD_SETSIZE, sizeof(*activated));
-sockets = (SOCKET *)calloc(FD_SETSIZE, sizeof(*sockets));
+memset (&ps, 0, sizeof (ps));
+_tmxr_pollset_reset (&ps);
 timeout_usec = 1000000;
 pthread_mutex_lock (&sim_tmxr_poll_lock);
 pthread_cond_signal (&sim_tmxr_startup_cond);   /* Signal we're ready to go */
 /* We still have sim_tmxr_poll_lock acquired entering the loop. */
 while (sim_asynch_enabled) {
     int i, j, status, select_errno;
-    fd_set readfds, errorfds;
-    int socket_count;
-    SOCKET max_socket_fd;
     TMXR *mp;
     DEVICE *d;
 
+    activated = ps.activated;
     if ((tmxr_open_device_count == 0) || (!sim_is_running)) {
         for (j=0; j<wait_count; ++j) {
             d = find_dev_from_unit(activated[j]);
@@ -3779,82 +4019,41 @@ while (sim_asynch_enabled) {
         pthread_cond_wait (&sim_tmxr_poll_cond, &sim_tmxr_poll_lock);
         sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - continuing with timeout of %dms\n", timeout_usec/1000);
         }
-    FD_ZERO (&readfds);
-    FD_ZERO (&errorfds);
-    for (i=max_socket_fd=socket_count=0; i<tmxr_open_device_count; ++i) {
+    _tmxr_pollset_reset (&ps);
+    for (i=0; i<tmxr_open_device_count; ++i) {
         mp = tmxr_open_devices[i];
-        if ((mp->master) && (mp->uptr->dynflags&UNIT_TM_POLL)) {
-            units[socket_count] = mp->uptr;
-            sockets[socket_count] = mp->master;
-            FD_SET (mp->master, &readfds);
-            FD_SET (mp->master, &errorfds);
-            if (mp->master > max_socket_fd)
-                max_socket_fd = mp->master;
-            ++socket_count;
-            }
+        if ((mp->master) && (mp->uptr->dynflags&UNIT_TM_POLL))
+            _tmxr_pollset_add (&ps, mp->master, mp->uptr);
         for (j=0; j<mp->lines; ++j) {
-            if (mp->ldsc[j].sock) {
-                units[socket_count] = mp->ldsc[j].uptr;
-                if (units[socket_count] == NULL)
-                    units[socket_count] = mp->uptr;
-                sockets[socket_count] = mp->ldsc[j].sock;
-                FD_SET (mp->ldsc[j].sock, &readfds);
-                FD_SET (mp->ldsc[j].sock, &errorfds);
-                if (mp->ldsc[j].sock > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].sock;
-                ++socket_count;
-                }
+            if (mp->ldsc[j].sock)
+                _tmxr_pollset_add (&ps, mp->ldsc[j].sock, mp->ldsc[j].uptr ? mp->ldsc[j].uptr : mp->uptr);
 #if !defined(_WIN32) && !defined(VMS)
-            if (mp->ldsc[j].serport) {
-                units[socket_count] = mp->ldsc[j].uptr;
-                if (units[socket_count] == NULL)
-                    units[socket_count] = mp->uptr;
-                sockets[socket_count] = mp->ldsc[j].serport;
-                FD_SET (mp->ldsc[j].serport, &readfds);
-                FD_SET (mp->ldsc[j].serport, &errorfds);
-                if (mp->ldsc[j].serport > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].serport;
-                ++socket_count;
-                }
+            if (mp->ldsc[j].serport)
+                _tmxr_pollset_add (&ps, (SOCKET)mp->ldsc[j].serport, mp->ldsc[j].uptr ? mp->ldsc[j].uptr : mp->uptr);
 #endif
-            if (mp->ldsc[j].connecting) {
-                units[socket_count] = mp->uptr;
-                sockets[socket_count] = mp->ldsc[j].connecting;
-                FD_SET (mp->ldsc[j].connecting, &readfds);
-                FD_SET (mp->ldsc[j].connecting, &errorfds);
-                if (mp->ldsc[j].connecting > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].connecting;
-                ++socket_count;
-                }
-            if (mp->ldsc[j].master) {
-                units[socket_count] = mp->uptr;
-                sockets[socket_count] = mp->ldsc[j].master;
-                FD_SET (mp->ldsc[j].master, &readfds);
-                FD_SET (mp->ldsc[j].master, &errorfds);
-                if (mp->ldsc[j].master > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].master;
-                ++socket_count;
-                }
+            if (mp->ldsc[j].connecting)
+                _tmxr_pollset_add (&ps, mp->ldsc[j].connecting, mp->uptr);
+            if (mp->ldsc[j].master)
+                _tmxr_pollset_add (&ps, mp->ldsc[j].master, mp->uptr);
             }
         }
+    activated = ps.activated;
     pthread_mutex_unlock (&sim_tmxr_poll_lock);
     if (timeout_usec > 1000000)
         timeout_usec = 1000000;
-    timeout.tv_sec = timeout_usec/1000000;
-    timeout.tv_usec = timeout_usec%1000000;
     select_errno = 0;
-    if (socket_count == 0) {
+    if (ps.count == 0) {
         sim_os_ms_sleep (timeout_usec/1000);
         status = 0;
         }
     else
-        status = select (1+(int)max_socket_fd, &readfds, NULL, &errorfds, &timeout);
+        status = _tmxr_pollset_wait (&ps, timeout_usec);
     select_errno = errno;
     wait_count=0;
     pthread_mutex_lock (&sim_tmxr_poll_lock);
     switch (status) {
         case 0:     /* timeout */
-            for (i=max_socket_fd=socket_count=0; i<tmxr_open_device_count; ++i) {
+            for (i=0; i<tmxr_open_device_count; ++i) {
                 mp = tmxr_open_devices[i];
                 if (mp->master) {
                     if (!mp->uptr->a_polling_now) {
@@ -3903,16 +4102,15 @@ while (sim_asynch_enabled) {
             break;
         default:
             wait_count = 0;
-            for (i=0; i<socket_count; ++i) {
-                if (FD_ISSET(sockets[i], &readfds) ||
-                    FD_ISSET(sockets[i], &errorfds)) {
+            for (i=0; i<ps.count; ++i) {
+                if (_tmxr_pollset_ready (&ps, i)) {
                     /* More than one socket can be associated with the
                        same unit.  Only activate one time */
                     for (j=0; j<wait_count; ++j)
-                        if (activated[j] == units[i])
+                        if (activated[j] == ps.units[i])
                             break;
                     if (j == wait_count) {
-                        activated[j] = units[i];
+                        activated[j] = ps.units[i];
                         ++wait_count;
                         if (!activated[j]->a_polling_now) {
                             activated[j]->a_polling_now = TRUE;
@@ -3938,9 +4136,7 @@ while (sim_asynch_enabled) {
     sim_tmxr_poll_count += wait_count;
     }
 pthread_mutex_unlock (&sim_tmxr_poll_lock);
-free(units);
-free(activated);
-free(sockets);
+_tmxr_pollset_free (&ps);
 
 sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - exiting\n");
 
@@ -4309,6 +4505,7 @@ int i, j;
 tmxr_stop_poll ();
 pthread_mutex_lock (&sim_tmxr_poll_lock);
 #endif
+_tmxr_rx_ready_close (mux);
 for (i=0; i<tmxr_open_device_count; ++i)
     if (tmxr_open_devices[i] == mux) {
         for (j=i+1; j<tmxr_open_device_count; ++j)
@@ -4560,6 +4757,11 @@ if (mp->lines == 1) {
         }
     }
 fprintf(st, "\n");
+if (mp->rx_polls) {
+    fprintf(st, "    Receive polls=%u, lines read=%.0f, idle lines skipped=%.0f, readiness=%s\n",
+                mp->rx_polls, (double)mp->rx_read_lines, (double)mp->rx_idle_lines,
+                ((mp->poll_ldsc != NULL) && (mp->poll_fd >= 0)) ? "epoll" : "scan");
+    }
 if (mp->ring_start_time) {
     fprintf (st, "    incoming Connection from: %s ringing for %d milliseconds\n", mp->ring_ipad, sim_os_msec () - mp->ring_start_time);
     }
@@ -6142,6 +6344,57 @@ tmxr->lines = saved_lines;
 return SCPE_OK;
 }
 
+#if defined(TMXR_HAVE_EPOLL)
+/* Resetting a line must take its socket out of the receive readiness set
+   even while another descriptor (here a dup) keeps the socket open.  Data
+   arriving on it afterwards must not mark the line ready. */
+
+static t_stat sim_tmxr_test_rx_ready (DEVICE *dptr)
+{
+char cmd[CBUFSIZE];
+TMXR *tmxr;
+TMLN *lp;
+SOCKET sock;
+int32 ln;
+int keep = -1;
+t_stat r;
+
+sim_printf ("Receive readiness set test\n");
+sprintf (cmd, "%s localhost:65502;notelnet", dptr->name);
+r = attach_cmd (0, cmd);
+if (r != SCPE_OK)
+    return r;
+tmxr = (TMXR *)dptr->units->tmxr;
+sock = sim_connect_sock ("", "localhost", "65502");
+sim_os_ms_sleep (100);
+ln = tmxr_poll_conn (tmxr);
+if ((sock == INVALID_SOCKET) || (ln < 0))
+    r = sim_messagef (SCPE_IERR, "No line connected\n");
+if (r == SCPE_OK) {
+    lp = &tmxr->ldsc[ln];
+    tmxr_poll_rx (tmxr);                                /* register the line */
+    if ((lp->poll_sock == 0) || (lp->poll_sock != lp->sock))
+        sim_printf ("Skipped, line %d isn't in a readiness set\n", (int)ln);
+    else {
+        keep = dup ((int)lp->sock);                     /* socket outlives the close */
+        tmxr_reset_ln (lp);
+        if (lp->poll_sock != 0)
+            r = sim_messagef (SCPE_IERR, "Line %d still registered after reset\n", (int)ln);
+        sim_write_sock (sock, "x", 1);
+        sim_os_ms_sleep (100);
+        tmxr_poll_rx (tmxr);
+        if ((r == SCPE_OK) && lp->rx_ready)
+            r = sim_messagef (SCPE_IERR, "Closed socket still reported ready on line %d\n", (int)ln);
+        }
+    }
+if (keep >= 0)
+    close (keep);
+if (sock != INVALID_SOCKET)
+    sim_close_sock (sock);
+detach_cmd (0, dptr->name);
+return r;
+}
+#endif
 
 #include <setjmp.h>
 
@@ -6204,6 +6457,9 @@ if (tmxr->lines > 1) {
     sim_close_sock (sock_line);
     sock_line = INVALID_SOCKET;
     SIM_TEST(detach_cmd (0, dptr->name));
+#if defined(TMXR_HAVE_EPOLL)
+    SIM_TEST(sim_tmxr_test_rx_ready (dptr));
+#endif
     SIM_TEST(sim_tmxr_test_lnorder (tmxr));
     }
 return stat;
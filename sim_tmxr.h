@@ -212,6 +212,8 @@ struct tmln {
     EXPECT              expect;                         /* Expect rules */
     SEND                send;                           /* Send input state */
     struct framer_data  *framer;                        /* ddcmp framer data */
+    SOCKET              poll_sock;                      /* socket registered for receive readiness - private */
+    t_bool              rx_ready;                       /* receive data known to be pending - private */
     };
 
 struct tmxr {
@@ -240,6 +242,13 @@ struct tmxr {
     t_bool              port_speed_control;             /* multiplexer programmatically sets port speed */
     t_bool              packet;                         /* Lines are packet oriented */
     t_bool              datagram;                       /* Lines use datagram packet transport */
+    int                 poll_fd;                        /* receive readiness descriptor (-1 when none) - private */
+    TMLN                *poll_ldsc;                     /* line array the readiness set was built for - private */
+    int32               poll_lines;                     /* line count the readiness set was built for - private */
+    void                *poll_events;                   /* receive readiness event buffer - private */
+    uint32              rx_polls;                       /* count of receive polls */
+    t_uint64            rx_read_lines;                  /* lines read by receive polls */
+    t_uint64            rx_idle_lines;                  /* connected lines skipped as idle by receive polls */
     };
 
 int32 tmxr_poll_conn (TMXR *mp);
@@ -410,17 +410,12 @@ static void vid_beep_cleanup (void);
 
 static void vid_audio_callback(void *ctx, Uint8 *stream, int length);
 
-/* Manage a draw_op. */
-static inline int set_draw_op(VID_DISPLAY *vptr, size_t idx, const uint32 *buf, int32 x, int32 y, int32 w, int32 h);
-
-/* Drawing operation (bit blit) state. */
-typedef struct DrawOp {
-  SDL_Rect blit_rect;
-  uint32 *blit_data;
-  size_t n_blit_data;
-  size_t alloc_blit_data;
-  int in_use;
-} DrawOp;
+/* Dirty region tracking. */
+static void add_dirty_rect(VID_DISPLAY *vptr, const SDL_Rect *rect);
+
+/* MAX_DIRTY_RECTS: Number of distinct dirty regions tracked per display before
+ * regions are merged into their nearest neighbor. */
+#define MAX_DIRTY_RECTS 16
 
 typedef struct DrawOnto {
     SDL_Rect onto_rect;
@@ -464,8 +459,13 @@ struct VID_DISPLAY {
 
     SDL_mutex *draw_mutex;                              /* Window update mutex */
 
-    DrawOp *draw_ops;                                   /* Pending blit array. */
-    size_t alloc_draw_ops;                              /* Allocated size of draw_ops */
+    uint32 *frame;                                      /* Persistent frame (vid_width x vid_height) */
+    SDL_Rect dirty[MAX_DIRTY_RECTS];                    /* Regions updated since the last blit */
+    size_t n_dirty;                                     /* Number of dirty regions */
+    t_bool draw_pending;                                /* SIMH_EVENT_DRAW queued, not yet processed */
+    t_uint64 draws_requested;                           /* vid_draw_window() calls */
+    t_uint64 blits_performed;                           /* Texture region updates */
+    t_uint64 frames_presented;                          /* Render updates from draw events */
 
     DrawOnto *onto_ops;                                 /* Direct-to-texture blits */
     size_t alloc_onto_ops;
@@ -491,10 +491,6 @@ static SimhRenderMode vid_render_mode = RENDER_MODE_SW;
 /* (sigh) C -- initialize constants with values... */
 #define INVALID_SDL_EVENT ((Uint32) -1)
 
-/* INITIAL_DRAW_OPS: For the PDP-11 VT "lunar lander" demo mode, there is only
- * one outstanding draw operation. Leave some headroom for other displays and
- * simulators (but realistically, there's only likely to be one active draw op.) */
-static const size_t      INITIAL_DRAW_OPS  = 8;
 static const size_t      INITIAL_ONTO_OPS  = 8;
 
 /* Audio (beep) constants: */
@@ -1367,6 +1363,13 @@ t_stat vid_close_window(VID_DISPLAY *vptr)
     while (SDL_AtomicGet(&vptr->vid_ready) != FALSE)
         sim_os_ms_sleep(10);
 
+    /* simh_close_event is completely done with the window, so nothing else
+     * uses the draw mutex.  Opening the window again creates a new one. */
+    if (vptr->draw_mutex != NULL) {
+        SDL_DestroyMutex(vptr->draw_mutex);
+        vptr->draw_mutex = NULL;
+    }
+
     vptr->vid_active_window = FALSE;
     if (active_status == 0 && vid_mouse_events.sem) {
         SDL_DestroySemaphore(vid_mouse_events.sem);
@@ -1395,47 +1398,66 @@ void vid_draw (int32 x, int32 y, int32 w, int32 h, const uint32 *buf)
     vid_draw_window (vid_first(), x, y, w, h, buf);
 }
 
+/* Draw into the display's persistent frame and mark the region dirty. Only one
+ * SIMH_EVENT_DRAW is outstanding per display: draws that arrive before the SDL
+ * thread processes it are merged into the dirty regions and uploaded to the
+ * texture together, followed by a single render update. */
 void vid_draw_window (VID_DISPLAY *vptr, int32 x, int32 y, int32 w, int32 h, const uint32 *buf)
 {
-    size_t i, slot = vptr->alloc_draw_ops;
+    SDL_Rect rect;
+    int32 row, src_w = w;
+
+    /* Clip to the window. */
+    if (x < 0) {
+        buf -= x;
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        buf -= y * src_w;
+        h += y;
+        y = 0;
+    }
+    if (x + w > vptr->vid_width)
+        w = vptr->vid_width - x;
+    if (y + h > vptr->vid_height)
+        h = vptr->vid_height - y;
+    if (w <= 0 || h <= 0 || vptr->draw_mutex == NULL)
+        return;
 
     SDL_LockMutex (vptr->draw_mutex);
 
-    for (i = 0; i < vptr->alloc_draw_ops; ++i) {
-        int overlapped =
-            vptr->draw_ops[i].blit_rect.x == x
-                && vptr->draw_ops[i].blit_rect.y == y
-                && vptr->draw_ops[i].blit_rect.w == w
-                && vptr->draw_ops[i].blit_rect.h == h;
-
-        if (overlapped || !vptr->draw_ops[i].in_use) {
-            slot = i;
-            if (overlapped) {
-                sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev, "[event] [%" SIZE_T_FMT "u] reusing unrendered frame.\n", i);
-            }
-            break;
-        }
+    if (vptr->frame == NULL) {                          /* window closed */
+        SDL_UnlockMutex (vptr->draw_mutex);
+        return;
     }
 
-    if (!set_draw_op(vptr, slot, buf, x, y, w, h)) {
+    for (row = 0; row < h; ++row)
+        memcpy(vptr->frame + (y + row) * vptr->vid_width + x, buf + row * src_w, w * sizeof(*buf));
+
+    rect.x = x;
+    rect.y = y;
+    rect.w = w;
+    rect.h = h;
+    add_dirty_rect(vptr, &rect);
+    ++vptr->draws_requested;
+
+    if (!vptr->draw_pending) {
         SDL_Event user_event = {
             .user.type = evidentifier_for(SIMH_EVENT_DRAW),
             .user.windowID = 0,
             .user.code = 0,
             .user.data1 = (void *) vptr,
-            /* Not a fan of sending the index diguised as a pointer, although
-             * (void *) and size_t are the same size. An atrocious practice
-             * that should be avoided.
-             *
-             * However, it's unsafe to send a pointer into the vptr->draw_ops
-             * array because the array might be resized and moved, thereby
-             * invalidating previous SIMH_EVENT_DRAW pointers. */
-            .user.data2 = (void *) slot
+            .user.data2 = NULL
         };
 
-        queue_sdl_event(&user_event, "vid_draw_window_event", vptr);
-        ++vptr->draw_ops[slot].in_use;
-        sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev, "[event] [%" SIZE_T_FMT "u] vid_draw(%d, %d, %d, %d)\n", slot, x, y, w, h);
+        vptr->draw_pending = TRUE;
+        if (queue_sdl_event(&user_event, "vid_draw_window_event", vptr) < 0)
+            vptr->draw_pending = FALSE;                 /* next draw queues it again */
+        sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev, "[event] vid_draw(%d, %d, %d, %d)\n", x, y, w, h);
+    } else {
+        sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev, "[event] vid_draw(%d, %d, %d, %d) merged, %" SIZE_T_FMT "u dirty regions\n",
+                   x, y, w, h, vptr->n_dirty);
     }
 
     SDL_UnlockMutex (vptr->draw_mutex);
@@ -1933,23 +1955,24 @@ static t_stat vid_init_window(VID_DISPLAY *vptr, DEVICE *dptr, const char *title
     vptr->renderer = NULL;
     vptr->texture = NULL;
 
-    /* Drawing operations... */
-    vptr->draw_mutex = SDL_CreateMutex();
+    /* Drawing operations... The mutex lives until vid_close_window. */
+    if (vptr->draw_mutex == NULL)
+        vptr->draw_mutex = SDL_CreateMutex();
     if (vptr->draw_mutex == NULL) {
         SDL_Quit();
         return sim_messagef(SCPE_NXM, "%s: create draw_mutex failed: %s\n", vid_dname(vptr->vid_dev), SDL_GetError());
     }
 
-    if ((vptr->draw_ops = (DrawOp *) calloc(INITIAL_DRAW_OPS, sizeof(DrawOp))) == NULL) {
-        SDL_DestroyMutex(vptr->draw_mutex);
-        return sim_messagef(SCPE_NXM, "%s: could not allocate draw_ops.\n", vid_dname(vptr->vid_dev));
-    } else
-        vptr->alloc_draw_ops = INITIAL_DRAW_OPS;
+    if ((vptr->frame = (uint32 *) calloc(vptr->vid_width * vptr->vid_height, sizeof(*vptr->frame))) == NULL) {
+        return sim_messagef(SCPE_NXM, "%s: could not allocate frame.\n", vid_dname(vptr->vid_dev));
+    }
+    vptr->n_dirty = 0;
+    vptr->draw_pending = FALSE;
+    vptr->draws_requested = vptr->blits_performed = vptr->frames_presented = 0;
 
     if ((vptr->onto_ops = (DrawOnto *) calloc(INITIAL_ONTO_OPS, sizeof(DrawOnto))) == NULL) {
-        SDL_DestroyMutex(vptr->draw_mutex);
-        free(vptr->draw_ops);
-        vptr->alloc_draw_ops = 0;
+        free(vptr->frame);
+        vptr->frame = NULL;
         return sim_messagef(SCPE_NXM, "%s: could not allocate onto_ops.\n", vid_dname(vptr->vid_dev));
     } else
         vptr->alloc_onto_ops = INITIAL_ONTO_OPS;
@@ -2028,54 +2051,63 @@ return SDL_MapRGBA (vptr->vid_format, r, g, b, a);
  * Drawing operations:
  *=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~*/
 
-/* Resize draw_ops if needed, resize the blit_data bitmap and populate the blit data values. */
-static inline int set_draw_op(VID_DISPLAY *vptr, size_t idx, const uint32 *buf, int32 x, int32 y, int32 w, int32 h)
+/* Rectangles overlap or share an edge. */
+static inline int rects_touch(const SDL_Rect *a, const SDL_Rect *b)
 {
-    if (idx >= vptr->alloc_draw_ops) {
-        DrawOp *p;
-        size_t prev_alloc = vptr->alloc_draw_ops;
+    return a->x <= b->x + b->w && b->x <= a->x + a->w
+        && a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
 
-        vptr->alloc_draw_ops *= 2;
-        p = (DrawOp *) realloc(vptr->draw_ops, vptr->alloc_draw_ops * sizeof(DrawOp));
-        if (p == NULL) {
-            sim_messagef(SCPE_NXM, "%s: set_draw_op(): realloc() draw_ops array error.\n", vid_dname(vptr->vid_dev));
-            return 1;
-        }
+static inline void rect_union(SDL_Rect *result, const SDL_Rect *a, const SDL_Rect *b)
+{
+    int32 x1 = (a->x < b->x) ? a->x : b->x;
+    int32 y1 = (a->y < b->y) ? a->y : b->y;
+    int32 x2 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int32 y2 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
 
-        vptr->draw_ops = p;
-        memset(&vptr->draw_ops[prev_alloc], 0, (vptr->alloc_draw_ops - prev_alloc) * sizeof(DrawOp));
+    result->x = x1;
+    result->y = y1;
+    result->w = x2 - x1;
+    result->h = y2 - y1;
+}
 
-        sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev,
-                    "set_draw_op() reallocated draw_ops from %" SIZE_T_FMT "u to %" SIZE_T_FMT "u\n",
-                    prev_alloc, vptr->alloc_draw_ops);
-    }
+/* Add a region to the display's dirty list, merging it with any overlapping or
+ * adjacent regions. When the list is full, the region is merged with the entry
+ * whose bounding box grows the least. Called with draw_mutex held. */
+static void add_dirty_rect(VID_DISPLAY *vptr, const SDL_Rect *rect)
+{
+    SDL_Rect r = *rect;
+    size_t i;
 
-    DrawOp *draw = &vptr->draw_ops[idx];
-    const size_t n_buf = w * h * sizeof(*buf);
+    for (i = 0; i < vptr->n_dirty; /* empty */) {
+        if (rects_touch(&r, &vptr->dirty[i])) {
+            rect_union(&r, &r, &vptr->dirty[i]);
+            vptr->dirty[i] = vptr->dirty[--vptr->n_dirty];
+            i = 0;                                      /* union may now touch earlier regions */
+        } else
+            ++i;
+    }
 
-    if (draw->alloc_blit_data < n_buf) {
-        /* NB: draw->vid_data may be NULL, which makes the realloc() == malloc(). */
-        uint32 *newbuf = (uint32 *) realloc(draw->blit_data, n_buf);
-        if (newbuf == NULL) {
-            sim_printf ("%s: set_draw_op() realloc blit_data allocation error\n", vid_dname(vptr->vid_dev));
-            return 1;
-        }
+    if (vptr->n_dirty == MAX_DIRTY_RECTS) {
+        size_t best = 0;
+        t_uint64 best_growth = (t_uint64) -1;
 
-        sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev,
-                    "set_draw_op() reallocated draw_ops[%" SIZE_T_FMT "u] from %" SIZE_T_FMT "u to %" SIZE_T_FMT "u\n",
-                    draw - vptr->draw_ops, draw->n_blit_data, n_buf);
+        for (i = 0; i < vptr->n_dirty; ++i) {
+            SDL_Rect u;
+            t_uint64 growth;
 
-        draw->blit_data = newbuf;
-        draw->alloc_blit_data = n_buf;
+            rect_union(&u, &r, &vptr->dirty[i]);
+            growth = (t_uint64) u.w * u.h - (t_uint64) vptr->dirty[i].w * vptr->dirty[i].h;
+            if (growth < best_growth) {
+                best_growth = growth;
+                best = i;
+            }
+        }
+        rect_union(&r, &r, &vptr->dirty[best]);
+        vptr->dirty[best] = vptr->dirty[--vptr->n_dirty];
     }
 
-    draw->blit_rect.x = x;
-    draw->blit_rect.y = y;
-    draw->blit_rect.h = h;
-    draw->blit_rect.w = w;
-    draw->n_blit_data = n_buf;
-    memcpy (draw->blit_data, buf, n_buf);
-    return 0;
+    vptr->dirty[vptr->n_dirty++] = r;
 }
 
 t_stat vid_set_cursor_window (VID_DISPLAY *vptr, t_bool visible, uint32 width, uint32 height, uint8 *data, uint8 *mask, uint32 hot_x, uint32 hot_y)
@@ -2920,7 +2952,6 @@ static void simh_close_event(const SDL_Event *ev)
     VID_DISPLAY *vptr = (VID_DISPLAY *) ev->user.data1;
     VID_DISPLAY *parent;
 
-    SDL_AtomicSet(&vptr->vid_ready, FALSE);
     if (vptr->vid_cursor != NULL) {
         SDL_FreeCursor(vptr->vid_cursor);
         vptr->vid_cursor = NULL;
@@ -2932,8 +2963,14 @@ static void simh_close_event(const SDL_Event *ev)
     vptr->renderer = NULL;
     SDL_DestroyWindow(vptr->vid_window);
     vptr->vid_window = NULL;
-    SDL_DestroyMutex(vptr->draw_mutex);
-    vptr->draw_mutex = NULL;
+    /* The simulator thread may be drawing into the frame: release it under the
+     * draw mutex. */
+    SDL_LockMutex(vptr->draw_mutex);
+    free(vptr->frame);
+    vptr->frame = NULL;
+    vptr->n_dirty = 0;
+    vptr->draw_pending = FALSE;
+    SDL_UnlockMutex(vptr->draw_mutex);
 
     for (parent = sim_displays; parent != NULL; parent = parent->next) {
         if (parent->next == vptr)
@@ -2941,6 +2978,8 @@ static void simh_close_event(const SDL_Event *ev)
     }
 
     SDL_AtomicDecRef(&vid_active);
+    /* Last: vid_close_window destroys the draw mutex once it sees this. */
+    SDL_AtomicSet(&vptr->vid_ready, FALSE);
 }
 
 /* SIMH_EVENT_CURSOR */
@@ -3034,35 +3073,55 @@ static void do_render_update(VID_DISPLAY **disps, size_t n_disps)
     }
 }
 
-static void do_draw_blit(VID_DISPLAY *vptr, size_t idx)
+/* Upload the display's dirty regions from its frame to the texture. */
+static void do_draw_blit(VID_DISPLAY *vptr)
 {
-    DrawOp       *draw = &vptr->draw_ops[idx];
-    SDL_Rect     *blit_rect = &draw->blit_rect;
-    const uint32 *buf       = draw->blit_data;
-    size_t        n_buf     = draw->n_blit_data;
-    void         *blit_area = NULL;
-    int           blit_pitch = 0;
+    size_t i, n_dirty;
 
-    if (SDL_AtomicGet(&vptr->vid_ready) == 0)
+    SDL_LockMutex(vptr->draw_mutex);
+
+    if (SDL_AtomicGet(&vptr->vid_ready) == 0 || vptr->frame == NULL) {
+        /* Window not (or no longer) open: drop the regions so the next draw
+         * queues a fresh event. */
+        vptr->n_dirty = 0;
+        vptr->draw_pending = FALSE;
+        SDL_UnlockMutex(vptr->draw_mutex);
         return;
+    }
 
-    sim_debug(SIM_VID_DBG_VIDEO, vptr->vid_dev,
-              "do_draw_blit: index [%" SIZE_T_FMT "u] (%d,%d,%d,%d) in_use = %d\n",
-              draw - vptr->draw_ops, draw->blit_rect.x, draw->blit_rect.y, draw->blit_rect.w, draw->blit_rect.h,
-              draw->in_use);
+    n_dirty = vptr->n_dirty;
+    for (i = 0; i < n_dirty; ++i) {
+        SDL_Rect     *blit_rect = &vptr->dirty[i];
+        void         *blit_area = NULL;
+        int           blit_pitch = 0;
+        int32         row;
+
+        sim_debug(SIM_VID_DBG_VIDEO, vptr->vid_dev, "do_draw_blit: region [%" SIZE_T_FMT "u] (%d,%d,%d,%d)\n",
+                  i, blit_rect->x, blit_rect->y, blit_rect->w, blit_rect->h);
 
-    SDL_LockTexture(vptr->texture, blit_rect, &blit_area, &blit_pitch);
-    ASSURE(blit_pitch == blit_rect->w * sizeof(buf[0]));
-    memcpy(blit_area, buf, n_buf);
-    SDL_UnlockTexture(vptr->texture);
+        if (SDL_LockTexture(vptr->texture, blit_rect, &blit_area, &blit_pitch)) {
+            sim_printf ("%s: SDL_LockTexture: %s\n", vid_dname(vptr->vid_dev), SDL_GetError());
+            continue;
+        }
+        for (row = 0; row < blit_rect->h; ++row)
+            memcpy((uint8 *) blit_area + row * blit_pitch,
+                   vptr->frame + (blit_rect->y + row) * vptr->vid_width + blit_rect->x,
+                   blit_rect->w * sizeof(*vptr->frame));
+        SDL_UnlockTexture(vptr->texture);
 
-    if (vptr->vid_blending && SDL_RenderCopy (vptr->renderer, vptr->texture, blit_rect, blit_rect)) {
-        sim_printf ("%s: SDL_RenderCopy: %s\n", vid_dname(vptr->vid_dev), SDL_GetError());
+        if (vptr->vid_blending && SDL_RenderCopy (vptr->renderer, vptr->texture, blit_rect, blit_rect)) {
+            sim_printf ("%s: SDL_RenderCopy: %s\n", vid_dname(vptr->vid_dev), SDL_GetError());
+        }
     }
+    vptr->blits_performed += n_dirty;
+    ++vptr->frames_presented;
+    vptr->n_dirty = 0;
+    vptr->draw_pending = FALSE;
+
+    sim_debug(SIM_VID_DBG_VIDEO, vptr->vid_dev,
+              "do_draw_blit: %" SIZE_T_FMT "u regions, %" T_UINT64_FMT "u draws requested, %" T_UINT64_FMT "u blits performed\n",
+              n_dirty, vptr->draws_requested, vptr->blits_performed);
 
-    /* Acquire mutex for only the things we mutate. */
-    SDL_LockMutex(vptr->draw_mutex);
-    draw->in_use = 0;
     SDL_UnlockMutex(vptr->draw_mutex);
 }
 
@@ -3079,9 +3138,9 @@ static void simh_draw_event(const SDL_Event *ev)
     draw_events[0] = *ev;
     ++n_events;
 
-    /* Grab other draw events that might be in the SDL event queue. Sometimes
-      * known as "draw event compression". It's just being opportunistic to avoid
-     * round trips through the SDL event loop, one at a time. */
+    /* Each display has at most one draw event outstanding, so any others in
+     * the SDL event queue belong to other displays. Collect them so that all
+     * displays are updated in one pass through the event loop. */
     if ((n_peek = SDL_PeepEvents(draw_events + 1, n_draw_events - 1, SDL_GETEVENT, draw_event_id, draw_event_id)) > 0) {
         n_events += n_peek;
     }
@@ -3089,7 +3148,7 @@ static void simh_draw_event(const SDL_Event *ev)
     n_disps = do_render_init(draw_events, n_events, disps, n_displays);
 
     for (i = 0; i < (size_t) n_events; ++i) {
-        do_draw_blit((VID_DISPLAY *) draw_events[i].user.data1, (size_t) draw_events[i].user.data2);
+        do_draw_blit((VID_DISPLAY *) draw_events[i].user.data1);
     }
 
     do_render_update(disps, n_disps);
@@ -3410,6 +3469,8 @@ static t_stat show_sdl_info(FILE *st, UNIT *uptr, int32 val, const void *desc)
             if (!vptr->vid_active_window)
                 continue;
             fprintf(st, "  Currently Active Video Window: (%d by %d pixels)\n", vptr->vid_width, vptr->vid_height);
+            fprintf(st, "  Draws requested: %" T_UINT64_FMT "u, regions blitted: %" T_UINT64_FMT "u, frames presented: %" T_UINT64_FMT "u\n",
+                    vptr->draws_requested, vptr->blits_performed, vptr->frames_presented);
             fprintf(st, "  ");
             vid_show_release_key(st, uptr, val, desc);
         }